@@ -25,7 +25,9 @@
 #include <cstdio>
 
 #include <vector>
+#include <map>
 #include <memory>
+#include <future>
 
 #include "src/common/util.h"
 #include "src/common/strutil.h"
@@ -34,6 +36,7 @@
 #include "src/common/filepath.h"
 #include "src/common/readstream.h"
 #include "src/common/writefile.h"
+#include "src/common/threadpool.h"
 
 #include "src/aurora/util.h"
 #include "src/aurora/archive.h"
@@ -222,7 +225,7 @@ void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool dire
 		std::fflush(stdout);
 
 		try {
-			std::unique_ptr<Common::SeekableReadStream> stream(archive.getResource(r->index));
+			std::unique_ptr<Common::SeekableReadStream> stream(archive.getResource(r->index, true));
 
 			dumpStream(*stream, name);
 
@@ -233,6 +236,124 @@ void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool dire
 	}
 }
 
+void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
+                  const std::set<Common::UString> &files, size_t jobs, const ArchiveOpener &opener) {
+
+	jobs = Common::ThreadPool::getThreadCount(jobs);
+	if (jobs <= 1) {
+		extractFiles(archive, game, directories, files);
+		return;
+	}
+
+	const Aurora::Archive::ResourceList &resources = archive.getResources();
+	const size_t fileCount = resources.size();
+
+	std::printf("Number of files: %s\n\n", Common::composeString(fileCount).c_str());
+
+	struct ExtractJob {
+		size_t number;
+		uint32_t index;
+		Common::UString name;
+
+		std::promise<void> done;
+	};
+
+	// Figure out all the names and create the directories up front, single-threaded
+	std::vector<std::unique_ptr<ExtractJob>> extractJobs;
+	extractJobs.reserve(fileCount);
+
+	size_t i = 1;
+	for (Aurora::Archive::ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r, ++i) {
+		const Aurora::FileType type = TypeMan.aliasFileType(r->type, game);
+
+		const Common::UString path     = findPath(r->name, type, r->hash, archive.getNameHashAlgo());
+		const Common::UString fileName = Common::FilePath::getFile(path);
+		const Common::UString dirName  = Common::FilePath::getDirectory(path);
+		const Common::UString name     = directories ? path : fileName;
+
+		if (!files.empty() && (files.find(name) == files.end()))
+			continue;
+
+		if (directories && !dirName.empty())
+			Common::FilePath::createDirectories(dirName);
+
+		extractJobs.emplace_back(std::make_unique<ExtractJob>());
+
+		extractJobs.back()->number = i;
+		extractJobs.back()->index  = r->index;
+		extractJobs.back()->name   = name;
+	}
+
+	if (extractJobs.empty())
+		return;
+
+	/* Several resources can end up with the same file name, for example when
+	 * flattening the directories. Extract those one after the other within the
+	 * same worker, in archive order, so that the last one wins, like it does
+	 * when extracting single-threaded. */
+	std::vector<std::vector<ExtractJob *>> jobGroups;
+	std::map<Common::UString, size_t> jobGroupIndices;
+
+	for (std::vector<std::unique_ptr<ExtractJob>>::iterator j = extractJobs.begin(); j != extractJobs.end(); ++j) {
+		std::pair<std::map<Common::UString, size_t>::iterator, bool> group =
+			jobGroupIndices.insert(std::make_pair((*j)->name, jobGroups.size()));
+
+		if (group.second)
+			jobGroups.emplace_back();
+
+		jobGroups[group.first->second].push_back(j->get());
+	}
+
+	jobs = MIN(jobs, jobGroups.size());
+
+	// Every worker thread gets its own instance of the archive, with its own file handle
+	std::vector<std::unique_ptr<Aurora::Archive>> archives;
+	archives.reserve(jobs);
+
+	for (size_t j = 0; j < jobs; j++)
+		archives.emplace_back(opener());
+
+	Common::ThreadPool pool(jobs);
+
+	for (std::vector<std::vector<ExtractJob *>>::iterator g = jobGroups.begin(); g != jobGroups.end(); ++g) {
+		const std::vector<ExtractJob *> &group = *g;
+
+		pool.addJob([&group, &archives](size_t thread) {
+			for (std::vector<ExtractJob *>::const_iterator j = group.begin(); j != group.end(); ++j) {
+				ExtractJob &job = **j;
+
+				try {
+					std::unique_ptr<Common::SeekableReadStream> stream(archives[thread]->getResource(job.index, true));
+
+					dumpStream(*stream, job.name);
+
+					job.done.set_value();
+				} catch (...) {
+					job.done.set_exception(std::current_exception());
+				}
+			}
+		});
+	}
+
+	// Report the results in order, as they come in
+	for (std::vector<std::unique_ptr<ExtractJob>>::iterator j = extractJobs.begin(); j != extractJobs.end(); ++j) {
+		ExtractJob &job = **j;
+
+		std::printf("Extracting %s/%s: %s ... ", Common::composeString(job.number).c_str(),
+		                                         Common::composeString(fileCount).c_str(),
+		                                         job.name.c_str());
+		std::fflush(stdout);
+
+		try {
+			job.done.get_future().get();
+
+			std::printf("Done\n");
+		} catch (Common::Exception &e) {
+			Common::printException(e, "");
+		}
+	}
+}
+
 void extractFiles(const Aurora::NSBTXFile &nsbtx, const std::set<Common::UString> &files,
                   void (*dumper)(Common::SeekableReadStream &stream, const Common::UString &fileName)) {
 
@@ -26,6 +26,7 @@
 #define ARCHIVES_UTIL_H
 
 #include <set>
+#include <functional>
 
 #include "src/common/ustring.h"
 
@@ -65,6 +66,32 @@ void listFiles(const Aurora::NSBTXFile &nsbtx);
 void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
                   const std::set<Common::UString> &files);
 
+/** A function that opens a new, independent instance of an archive. */
+typedef std::function<Aurora::Archive *()> ArchiveOpener;
+
+/** Extract files from an archive, using several threads.
+ *
+ *  Each worker thread opens its own instance of the archive through the opener,
+ *  so that reading, decrypting, decompressing and writing the files happens
+ *  concurrently. The progress and error output is the same, and in the same
+ *  order, as with the single-threaded extractFiles().
+ *
+ *  Resources that are extracted to the same file name are extracted one after
+ *  the other, in archive order, so that the last one wins. Again, this is the
+ *  same as with the single-threaded extractFiles().
+ *
+ *  @param archive The archive to extract from.
+ *  @param game The game to alias types with.
+ *  @param directories Create directories? If false, directories will be stripped and the file
+ *         will be written directly into the current directory.
+ *  @param files A list of files to extract. If empty, all files from the archive will be
+ *         extracted.
+ *  @param jobs The number of threads to use. 0 means one per hardware thread.
+ *  @param opener Opens a new instance of the archive for each worker thread.
+ */
+void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
+                  const std::set<Common::UString> &files, size_t jobs, const ArchiveOpener &opener);
+
 /** Extract files from an NSBTX. */
 void extractFiles(const Aurora::NSBTXFile &nsbtx, const std::set<Common::UString> &files,
                   void (*dumper)(Common::SeekableReadStream &stream, const Common::UString &fileName));
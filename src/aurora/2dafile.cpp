@@ -27,8 +27,13 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include <utility>
+#include <array>
+#include <string>
+
+#include <boost/unordered_map.hpp>
 
 #include "src/common/util.h"
 #include "src/common/error.h"
@@ -51,89 +56,240 @@ static const uint32_t kVersion2b = MKTAG('V', '2', '.', 'b');
 
 namespace Aurora {
 
-TwoDARow::TwoDARow(TwoDAFile &parent) : _parent(&parent) {
+/** Character classes of bytes within an ASCII 2DA. */
+enum TwoDACharClass : byte {
+	kCharPlain,     ///< A printable ASCII character without special meaning.
+	kCharOther,     ///< NUL or a non-ASCII byte, both needing special treatment.
+	kCharSeparator, ///< Spaces and tabs separate cells.
+	kCharQuote,     ///< " quotes spaces and tabs.
+	kCharRowEnd,    ///< \n ends a whole row.
+	kCharIgnore     ///< \r is ignored.
+};
+
+static const std::array<byte, 256> kTwoDACharClasses = []() {
+	std::array<byte, 256> classes;
+
+	classes.fill(kCharOther);
+	for (size_t c = 0x01; c < 0x80; c++)
+		classes[c] = kCharPlain;
+
+	classes[' ' ] = kCharSeparator;
+	classes['\t'] = kCharSeparator;
+	classes['\"'] = kCharQuote;
+	classes['\n'] = kCharRowEnd;
+	classes['\r'] = kCharIgnore;
+
+	return classes;
+}();
+
+/** Splits the contents of an ASCII 2DA, held in memory, into cells.
+ *
+ *  This follows the same rules as a Common::StreamTokenizer with the separators,
+ *  quotes, chunk ends and ignores above, with consecutive separators ignored.
+ *  But instead of reading the data character by character out of a stream, it
+ *  scans over runs of plain characters in one go.
+ *
+ *  Like the StreamTokenizer, each byte is taken as one character. Non-ASCII bytes
+ *  are therefore taken to be Latin-1, and a NUL cuts off the rest of a cell.
+ */
+class TwoDAScanner : boost::noncopyable {
+public:
+	TwoDAScanner(const byte *data, size_t size) : _data(data), _size(size) {
+	}
+
+	/** Have we scanned all the data? */
+	bool eos() const {
+		return _pos >= _size;
+	}
+
+	/** Are we at the end of a row? */
+	bool isRowEnd() const {
+		return eos() || (_data[_pos] == '\n');
+	}
+
+	/** Read the next cell, and all the separators following it. */
+	const std::string &getToken() {
+		_token.clear();
+
+		bool inQuote   = false;
+		bool cutOff    = false;
+		bool separated = false;
+
+		while (_pos < _size) {
+			const byte c = _data[_pos];
+
+			switch (kTwoDACharClasses[c]) {
+				case kCharPlain: {
+					// Collect the whole run of plain characters at once
+					const size_t start = _pos;
+					while ((++_pos < _size) && (kTwoDACharClasses[_data[_pos]] == kCharPlain))
+						;
+
+					if (!cutOff)
+						_token.append(reinterpret_cast<const char *>(_data + start), _pos - start);
+					continue;
+				}
+
+				case kCharIgnore:
+					_pos++;
+					continue;
+
+				case kCharQuote:
+					inQuote = !inQuote;
+					_pos++;
+					continue;
+
+				case kCharRowEnd:
+					if (!inQuote)
+						break;
+
+					_pos++;
+					if (!cutOff)
+						_token.push_back(c);
+					continue;
+
+				case kCharSeparator:
+					_pos++;
+					if (!inQuote) {
+						separated = true;
+						break;
+					}
+
+					if (!cutOff)
+						_token.push_back(c);
+					continue;
+
+				default:
+					_pos++;
+					if (c == '\0')
+						cutOff = true;
+
+					if (!cutOff) {
+						// Latin-1 to UTF-8
+						_token.push_back(0xC0 | (c >> 6));
+						_token.push_back(0x80 | (c & 0x3F));
+					}
+					continue;
+			}
+
+			break;
+		}
+
+		if (separated)
+			while ((_pos < _size) && (kTwoDACharClasses[_data[_pos]] == kCharSeparator))
+				_pos++;
+
+		return _token;
+	}
+
+	/** Read up to max non-empty cells of the current row into list, filling up to min cells with def.
+	 *
+	 *  @return The number of non-empty cells read.
+	 */
+	size_t getTokens(std::vector<Common::UString> &list, size_t min = 0, size_t max = SIZE_MAX,
+	                 const Common::UString &def = "") {
+
+		list.clear();
+		list.reserve(min);
+
+		size_t count = 0;
+		while (!isRowEnd() && (count < max)) {
+			const std::string &token = getToken();
+
+			if (!token.empty()) {
+				list.emplace_back(token);
+				count++;
+			}
+		}
+
+		while (list.size() < min)
+			list.push_back(def);
+
+		return count;
+	}
+
+	/** Skip forward to the first character that's not a separator. */
+	void findFirstToken() {
+		while ((_pos < _size) && ((kTwoDACharClasses[_data[_pos]] == kCharSeparator) ||
+		                          (kTwoDACharClasses[_data[_pos]] == kCharIgnore)))
+			_pos++;
+	}
+
+	/** Skip the next cell. */
+	void skipToken() {
+		getToken();
+	}
+
+	/** Skip to the start of the next row. */
+	void nextRow() {
+		if (eos())
+			return;
+
+		const byte *rowEnd = static_cast<const byte *>(std::memchr(_data + _pos, '\n', _size - _pos));
+
+		_pos = rowEnd ? (rowEnd - _data + 1) : _size;
+	}
+
+private:
+	const byte *_data;
+	size_t _size;
+	size_t _pos { 0 };
+
+	std::string _token;
+};
+
+
+TwoDARow::TwoDARow() : _parent(0), _row(SIZE_MAX) {
 }
 
 TwoDARow::~TwoDARow() {
 }
 
 const Common::UString &TwoDARow::getString(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return _parent->getCellString(_row, column);
 }
 
 const Common::UString &TwoDARow::getString(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return _parent->getCellString(_row, _parent->headerToColumn(column));
 }
 
 int32_t TwoDARow::getInt(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getCellInt(_row, column);
 }
 
 int32_t TwoDARow::getInt(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getCellInt(_row, _parent->headerToColumn(column));
 }
 
 float TwoDARow::getFloat(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getCellFloat(_row, column);
 }
 
 float TwoDARow::getFloat(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getCellFloat(_row, _parent->headerToColumn(column));
 }
 
 bool TwoDARow::empty(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return true;
-
-	return false;
+	return TwoDAFile::isEmptyCell(_parent->getCell(_row, column));
 }
 
 bool TwoDARow::empty(const Common::UString &column) const {
 	return empty(_parent->headerToColumn(column));
 }
 
-static const Common::UString kEmpty;
-const Common::UString &TwoDARow::getCell(size_t n) const {
-	if (n >= _data.size())
-		return kEmpty;
-
-	return _data[n];
-}
-
 
 TwoDAFile::TwoDAFile(Common::SeekableReadStream &twoda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _rowCount(0) {
+
+	_emptyRow._parent = this;
 
 	load(twoda);
 }
 
 TwoDAFile::TwoDAFile(const GDAFile &gda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _rowCount(0) {
+
+	_emptyRow._parent = this;
 
 	load(gda);
 }
@@ -163,6 +319,8 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 		// Create the map to quickly translate headers to column indices
 		createHeaderMap();
 
+		createRows();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading 2DA file");
 		throw;
@@ -171,21 +329,18 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 }
 
 void TwoDAFile::read2a(Common::SeekableReadStream &twoda) {
-	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleIgnoreAll);
+	/* Read all the remaining data in one go, and then split it into cells
+	 * straight out of memory. */
 
-	// Spaces and tabs act to separate cells
-	tokenize.addSeparator(' ');
-	tokenize.addSeparator('\t');
-	// We can quote spaces and tabs with "
-	tokenize.addQuote('\"');
-	// \n ends a whole row
-	tokenize.addChunkEnd('\n');
-	// We're ignoring \r
-	tokenize.addIgnore('\r');
+	std::vector<byte> data(twoda.size() - twoda.pos());
+	if (!data.empty() && (twoda.read(data.data(), data.size()) != data.size()))
+		throw Common::Exception(Common::kReadError);
+
+	TwoDAScanner scanner(data.data(), data.size());
 
-	readDefault2a(twoda, tokenize);
-	readHeaders2a(twoda, tokenize);
-	readRows2a(twoda, tokenize);
+	readDefault2a(scanner);
+	readHeaders2a(scanner);
+	readRows2a(scanner);
 }
 
 void TwoDAFile::read2b(Common::SeekableReadStream &twoda) {
@@ -194,16 +349,14 @@ void TwoDAFile::read2b(Common::SeekableReadStream &twoda) {
 	readRows2b(twoda);
 }
 
-void TwoDAFile::readDefault2a(Common::SeekableReadStream &twoda,
-                              Common::StreamTokenizer &tokenize) {
-
+void TwoDAFile::readDefault2a(TwoDAScanner &scanner) {
 	/* ASCII 2DA files can have default values that are returned for cells
 	 * that don't exist. They are specified in the second line, optionally
 	 * preceded by "Default:".
 	 */
 
 	std::vector<Common::UString> defaultRow;
-	tokenize.getTokens(twoda, defaultRow, 2);
+	scanner.getTokens(defaultRow, 2);
 
 	if (defaultRow[0].equalsIgnoreCase("Default:"))
 		_defaultString = defaultRow[1];
@@ -211,48 +364,48 @@ void TwoDAFile::readDefault2a(Common::SeekableReadStream &twoda,
 	_defaultInt   = parseInt(_defaultString);
 	_defaultFloat = parseFloat(_defaultString);
 
-	tokenize.nextChunk(twoda);
+	scanner.nextRow();
 }
 
-void TwoDAFile::readHeaders2a(Common::SeekableReadStream &twoda,
-                              Common::StreamTokenizer &tokenize) {
-
+void TwoDAFile::readHeaders2a(TwoDAScanner &scanner) {
 	/* Read the column headers of an ASCII 2DA file. */
 
-	while (!twoda.eos() && (tokenize.getTokens(twoda, _headers) == 0))
-		tokenize.nextChunk(twoda);
+	while (!scanner.eos() && (scanner.getTokens(_headers) == 0))
+		scanner.nextRow();
 
-	tokenize.nextChunk(twoda);
+	scanner.nextRow();
 }
 
-void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
-                           Common::StreamTokenizer &tokenize) {
-
+void TwoDAFile::readRows2a(TwoDAScanner &scanner) {
 	/* And now read the individual cells in the rows. */
 
 	const size_t columnCount = _headers.size();
 
-	while (!twoda.eos()) {
-		std::unique_ptr<TwoDARow> row(new TwoDARow(*this));
+	_columns.resize(columnCount);
 
+	std::vector<Common::UString> row;
+	while (!scanner.eos()) {
 		/* Skip the first token, which is the row index, possibly indented.
 		 * The row index is implicit in the data and its use in the 2DA
 		 * file is only meant as a guideline for people editing the file by
 		 * hand. It might even be completely incorrect. */
-		tokenize.findFirstToken(twoda);
-		tokenize.skipToken(twoda);
+		scanner.findFirstToken();
+		scanner.skipToken();
 
 		// Read all the cells in the row
-		size_t count = tokenize.getTokens(twoda, row->_data, columnCount, columnCount, "****");
+		size_t count = scanner.getTokens(row, columnCount, columnCount, "****");
 
 		// And move to the next line
-		tokenize.nextChunk(twoda);
+		scanner.nextRow();
 
 		// Ignore empty lines
 		if (count == 0)
 			continue;
 
-		_rows.emplace_back(std::move(row));
+		for (size_t i = 0; i < columnCount; i++)
+			_columns[i].cells.emplace_back(std::move(row[i]));
+
+		_rowCount++;
 	}
 }
 
@@ -280,8 +433,11 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	 * there are.
 	 */
 
-	const uint32_t rowCount = twoda.readUint32LE();
-	_rows.resize(rowCount);
+	_rowCount = twoda.readUint32LE();
+
+	// Each row name takes up at least one byte
+	if (_rowCount > twoda.size() - twoda.pos())
+		throw Common::Exception("Invalid 2DA row count %u", (uint)_rowCount);
 
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
 
@@ -289,7 +445,7 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	tokenize.addSeparator('\t');
 	tokenize.addSeparator('\0');
 
-	tokenize.skipToken(twoda, rowCount);
+	tokenize.skipToken(twoda, _rowCount);
 }
 
 void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
@@ -301,7 +457,7 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 	 */
 
 	const size_t columnCount = _headers.size();
-	const size_t rowCount    = _rows.size();
+	const size_t rowCount    = _rowCount;
 	const size_t cellCount   = columnCount * rowCount;
 
 	std::unique_ptr<uint32_t[]> offsets = std::make_unique<uint32_t[]>(cellCount);
@@ -317,19 +473,21 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 
 	const size_t dataOffset = twoda.pos();
 
-	for (size_t i = 0; i < rowCount; i++) {
-		_rows[i].reset(new TwoDARow(*this));
-
-		_rows[i]->_data.resize(columnCount);
+	_columns.resize(columnCount);
+	for (size_t j = 0; j < columnCount; j++)
+		_columns[j].cells.resize(rowCount);
 
+	for (size_t i = 0; i < rowCount; i++) {
 		for (size_t j = 0; j < columnCount; j++) {
 			const size_t offset = dataOffset + offsets[i * columnCount + j];
 
 			twoda.seek(offset);
 
-			_rows[i]->_data[j] = tokenize.getToken(twoda);
-			if (_rows[i]->_data[j].empty())
-				_rows[i]->_data[j] = "****";
+			Common::UString &cell = _columns[j].cells[i];
+
+			cell = tokenize.getToken(twoda);
+			if (cell.empty())
+				cell = "****";
 		}
 	}
 }
@@ -339,6 +497,31 @@ void TwoDAFile::createHeaderMap() {
 		_headerMap.insert(std::make_pair(_headers[i], i));
 }
 
+const TwoDAFile::RowIndex &TwoDAFile::getRowIndex(size_t column) const {
+	assert(column < _columns.size());
+
+	_rowIndices.resize(_columns.size());
+
+	if (!_rowIndices[column]) {
+		_rowIndices[column] = std::make_unique<RowIndex>();
+
+		_rowIndices[column]->reserve(_rowCount);
+		for (size_t i = 0; i < _rowCount; i++)
+			_rowIndices[column]->insert(std::make_pair(getCellString(i, column), i));
+	}
+
+	return *_rowIndices[column];
+}
+
+void TwoDAFile::createRows() {
+	_rows.reset(new TwoDARow[_rowCount]);
+
+	for (size_t i = 0; i < _rowCount; i++) {
+		_rows[i]._parent = this;
+		_rows[i]._row    = i;
+	}
+}
+
 void TwoDAFile::load(const GDAFile &gda) {
 	try {
 
@@ -352,31 +535,35 @@ void TwoDAFile::load(const GDAFile &gda) {
 			_headers[i] = headerString ? headerString : Common::UString::format("[%u]", headers[i].hash);
 		}
 
-		_rows.resize(gda.getRowCount());
+		_rowCount = gda.getRowCount();
+
+		_columns.resize(gda.getColumnCount());
+		for (size_t j = 0; j < gda.getColumnCount(); j++)
+			_columns[j].cells.resize(_rowCount);
+
 		for (size_t i = 0; i < gda.getRowCount(); i++) {
 			const GFF4Struct *row = gda.getRow(i);
 
-			_rows[i].reset(new TwoDARow(*this));
-			_rows[i]->_data.resize(gda.getColumnCount());
-
 			for (size_t j = 0; j < gda.getColumnCount(); j++) {
+				Common::UString &cell = _columns[j].cells[i];
+
 				if (row) {
 					switch (headers[j].type) {
 						case GDAFile::kTypeString:
 						case GDAFile::kTypeResource:
-							_rows[i]->_data[j] = row->getString(headers[j].field);
+							cell = row->getString(headers[j].field);
 							break;
 
 						case GDAFile::kTypeInt:
-							_rows[i]->_data[j] = Common::UString::format("%d", (int) row->getSint(headers[j].field));
+							cell = Common::UString::format("%d", (int) row->getSint(headers[j].field));
 							break;
 
 						case GDAFile::kTypeFloat:
-							_rows[i]->_data[j] = Common::UString::format("%f", row->getDouble(headers[j].field));
+							cell = Common::UString::format("%f", row->getDouble(headers[j].field));
 							break;
 
 						case GDAFile::kTypeBool:
-							_rows[i]->_data[j] = Common::UString::format("%u", (uint) row->getUint(headers[j].field));
+							cell = Common::UString::format("%u", (uint) row->getUint(headers[j].field));
 							break;
 
 						default:
@@ -384,8 +571,8 @@ void TwoDAFile::load(const GDAFile &gda) {
 					}
 				}
 
-				if (_rows[i]->_data[j].empty())
-					_rows[i]->_data[j] = "****";
+				if (cell.empty())
+					cell = "****";
 
 			}
 		}
@@ -396,10 +583,11 @@ void TwoDAFile::load(const GDAFile &gda) {
 	}
 
 	createHeaderMap();
+	createRows();
 }
 
 size_t TwoDAFile::getRowCount() const {
-	return _rows.size();
+	return _rowCount;
 }
 
 size_t TwoDAFile::getColumnCount() const {
@@ -419,12 +607,68 @@ size_t TwoDAFile::headerToColumn(const Common::UString &header) const {
 	return column->second;
 }
 
+void TwoDAFile::parseColumns() {
+	for (Column &column : _columns) {
+		/* First find the type that fits all non-empty cells. Every integer
+		 * is also a valid floating point number, so we can go from integer
+		 * to float to string, never having to go back. */
+
+		column.type = kColumnInt;
+
+		for (const Common::UString &cell : column.cells) {
+			if (isEmptyCell(cell))
+				continue;
+
+			try {
+				if (column.type == kColumnInt) {
+					int32_t i;
+					Common::parseString(cell, i);
+					continue;
+				}
+			} catch (...) {
+				column.type = kColumnFloat;
+			}
+
+			try {
+				float f;
+				Common::parseString(cell, f);
+			} catch (...) {
+				column.type = kColumnString;
+				break;
+			}
+		}
+
+		column.ints.clear();
+		column.floats.clear();
+
+		// Now parse the values, the same way the cell getters would do it
+		if (column.type == kColumnInt) {
+			column.ints.resize(column.cells.size());
+			for (size_t i = 0; i < column.cells.size(); i++)
+				column.ints[i] = isEmptyCell(column.cells[i]) ? _defaultInt : parseInt(column.cells[i]);
+		}
+
+		if ((column.type == kColumnInt) || (column.type == kColumnFloat)) {
+			column.floats.resize(column.cells.size());
+			for (size_t i = 0; i < column.cells.size(); i++)
+				column.floats[i] = isEmptyCell(column.cells[i]) ? _defaultFloat : parseFloat(column.cells[i]);
+		}
+	}
+}
+
+TwoDAFile::ColumnType TwoDAFile::getColumnType(size_t column) const {
+	if (column >= _columns.size())
+		return kColumnString;
+
+	return _columns[column].type;
+}
+
 const TwoDARow &TwoDAFile::getRow(size_t row) const {
-	if ((row >= _rows.size()) || !_rows[row])
+	if (row >= _rowCount)
 		// No such row
 		return _emptyRow;
 
-	return *_rows[row].get();
+	return _rows[row];
 }
 
 const TwoDARow &TwoDAFile::getRow(const Common::UString &header, const Common::UString &value) const {
@@ -432,10 +676,11 @@ const TwoDARow &TwoDAFile::getRow(const Common::UString &header, const Common::U
 	if (columnIndex == kFieldIDInvalid)
 		return _emptyRow;
 
-	for (const auto &row : _rows) {
-		if (row->getString(columnIndex).equalsIgnoreCase(value))
-			return *row.get();
-	}
+	const RowIndex &index = getRowIndex(columnIndex);
+
+	RowIndex::const_iterator row = index.find(value);
+	if (row != index.end())
+		return _rows[row->second];
 
 	// No such row
 	return _emptyRow;
@@ -454,16 +699,16 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 	std::vector<size_t> colLength;
 	colLength.resize(_headers.size() + 1, 0);
 
-	const Common::UString maxRow = Common::UString::format("%d", (int)_rows.size() - 1);
+	const Common::UString maxRow = Common::UString::format("%d", (int)_rowCount - 1);
 	colLength[0] = maxRow.size();
 
 	for (size_t i = 0; i < _headers.size(); i++)
 		colLength[i + 1] = _headers[i].size();
 
-	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool   needQuote = _rows[i]->_data[j].contains(' ');
-			const size_t length    = needQuote ? _rows[i]->_data[j].size() + 2 : _rows[i]->_data[j].size();
+	for (size_t j = 0; j < _columns.size(); j++) {
+		for (const Common::UString &cell : _columns[j].cells) {
+			const bool   needQuote = cell.contains(' ');
+			const size_t length    = needQuote ? cell.size() + 2 : cell.size();
 
 			colLength[j + 1] = MAX<size_t>(colLength[j + 1], length);
 		}
@@ -480,17 +725,18 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 
 	// Write array
 
-	for (size_t i = 0; i < _rows.size(); i++) {
+	for (size_t i = 0; i < _rowCount; i++) {
 		out.writeString(Common::UString::format("%*u", (int)colLength[0], (uint)i));
 
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(' ');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = _columns[j].cells[i];
+			const bool needQuote = cell.contains(' ');
 
 			Common::UString cellString;
 			if (needQuote)
-				cellString = Common::UString::format("\"%s\"", _rows[i]->_data[j].c_str());
+				cellString = Common::UString::format("\"%s\"", cell.c_str());
 			else
-				cellString = _rows[i]->_data[j];
+				cellString = cell;
 
 			out.writeString(Common::UString::format(" %-*s", (int)colLength[j + 1], cellString.c_str()));
 
@@ -515,7 +761,7 @@ bool TwoDAFile::writeASCII(const Common::UString &fileName) const {
 
 void TwoDAFile::writeBinary(Common::WriteStream &out) const {
 	const size_t columnCount = _headers.size();
-	const size_t rowCount    = _rows.size();
+	const size_t rowCount    = _rowCount;
 	const size_t cellCount   = columnCount * rowCount;
 
 	out.writeString("2DA V2.b\n");
@@ -546,13 +792,16 @@ void TwoDAFile::writeBinary(Common::WriteStream &out) const {
 	 *
 	 * Basically, this involves going through each cell, and looking up
 	 * if we already saved this particular piece of data. If not, save
-	 * it, otherwise only remember the offset. There's no need to be
-	 * particularly smart about it, so we're just doing it the naive
-	 * O(n^2) way.
+	 * it, otherwise only remember the offset. We keep a hash map from
+	 * the data strings to their index in the data array, so that large
+	 * tables don't degrade into quadratic runtime.
 	 */
 
+	typedef boost::unordered_map<Common::UString, size_t, Common::hashUStringCaseSensitive> DataMap;
+
 	std::vector<Common::UString> data;
 	std::vector<size_t> offsets;
+	DataMap dataMap;
 
 	data.reserve(cellCount);
 	offsets.reserve(cellCount);
@@ -563,23 +812,15 @@ void TwoDAFile::writeBinary(Common::WriteStream &out) const {
 	cells.reserve(cellCount);
 
 	for (size_t i = 0; i < rowCount; i++) {
-		assert(_rows[i]);
-
 		for (size_t j = 0; j < columnCount; j++) {
-			const Common::UString cell = _rows[i]->getString(j);
+			const Common::UString &cell = getCellString(i, j);
 
 			// Do we already know about this cell data string?
-			size_t foundCell = SIZE_MAX;
-			for (size_t k = 0; k < data.size(); k++) {
-				if (data[k] == cell) {
-					foundCell = k;
-					break;
-				}
-			}
+			std::pair<DataMap::iterator, bool> found = dataMap.insert(std::make_pair(cell, data.size()));
+			const size_t foundCell = found.first->second;
 
 			// If not, add it to the cell data array
-			if (foundCell == SIZE_MAX) {
-				foundCell = data.size();
+			if (found.second) {
 
 				data.push_back(cell);
 				offsets.push_back(dataSize);
@@ -641,20 +882,21 @@ void TwoDAFile::writeCSV(Common::WriteStream &out) const {
 
 	// Write array
 
-	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(',');
+	for (size_t i = 0; i < _rowCount; i++) {
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = _columns[j].cells[i];
+			const bool needQuote = cell.contains(',');
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (_rows[i]->_data[j] != "****")
-				out.writeString(_rows[i]->_data[j]);
+			if (cell != "****")
+				out.writeString(cell);
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (j < (_rows[i]->_data.size() - 1))
+			if (j < (_columns.size() - 1))
 				out.writeByte(',');
 		}
 
@@ -675,6 +917,49 @@ bool TwoDAFile::writeCSV(const Common::UString &fileName) const {
 	return true;
 }
 
+static const Common::UString kEmptyCell;
+
+const Common::UString &TwoDAFile::getCell(size_t row, size_t column) const {
+	if ((row >= _rowCount) || (column >= _columns.size()))
+		return kEmptyCell;
+
+	return _columns[column].cells[row];
+}
+
+const Common::UString &TwoDAFile::getCellString(size_t row, size_t column) const {
+	const Common::UString &cell = getCell(row, column);
+	if (isEmptyCell(cell))
+		return _defaultString;
+
+	return cell;
+}
+
+int32_t TwoDAFile::getCellInt(size_t row, size_t column) const {
+	if ((row < _rowCount) && (column < _columns.size()) && (_columns[column].type == kColumnInt))
+		return _columns[column].ints[row];
+
+	const Common::UString &cell = getCell(row, column);
+	if (isEmptyCell(cell))
+		return _defaultInt;
+
+	return parseInt(cell);
+}
+
+float TwoDAFile::getCellFloat(size_t row, size_t column) const {
+	if ((row < _rowCount) && (column < _columns.size()) && (_columns[column].type != kColumnString))
+		return _columns[column].floats[row];
+
+	const Common::UString &cell = getCell(row, column);
+	if (isEmptyCell(cell))
+		return _defaultFloat;
+
+	return parseFloat(cell);
+}
+
+bool TwoDAFile::isEmptyCell(const Common::UString &cell) {
+	return cell.empty() || (cell == "****");
+}
+
 int32_t TwoDAFile::parseInt(const Common::UString &str) {
 	if (str.empty())
 		return 0;
@@ -30,6 +30,7 @@
 #include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
@@ -39,13 +40,13 @@
 namespace Common {
 	class SeekableReadStream;
 	class WriteStream;
-	class StreamTokenizer;
 }
 
 namespace Aurora {
 
 class TwoDAFile;
 class GDAFile;
+class TwoDAScanner;
 
 /** A row within a 2DA file.
  *
@@ -56,6 +57,9 @@ class GDAFile;
  *  For convenience's sake, there are also methods to directly parse
  *  the cell strings into integer or floating point values.
  *
+ *  The cells themselves are owned by the parent 2DA, which stores
+ *  them column by column. A row only refers to them.
+ *
  *  See also class TwoDAFile.
  */
 class TwoDARow : boost::noncopyable {
@@ -83,13 +87,10 @@ public:
 	bool empty(const Common::UString &column) const;
 
 private:
-	TwoDAFile *_parent; ///< The parent 2DA.
-
-	std::vector<Common::UString> _data;
+	const TwoDAFile *_parent; ///< The parent 2DA.
+	size_t _row;              ///< The index of this row within the parent 2DA.
 
-	TwoDARow(TwoDAFile &parent);
-
-	const Common::UString &getCell(size_t n) const;
+	TwoDARow();
 
 	friend class TwoDAFile;
 };
@@ -121,6 +122,13 @@ private:
  */
 class TwoDAFile : boost::noncopyable, public AuroraFile {
 public:
+	/** The type of the values within a column. */
+	enum ColumnType {
+		kColumnString, ///< The column holds strings, or its type hasn't been determined.
+		kColumnInt,    ///< All non-empty cells in the column are integers.
+		kColumnFloat   ///< All non-empty cells in the column are floating point numbers.
+	};
+
 	TwoDAFile(Common::SeekableReadStream &twoda);
 	TwoDAFile(const GDAFile &gda);
 	~TwoDAFile();
@@ -137,10 +145,26 @@ public:
 	/** Translate a column header to a column index. */
 	size_t headerToColumn(const Common::UString &header) const;
 
+	/** Determine the types of all columns, and parse the numeric ones.
+	 *
+	 *  Afterwards, getInt() and getFloat() on cells in a column that only
+	 *  holds numbers return values parsed here, instead of parsing the cell
+	 *  string on each call. The results are the same either way.
+	 */
+	void parseColumns();
+
+	/** Return the type of a column, as determined by parseColumns(). */
+	ColumnType getColumnType(size_t column) const;
+
 	/** Get a row. */
 	const TwoDARow &getRow(size_t row) const;
 
-	/** Get a row whose value in the column named header is the given string value. */
+	/** Get a row whose value in the column named header is the given string value.
+	 *
+	 *  The comparison is case-insensitive. If several rows match, the first one
+	 *  is returned. The first lookup in a column indexes all of that column's
+	 *  values, making further lookups in the same column O(1).
+	 */
 	const TwoDARow &getRow(const Common::UString &header, const Common::UString &value) const;
 
 	// .--- 2DA file writers
@@ -163,6 +187,20 @@ public:
 private:
 	typedef std::map<Common::UString, size_t, Common::UString::iless> HeaderMap;
 
+	/** Map of a column's cell values to the first row with that value. */
+	typedef boost::unordered_map<Common::UString, size_t,
+	                             Common::hashUStringCaseInsensitive, Common::UString::iequal> RowIndex;
+
+	/** A column of a 2DA, holding that column's cells of all rows. */
+	struct Column {
+		ColumnType type { kColumnString };
+
+		std::vector<Common::UString> cells; ///< The cell strings.
+
+		std::vector<int32_t> ints;   ///< The parsed cell values, for kColumnInt.
+		std::vector<float>   floats; ///< The parsed cell values, for kColumnInt and kColumnFloat.
+	};
+
 	Common::UString _defaultString; ///< The default string to return should a cell not exist.
 	int32_t         _defaultInt;    ///< The default int to return should a cell not exist.
 	float           _defaultFloat;  ///< The default float to return should a cell not exist.
@@ -170,8 +208,14 @@ private:
 	std::vector<Common::UString> _headers;
 	HeaderMap _headerMap;
 
+	std::vector<Column> _columns;
+
+	size_t _rowCount;
+	std::unique_ptr<TwoDARow[]> _rows;
 	TwoDARow _emptyRow;
-	std::vector<std::unique_ptr<TwoDARow>> _rows;
+
+	/** Per-column indices for getRow(header, value), created on first use. */
+	mutable std::vector<std::unique_ptr<RowIndex>> _rowIndices;
 
 	// Loading helpers
 	void load(Common::SeekableReadStream &twoda);
@@ -179,9 +223,9 @@ private:
 	void read2b(Common::SeekableReadStream &twoda);
 
 	// ASCII loading helpers
-	void readDefault2a(Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
-	void readHeaders2a(Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
-	void readRows2a   (Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
+	void readDefault2a(TwoDAScanner &scanner);
+	void readHeaders2a(TwoDAScanner &scanner);
+	void readRows2a   (TwoDAScanner &scanner);
 
 	// Binary loading helpers
 	void readHeaders2b (Common::SeekableReadStream &twoda);
@@ -192,6 +236,18 @@ private:
 	void load(const GDAFile &gda);
 
 	void createHeaderMap();
+	void createRows();
+
+	const RowIndex &getRowIndex(size_t column) const;
+
+	// Cell access helpers
+	const Common::UString &getCell(size_t row, size_t column) const;
+
+	const Common::UString &getCellString(size_t row, size_t column) const;
+	int32_t getCellInt  (size_t row, size_t column) const;
+	float   getCellFloat(size_t row, size_t column) const;
+
+	static bool isEmptyCell(const Common::UString &cell);
 
 	static int32_t parseInt(const Common::UString &str);
 	static float parseFloat(const Common::UString &str);
@@ -68,7 +68,7 @@ public:
 	/** Return a stream of the resource's contents.
 	 *
 	 *  @param  index The index of the resource we want.
-	 *  @param  tryNoCopy Try to return a SeekableSubReadStream of the archive instead of copying.
+	 *  @param  tryNoCopy Try to return a stream reading directly from the archive instead of copying.
 	 *  @return A (sub)stream of the resource's contents.
 	 */
 	virtual Common::SeekableReadStream *getResource(uint32_t index, bool tryNoCopy = false) const = 0;
@@ -48,6 +48,9 @@ BIFFile::BIFFile(Common::SeekableReadStream *bif) : _bif(bif) {
 	load(*_bif);
 }
 
+BIFFile::BIFFile() {
+}
+
 BIFFile::~BIFFile() {
 }
 
@@ -146,11 +149,9 @@ Common::SeekableReadStream *BIFFile::getResource(uint32_t index, bool tryNoCopy)
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_bif.get(), res.offset, res.offset + res.size);
-
-	_bif->seek(res.offset);
+		return _bif->getSubStream(res.offset, res.offset + res.size);
 
-	return _bif->readStream(res.size);
+	return _bif->readStreamAt(res.offset, res.size);
 }
 
 } // End of namespace Aurora
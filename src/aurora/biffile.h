@@ -115,10 +115,15 @@ private:
 	/** Internal list of resource offsets and sizes. */
 	IResourceList _iResources;
 
+	/** Create an empty BIF file, to be filled by a KEYIndexCache. */
+	BIFFile();
+
 	void load(Common::SeekableReadStream &bif);
 	void readVarResTable(Common::SeekableReadStream &bif, uint32_t offset);
 
 	const IResource &getIResource(uint32_t index) const;
+
+	friend class KEYIndexCache;
 };
 
 } // End of namespace Aurora
@@ -23,6 +23,8 @@
  * A writer for BIF archive files.
  */
 
+#include "src/common/memwritestream.h"
+
 #include "src/aurora/bifwriter.h"
 #include "src/aurora/types.h"
 
@@ -32,7 +34,7 @@ static const uint32_t kV1ID  = MKTAG('V', '1', ' ', ' ');
 namespace Aurora {
 
 BIFWriter::BIFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStream) :
-		_maxFiles(fileCount), _currentFiles(0), _dataOffset(0), _writer(writeStream) {
+		_maxFiles(fileCount), _dataOffset(0), _writer(writeStream), _writtenEntries(0) {
 	// Write id and version.
 	writeStream.writeUint32BE(kBIFFID);
 	writeStream.writeUint32BE(kV1ID);
@@ -42,30 +44,58 @@ BIFWriter::BIFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStrea
 	writeStream.writeUint32LE(20);
 
 	writeStream.writeZeros(fileCount * 16);
+
+	_entries.reserve(fileCount);
+}
+
+BIFWriter::~BIFWriter() {
+	try {
+		flush();
+	} catch (...) {
+	}
 }
 
 uint32_t BIFWriter::size() {
-	_writer.seek(0, Common::SeekableWriteStream::kOriginEnd);
-	return _writer.pos();
+	flush();
+
+	return 20 + _maxFiles * 16 + _dataOffset;
 }
 
 void BIFWriter::add(Common::SeekableReadStream &data, Aurora::FileType type) {
-	if (_currentFiles >= _maxFiles)
+	if (_entries.size() >= _maxFiles)
 		throw Common::Exception("BIFWriter::add() Attempt to write more files than maximum");
 
-	_writer.seek(0, Common::SeekableWriteStream::kOriginEnd);
+	// The stream is always positioned at the end of the data, so no seeking is necessary
 	size_t fileSize = _writer.writeStream(data);
 	data.seek(0);
 
-	_writer.seek(20 + _currentFiles * 16);
-
-	_writer.writeUint32LE(_currentFiles); // Index
-	_writer.writeUint32LE(20 + _maxFiles * 16 + _dataOffset); // Data offset
-	_writer.writeUint32LE(fileSize); // File size
-	_writer.writeUint32LE(type); // Type
+	_entries.push_back({ 20 + _maxFiles * 16 + _dataOffset, static_cast<uint32_t>(fileSize), type });
 
-	++_currentFiles;
 	_dataOffset += fileSize;
+
+	if (_writtenCallback)
+		_writtenCallback(_entries.size() - 1);
+}
+
+void BIFWriter::flush() {
+	if (_writtenEntries == _entries.size())
+		return;
+
+	// Collect all new table entries, to write them in one go
+	Common::MemoryWriteStreamDynamic table(true, (_entries.size() - _writtenEntries) * 16);
+
+	for (size_t i = _writtenEntries; i < _entries.size(); i++) {
+		table.writeUint32LE(i);                   // Index
+		table.writeUint32LE(_entries[i].offset);  // Data offset
+		table.writeUint32LE(_entries[i].size);    // File size
+		table.writeUint32LE(_entries[i].type);    // Type
+	}
+
+	_writer.seek(20 + _writtenEntries * 16);
+	_writer.write(table.getData(), table.size());
+	_writer.seek(0, Common::SeekableWriteStream::kOriginEnd);
+
+	_writtenEntries = _entries.size();
 }
 
 } // End of namespace Aurora
@@ -26,6 +26,8 @@
 #ifndef AURORA_BIFWRITER_H
 #define AURORA_BIFWRITER_H
 
+#include <vector>
+
 #include "src/common/writestream.h"
 #include "src/common/readstream.h"
 #include "src/common/types.h"
@@ -38,6 +40,10 @@ namespace Aurora {
 /**
  * The purpose of this class is to write a BIF file containing
  * every data added by add().
+ *
+ * The file data is written sequentially, while the file table is
+ * kept in memory and only written by flush(), size() or when the
+ * writer is destroyed.
  */
 class BIFWriter : public KEYDataWriter {
 public:
@@ -47,26 +53,42 @@ public:
 	 * @param writeStream the stream to write to
 	 */
 	BIFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStream);
+	/** Write the file table. Errors are ignored; call flush() to see them. */
+	~BIFWriter();
 
 	/**
-	 * Add new data by stream to this BIF file and write also offset,
-	 * size and type.
+	 * Add new data by stream to this BIF file and remember its offset,
+	 * size and type for the file table.
 	 * @param data the data to add to this archive
 	 * @param type the file type of the given data
 	 */
 	void add(Common::SeekableReadStream &data, Aurora::FileType type);
 
+	/** Write the file table for all files added so far. */
+	void flush();
+
 	/**
 	 * The current total size of this file, needed for the KEY file.
+	 * This also writes the file table.
 	 * @return the current total size of this file
 	 */
 	uint32_t size();
 
 private:
+	/** A file table entry. */
+	struct Entry {
+		uint32_t offset;
+		uint32_t size;
+		Aurora::FileType type;
+	};
+
 	const uint32_t _maxFiles;
-	uint32_t _currentFiles;
 	uint32_t _dataOffset;
 	Common::SeekableWriteStream &_writer;
+
+	std::vector<Entry> _entries;
+	/** The number of entries already written into the file table. */
+	size_t _writtenEntries;
 };
 
 } // End of namespace Aurora
@@ -47,6 +47,9 @@ BZFFile::BZFFile(Common::SeekableReadStream *bzf) : _bzf(bzf) {
 	load(*_bzf);
 }
 
+BZFFile::BZFFile() {
+}
+
 BZFFile::~BZFFile() {
 }
 
@@ -101,10 +101,15 @@ private:
 	/** Internal list of resource offsets and sizes. */
 	IResourceList _iResources;
 
+	/** Create an empty BZF file, to be filled by a KEYIndexCache. */
+	BZFFile();
+
 	void load(Common::SeekableReadStream &bzf);
 	void readVarResTable(Common::SeekableReadStream &bzf, uint32_t offset);
 
 	const IResource &getIResource(uint32_t index) const;
+
+	friend class KEYIndexCache;
 };
 
 } // End of namespace Aurora
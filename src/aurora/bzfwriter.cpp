@@ -23,8 +23,13 @@
  * A writer for BZF (lzma compressed BIF) archive files.
  */
 
+#include <cassert>
+
 #include <memory>
+#include <chrono>
 
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/common/lzma.h"
 
 #include "src/aurora/bzfwriter.h"
@@ -34,8 +39,10 @@ static const uint32_t kV1ID  = MKTAG('V', '1', ' ', ' ');
 
 namespace Aurora {
 
-BZFWriter::BZFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStream) :
-		_maxFiles(fileCount), _currentFiles(0), _dataOffset(0), _writer(writeStream) {
+BZFWriter::BZFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStream, size_t threadCount,
+                     const CompressionOptions &compressionOptions, CompressionStatistics *statistics) :
+		_maxFiles(fileCount), _dataOffset(0), _writer(writeStream), _compressionOptions(compressionOptions),
+		_statistics(statistics), _writtenEntries(0) {
 	writeStream.writeUint32BE(kBIFFID);
 	writeStream.writeUint32BE(kV1ID);
 
@@ -44,10 +51,23 @@ BZFWriter::BZFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStrea
 	writeStream.writeUint32LE(20);
 
 	writeStream.writeZeros(fileCount * 16);
+
+	_entries.reserve(fileCount);
+
+	threadCount = Common::ThreadPool::getThreadCount(threadCount);
+	if (threadCount > 1)
+		_threadPool = std::make_unique<Common::ThreadPool>(threadCount);
+}
+
+BZFWriter::~BZFWriter() {
+	try {
+		flush();
+	} catch (...) {
+	}
 }
 
 void BZFWriter::add(Common::SeekableReadStream &data, Aurora::FileType type) {
-	if (_currentFiles >= _maxFiles)
+	if ((_entries.size() + _pending.size()) >= _maxFiles)
 		throw Common::Exception("BIFWriter::add() Attempt to write more files than maximum");
 
 	// Determine the size of the file to write.
@@ -55,25 +75,131 @@ void BZFWriter::add(Common::SeekableReadStream &data, Aurora::FileType type) {
 	size_t length = data.pos();
 	data.seek(0);
 
-	_writer.seek(0, Common::SeekableWriteStream::kOriginEnd);
+	if (!_threadPool) {
+		std::unique_ptr<Common::SeekableReadStream> stream(compress(data, length, type));
+		write(*stream, length, type);
+		return;
+	}
+
+	/* Read the file into memory and queue it for compression. To keep the
+	 * amount of memory in check, write out the oldest queued files while
+	 * there are more than two waiting for each thread. */
+
+	while (_pending.size() >= (2 * _threadPool->getThreadCount()))
+		writePending();
+
+	std::shared_ptr<Common::SeekableReadStream> uncompressed(data.readStream(length));
+
+	_pending.emplace_back();
 
-	std::unique_ptr<Common::SeekableReadStream> stream(Common::compressLZMA1(data, length));
-	_writer.writeStream(*stream);
+	PendingFile &file = _pending.back();
 
-	_writer.seek(20 + _currentFiles * 16);
+	file.type   = type;
+	file.length = length;
 
-	_writer.writeUint32LE(_currentFiles); // Index
-	_writer.writeUint32LE(20 + _maxFiles * 16 + _dataOffset); // Data offset
-	_writer.writeUint32LE(length); // File size
-	_writer.writeUint32LE(type); // Type
+	file.data = _threadPool->addTask<std::unique_ptr<Common::SeekableReadStream>>([this, uncompressed, length, type]() {
+		return std::unique_ptr<Common::SeekableReadStream>(compress(*uncompressed, length, type));
+	});
 
-	++_currentFiles;
-	_dataOffset += stream->size();
+	// Write out whatever's already done
+	while (!_pending.empty() &&
+	       (_pending.front().data.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+		writePending();
 }
 
-uint32_t BZFWriter::size() {
+void BZFWriter::flush() {
+	while (!_pending.empty())
+		writePending();
+
+	writeTable();
+}
+
+void BZFWriter::writePending() {
+	assert(!_pending.empty());
+
+	PendingFile file = std::move(_pending.front());
+	_pending.pop_front();
+
+	std::unique_ptr<Common::SeekableReadStream> stream;
+	try {
+		stream = file.data.get();
+	} catch (Common::Exception &e) {
+		e.add("Failed to compress file %u", (uint)(_entries.size() + 1));
+		throw;
+	} catch (std::exception &se) {
+		Common::Exception e(se);
+		e.add("Failed to compress file %u", (uint)(_entries.size() + 1));
+		throw e;
+	}
+
+	write(*stream, file.length, file.type);
+}
+
+Common::SeekableReadStream *BZFWriter::compress(Common::SeekableReadStream &data, size_t length,
+                                                Aurora::FileType type) const {
+
+	const CompressionStatistics::Clock::time_point start = CompressionStatistics::Clock::now();
+
+	std::unique_ptr<byte[]> inputData = std::make_unique<byte[]>(length);
+	if (data.read(inputData.get(), length) != length)
+		throw Common::Exception(Common::kReadError);
+
+	uint level = (_compressionOptions.level < 0) ? Common::kLZMALevelDefault : _compressionOptions.level;
+	bool extreme = _compressionOptions.lzmaExtreme;
+
+	// BZF files can't store data uncompressed, so use the fastest LZMA preset instead
+	const bool incompressible = _compressionOptions.fastIncompressible && isIncompressible(inputData.get(), length);
+	if (incompressible) {
+		level   = 0;
+		extreme = false;
+	}
+
+	size_t outputSize = 0;
+	byte *outputData = Common::compressLZMA1(inputData.get(), length, outputSize, level, extreme);
+
+	if (_statistics)
+		_statistics->add(type, length, outputSize, incompressible, CompressionStatistics::Clock::now() - start);
+
+	return new Common::MemoryReadStream(outputData, outputSize, true);
+}
+
+void BZFWriter::write(Common::SeekableReadStream &compressed, size_t length, Aurora::FileType type) {
+	// The stream is always positioned at the end of the data, so no seeking is necessary
+	_writer.writeStream(compressed);
+
+	_entries.push_back({ 20 + _maxFiles * 16 + _dataOffset, static_cast<uint32_t>(length), type });
+
+	_dataOffset += compressed.size();
+
+	if (_writtenCallback)
+		_writtenCallback(_entries.size() - 1);
+}
+
+void BZFWriter::writeTable() {
+	if (_writtenEntries == _entries.size())
+		return;
+
+	// Collect all new table entries, to write them in one go
+	Common::MemoryWriteStreamDynamic table(true, (_entries.size() - _writtenEntries) * 16);
+
+	for (size_t i = _writtenEntries; i < _entries.size(); i++) {
+		table.writeUint32LE(i);                   // Index
+		table.writeUint32LE(_entries[i].offset);  // Data offset
+		table.writeUint32LE(_entries[i].size);    // File size
+		table.writeUint32LE(_entries[i].type);    // Type
+	}
+
+	_writer.seek(20 + _writtenEntries * 16);
+	_writer.write(table.getData(), table.size());
 	_writer.seek(0, Common::SeekableWriteStream::kOriginEnd);
-	return _writer.pos();
+
+	_writtenEntries = _entries.size();
+}
+
+uint32_t BZFWriter::size() {
+	flush();
+
+	return 20 + _maxFiles * 16 + _dataOffset;
 }
 
 } // End of namespace Aurora
@@ -26,9 +26,16 @@
 #ifndef AURORA_BZFWRITER_H
 #define AURORA_BZFWRITER_H
 
+#include <deque>
+#include <vector>
+#include <memory>
+#include <future>
+
 #include "src/common/writestream.h"
+#include "src/common/threadpool.h"
 
 #include "src/aurora/keydatawriter.h"
+#include "src/aurora/compression.h"
 
 namespace Aurora {
 
@@ -37,17 +44,76 @@ namespace Aurora {
  */
 class BZFWriter : public KEYDataWriter {
 public:
-	BZFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStream);
+	/**
+	 * Create a new BZF writer reserving place for fileCount files.
+	 * @param fileCount the count of files to reserve
+	 * @param writeStream the stream to write to
+	 * @param threadCount the number of threads to compress files with. 0 means
+	 *                    one per CPU core, 1 compresses each file within add().
+	 * @param compressionOptions how to compress the files.
+	 * @param statistics if not nullptr, collect statistics about the compressed files here.
+	 */
+	BZFWriter(uint32_t fileCount, Common::SeekableWriteStream &writeStream, size_t threadCount = 1,
+	          const CompressionOptions &compressionOptions = CompressionOptions(),
+	          CompressionStatistics *statistics = nullptr);
+	/** Write all pending files and the file table. Errors are ignored; call flush() to see them. */
+	~BZFWriter();
 
+	/**
+	 * Add new data to this BZF file. When compressing with several threads,
+	 * the data is only queued for compression, and written once compressed,
+	 * in the order it was added.
+	 */
 	void add(Common::SeekableReadStream &data, Aurora::FileType type);
 
+	/**
+	 * Wait for all queued files to be compressed, and write them. Then write
+	 * the file table, which is otherwise kept in memory.
+	 */
+	void flush();
+
+	/** The total size of this file, after writing all queued files and the file table. */
 	uint32_t size();
 
 private:
+	/** A file queued for compression. */
+	struct PendingFile {
+		Aurora::FileType type;
+		size_t length;
+
+		std::future<std::unique_ptr<Common::SeekableReadStream>> data;
+	};
+
+	/** A file table entry. */
+	struct Entry {
+		uint32_t offset;
+		uint32_t size;
+		Aurora::FileType type;
+	};
+
 	const uint32_t _maxFiles;
-	uint32_t _currentFiles;
 	uint32_t _dataOffset;
 	Common::SeekableWriteStream &_writer;
+
+	const CompressionOptions _compressionOptions;
+	CompressionStatistics *_statistics;
+
+	std::vector<Entry> _entries;
+	/** The number of entries already written into the file table. */
+	size_t _writtenEntries;
+
+	std::unique_ptr<Common::ThreadPool> _threadPool;
+	std::deque<PendingFile> _pending;
+
+	/** Compress the data of a file. Safe to be called from several threads at once. */
+	Common::SeekableReadStream *compress(Common::SeekableReadStream &data, size_t length, Aurora::FileType type) const;
+
+	void write(Common::SeekableReadStream &compressed, size_t length, Aurora::FileType type);
+
+	/** Write the oldest queued file, waiting for it to be compressed if necessary. */
+	void writePending();
+	/** Write the file table entries of all files written since the last call. */
+	void writeTable();
 };
 
 } // End of namespace Aurora
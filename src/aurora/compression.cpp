@@ -0,0 +1,105 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Options and statistics for compressing resources in archive writers.
+ */
+
+#include "src/common/maths.h"
+#include "src/common/ustring.h"
+#include "src/common/writestream.h"
+
+#include "src/aurora/compression.h"
+#include "src/aurora/util.h"
+
+namespace Aurora {
+
+bool isIncompressible(const byte *data, size_t size) {
+	/* Already compressed data, like Ogg Vorbis or Bink video, uses nearly all
+	 * byte values equally often. For small amounts of data, the entropy is
+	 * unreliable, but compressing those doesn't take long anyway. */
+
+	static const size_t kMinSize    = 4096;
+	static const double kMinEntropy = 7.9;
+
+	if (size < kMinSize)
+		return false;
+
+	return Common::getEntropy(data, size) >= kMinEntropy;
+}
+
+void CompressionStatistics::add(FileType type, size_t uncompressedSize, size_t compressedSize,
+                                bool incompressible, Clock::duration time) {
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	Type &t = _types[type];
+
+	t.count               += 1;
+	t.incompressibleCount += incompressible ? 1 : 0;
+	t.uncompressedSize    += uncompressedSize;
+	t.compressedSize      += compressedSize;
+	t.time                += time;
+}
+
+CompressionStatistics::Types CompressionStatistics::getTypes() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _types;
+}
+
+static Common::UString formatType(const Common::UString &name, const CompressionStatistics::Type &t) {
+	const double ratio = (t.uncompressedSize == 0) ? 1.0 :
+		(static_cast<double>(t.compressedSize) / static_cast<double>(t.uncompressedSize));
+	const double time  = std::chrono::duration<double>(t.time).count();
+
+	return Common::UString::format("%-8s %8u %8u %14llu %14llu %7.2f%% %10.3fs\n", name.c_str(),
+	                               (uint)t.count, (uint)t.incompressibleCount,
+	                               (unsigned long long)t.uncompressedSize,
+	                               (unsigned long long)t.compressedSize,
+	                               ratio * 100.0, time);
+}
+
+void CompressionStatistics::write(Common::WriteStream &stream) const {
+	const Types types = getTypes();
+
+	stream.writeString(Common::UString::format("%-8s %8s %8s %14s %14s %8s %11s\n",
+	                                           "Type", "Count", "Incompr.", "Uncompressed",
+	                                           "Compressed", "Ratio", "Time"));
+
+	Type total;
+	for (const auto &type : types) {
+		Common::UString name = TypeMan.setFileType("", type.first);
+		if (name.empty())
+			name = Common::UString::format("%d", (int)type.first);
+
+		stream.writeString(formatType(name, type.second));
+
+		total.count               += type.second.count;
+		total.incompressibleCount += type.second.incompressibleCount;
+		total.uncompressedSize    += type.second.uncompressedSize;
+		total.compressedSize      += type.second.compressedSize;
+		total.time                += type.second.time;
+	}
+
+	stream.writeString(formatType("Total", total));
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,104 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Options and statistics for compressing resources in archive writers.
+ */
+
+#ifndef AURORA_COMPRESSION_H
+#define AURORA_COMPRESSION_H
+
+#include <map>
+#include <mutex>
+#include <chrono>
+
+#include "src/common/types.h"
+#include "src/common/deflate.h"
+
+#include "src/aurora/types.h"
+
+namespace Common {
+	class WriteStream;
+}
+
+namespace Aurora {
+
+/** How an archive writer should compress its resources. */
+struct CompressionOptions {
+	/** The compression level, from 0 (fastest) to 9 (best). -1 uses the default of the archive format. */
+	int level { -1 };
+
+	/** The strategy for archives compressed with DEFLATE. */
+	Common::DeflateStrategy deflateStrategy { Common::kDeflateStrategyDefault };
+
+	/** Use the slower "extreme" variant of the level for archives compressed with LZMA. */
+	bool lzmaExtreme { false };
+
+	/** Compress resources that look incompressible with the fastest level only.
+	 *
+	 *  Neither ERF nor BZF archives can mark single resources as uncompressed,
+	 *  so data like already compressed sound or video is still put through the
+	 *  compressor, but at a level that costs next to no time.
+	 */
+	bool fastIncompressible { false };
+};
+
+/** Does this data look like it can't be compressed any further? */
+bool isIncompressible(const byte *data, size_t size);
+
+/** Statistics about compressed resources, collected per file type.
+ *
+ *  The statistics can be safely added to from several threads at once.
+ */
+class CompressionStatistics {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Type {
+		size_t count { 0 };               ///< Number of resources.
+		size_t incompressibleCount { 0 }; ///< Number of resources that looked incompressible.
+
+		uint64_t uncompressedSize { 0 };  ///< Size of all resources before compression.
+		uint64_t compressedSize { 0 };    ///< Size of all resources after compression.
+
+		Clock::duration time { Clock::duration::zero() }; ///< Time spent compressing.
+	};
+
+	typedef std::map<FileType, Type> Types;
+
+	/** Record the compression of one resource. */
+	void add(FileType type, size_t uncompressedSize, size_t compressedSize, bool incompressible,
+	         Clock::duration time);
+
+	/** Return the statistics of all file types seen so far. */
+	Types getTypes() const;
+
+	/** Write the statistics as a human-readable table. */
+	void write(Common::WriteStream &stream) const;
+
+private:
+	mutable std::mutex _mutex;
+
+	Types _types;
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_COMPRESSION_H
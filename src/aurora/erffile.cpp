@@ -304,7 +304,8 @@ void ERFFile::decryptNWNPremium() {
 
 	_erf->seek(0);
 
-	_erf.reset(decrypt(*_erf, kEncryptionBlowfishNWN, _password));
+	// Decrypt on demand, instead of decrypting the whole file into memory here
+	_erf.reset(Common::decryptBlowfishEBCStream(_erf.release(), _password, true));
 
 	_header.encryption = kEncryptionNone;
 }
@@ -713,12 +714,10 @@ Common::SeekableReadStream *ERFFile::getResource(uint32_t index, bool tryNoCopy)
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy && (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone))
-		return new Common::SeekableSubReadStream(_erf.get(), res.offset, res.offset + res.packedSize);
-
-	_erf->seek(res.offset);
+		return _erf->getSubStream(res.offset, res.offset + res.packedSize);
 
 	// Read
-	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
+	Common::MemoryReadStream *stream = _erf->readStreamAt(res.offset, res.packedSize);
 
 	// Decrypt
 	if (_header.encryption != kEncryptionNone)
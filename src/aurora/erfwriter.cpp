@@ -22,11 +22,14 @@
  *  Writing BioWare's ERFs (encapsulated resource file).
  */
 
+#include <cassert>
 #include <ctime>
 
 #include <memory>
+#include <chrono>
 
 #include "src/common/deflate.h"
+#include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
 #include "src/aurora/erfwriter.h"
@@ -36,8 +39,10 @@ namespace Aurora {
 
 static const uint32_t kVersion10 = MKTAG('V', '1', '.', '0');
 
-ERFWriter::ERFWriter(uint32_t id, uint32_t fileCount, Common::SeekableWriteStream &stream, Version version, Compression compression, LocString description) :
-		_stream(stream), _version(version), _compression(compression), _fileCount(fileCount) {
+ERFWriter::ERFWriter(uint32_t id, uint32_t fileCount, Common::SeekableWriteStream &stream, Version version, Compression compression, LocString description, size_t threadCount,
+                     const CompressionOptions &compressionOptions, CompressionStatistics *statistics) :
+		_stream(stream), _version(version), _compression(compression), _compressionOptions(compressionOptions),
+		_statistics(statistics), _fileCount(fileCount) {
 
 	switch (_version) {
 		case kERFVersion10:
@@ -55,10 +60,24 @@ ERFWriter::ERFWriter(uint32_t id, uint32_t fileCount, Common::SeekableWriteStrea
 		default:
 			throw Common::Exception("Unsupported ERF version");
 	}
+
+	_entries.reserve(_fileCount);
+
+	// Only compression is worth spreading over several threads
+	threadCount = Common::ThreadPool::getThreadCount(threadCount);
+	if ((_version == kERFVersion22) && (_compression != kCompressionNone) && (threadCount > 1))
+		_threadPool = std::make_unique<Common::ThreadPool>(threadCount);
+}
+
+ERFWriter::~ERFWriter() {
+	try {
+		flush();
+	} catch (...) {
+	}
 }
 
 void ERFWriter::add(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
-	if (_currentFileCount == _fileCount)
+	if ((_currentFileCount + _pending.size()) == _fileCount)
 		throw Common::Exception("More files added than expected");
 
 	// Files without a type are put into ERF archives as the generic RES type
@@ -160,24 +179,11 @@ void ERFWriter::initV20() {
 }
 
 void ERFWriter::addV10(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
-	// Write the key table entry
-	_stream.seek(_keyTableOffset + _currentFileCount * 24);
-
-	_stream.write(resRef.c_str(), MIN<size_t>(resRef.size(), 16));
-	_stream.writeZeros(16 - MIN<size_t>(resRef.size(), 16));
-	_stream.writeUint32LE(_currentFileCount);
-	_stream.writeUint16LE(resType);
-	_stream.writeUint16LE(0); // Unused
-
-	// Write the actual resource data
-	_stream.seek(_offsetToResourceData);
+	// Write the actual resource data. The stream is always positioned at its end.
 	const size_t size = _stream.writeStream(stream);
 
-	// Write the resource table entry
-	_stream.seek(_resourceTableOffset + _currentFileCount * 8);
-
-	_stream.writeUint32LE(_offsetToResourceData);
-	_stream.writeUint32LE(size);
+	// Remember the key and resource table entry
+	addEntry({ resRef, resType, _offsetToResourceData, static_cast<uint32_t>(size), 0 });
 
 	// Advance data offset and file count
 	_offsetToResourceData += size;
@@ -234,16 +240,11 @@ void ERFWriter::initV22(ERFWriter::Compression compression) {
 }
 
 void ERFWriter::addV20(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
-	// Write the resource data
-	_stream.seek(_offsetToResourceData);
+	// Write the resource data. The stream is always positioned at its end.
 	const size_t size = _stream.writeStream(stream);
 
-	// Write the resource table entry.
-	_stream.seek(_resourceTableOffset + _currentFileCount * 72);
-
-	Common::writeStringFixed(_stream, TypeMan.addFileType(resRef, resType), Common::kEncodingUTF16LE, 64);
-	_stream.writeUint32LE(_offsetToResourceData);
-	_stream.writeUint32LE(size);
+	// Remember the resource table entry.
+	addEntry({ resRef, resType, _offsetToResourceData, static_cast<uint32_t>(size), 0 });
 
 	// Advance offset and file count.
 	_offsetToResourceData += size;
@@ -251,44 +252,203 @@ void ERFWriter::addV20(const Common::UString &resRef, FileType resType, Common::
 }
 
 void ERFWriter::addV22(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
-	// Write the resource data
-	_stream.seek(_offsetToResourceData);
+	const size_t uncompressedSize = stream.size();
 
-	size_t uncompressedSize = stream.size();
-	size_t size = 0;
+	if (_compression == kCompressionNone) {
+		writeV22(resRef, resType, uncompressedSize, stream);
+		return;
+	}
 
-	switch (_compression) {
-		case kCompressionNone: {
-			size = _stream.writeStream(stream);
-			break;
-		}
-		case kCompressionBiowareZlib: {
-			std::unique_ptr<Common::SeekableReadStream> compressedStream(
-					Common::compressDeflate(stream, uncompressedSize, Common::kWindowBitsMaxRaw));
-			_stream.writeByte(static_cast<uint>(Common::kWindowBitsMax) << 4);
-			size = _stream.writeStream(*compressedStream);
-			size += 1;
-			break;
-		}
-		case kCompressionHeaderlessZlib: {
-			std::unique_ptr<Common::SeekableReadStream> compressedStream(
-					Common::compressDeflate(stream, uncompressedSize, Common::kWindowBitsMaxRaw));
-			size = _stream.writeStream(*compressedStream);
-			break;
+	if (!_threadPool) {
+		std::unique_ptr<Common::SeekableReadStream> compressedStream;
+		try {
+			compressedStream.reset(compressV22(stream, resType));
+		} catch (Common::Exception &e) {
+			e.add("Failed to compress \"%s\"", TypeMan.setFileType(resRef, resType).c_str());
+			throw;
 		}
+
+		writeV22(resRef, resType, uncompressedSize, *compressedStream);
+		return;
 	}
 
-	// Write the resource table entry.
-	_stream.seek(_resourceTableOffset + _currentFileCount * 76);
+	/* Read the file into memory and queue it for compression. To keep the
+	 * amount of memory in check, write out the oldest queued files while
+	 * there are more than two waiting for each thread. */
+
+	while (_pending.size() >= (2 * _threadPool->getThreadCount()))
+		writePending();
+
+	std::shared_ptr<Common::SeekableReadStream> data;
+	try {
+		stream.seek(0);
+		data.reset(stream.readStream(uncompressedSize));
+	} catch (Common::Exception &e) {
+		e.add("Failed to read \"%s\"", TypeMan.setFileType(resRef, resType).c_str());
+		throw;
+	}
+
+	_pending.emplace_back();
+
+	PendingFile &file = _pending.back();
+
+	file.resRef           = resRef;
+	file.resType          = resType;
+	file.uncompressedSize = uncompressedSize;
+
+	file.data = _threadPool->addTask<std::unique_ptr<Common::SeekableReadStream>>([this, data, resType]() {
+		return std::unique_ptr<Common::SeekableReadStream>(compressV22(*data, resType));
+	});
+
+	// Write out whatever's already done
+	while (!_pending.empty() &&
+	       (_pending.front().data.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+		writePending();
+}
+
+void ERFWriter::flush() {
+	while (!_pending.empty())
+		writePending();
+
+	writeTables();
+}
+
+void ERFWriter::setWrittenCallback(const WrittenCallback &callback) {
+	_writtenCallback = callback;
+}
 
-	Common::writeStringFixed(_stream, TypeMan.addFileType(resRef, resType), Common::kEncodingUTF16LE, 64);
-	_stream.writeUint32LE(_offsetToResourceData);
-	_stream.writeUint32LE(size);
-	_stream.writeUint32LE(uncompressedSize);
+void ERFWriter::addEntry(const Entry &entry) {
+	_entries.push_back(entry);
+
+	if (_writtenCallback)
+		_writtenCallback(_entries.size() - 1);
+}
+
+void ERFWriter::writePending() {
+	assert(!_pending.empty());
+
+	PendingFile file = std::move(_pending.front());
+	_pending.pop_front();
+
+	std::unique_ptr<Common::SeekableReadStream> data;
+	try {
+		data = file.data.get();
+	} catch (Common::Exception &e) {
+		e.add("Failed to compress \"%s\"", TypeMan.setFileType(file.resRef, file.resType).c_str());
+		throw;
+	} catch (std::exception &se) {
+		Common::Exception e(se);
+		e.add("Failed to compress \"%s\"", TypeMan.setFileType(file.resRef, file.resType).c_str());
+		throw e;
+	}
+
+	writeV22(file.resRef, file.resType, file.uncompressedSize, *data);
+}
+
+Common::SeekableReadStream *ERFWriter::compressV22(Common::SeekableReadStream &stream, FileType resType) const {
+	const CompressionStatistics::Clock::time_point start = CompressionStatistics::Clock::now();
+
+	const size_t inputSize = stream.size();
+
+	std::unique_ptr<byte[]> inputData = std::make_unique<byte[]>(inputSize);
+	if (stream.read(inputData.get(), inputSize) != inputSize)
+		throw Common::Exception(Common::kReadError);
+
+	int level = (_compressionOptions.level < 0) ? Common::kDeflateLevelBest : _compressionOptions.level;
+
+	// Data that won't get any smaller is only stored in uncompressed DEFLATE blocks
+	const bool incompressible = _compressionOptions.fastIncompressible && isIncompressible(inputData.get(), inputSize);
+	if (incompressible)
+		level = Common::kDeflateLevelNone;
+
+	size_t outputSize = 0;
+	byte *outputData = Common::compressDeflate(inputData.get(), inputSize, outputSize, Common::kWindowBitsMaxRaw,
+	                                           level, _compressionOptions.deflateStrategy);
+
+	if (_statistics)
+		_statistics->add(resType, inputSize, outputSize, incompressible, CompressionStatistics::Clock::now() - start);
+
+	return new Common::MemoryReadStream(outputData, outputSize, true);
+}
+
+void ERFWriter::writeV22(const Common::UString &resRef, FileType resType, size_t uncompressedSize,
+                         Common::SeekableReadStream &data) {
+
+	// Write the resource data. The stream is always positioned at its end.
+	size_t size = 0;
+
+	// BioWare's zlib variant prefixes the raw deflate data with a window size byte
+	if (_compression == kCompressionBiowareZlib) {
+		_stream.writeByte(static_cast<uint>(Common::kWindowBitsMax) << 4);
+		size += 1;
+	}
+
+	size += _stream.writeStream(data);
+
+	// Remember the resource table entry.
+	addEntry({ resRef, resType, _offsetToResourceData,
+	           static_cast<uint32_t>(size), static_cast<uint32_t>(uncompressedSize) });
 
 	// Advance offset and file count.
 	_offsetToResourceData += size;
 	_currentFileCount += 1;
 }
 
+void ERFWriter::writeTables() {
+	if (_writtenEntries == _entries.size())
+		return;
+
+	/* Collect all new table entries in memory, so that each table only
+	 * needs one seek and one write. */
+
+	Common::MemoryWriteStreamDynamic keyTable(true), resourceTable(true);
+
+	for (size_t i = _writtenEntries; i < _entries.size(); i++) {
+		const Entry &entry = _entries[i];
+
+		switch (_version) {
+			case kERFVersion10:
+				keyTable.write(entry.resRef.c_str(), MIN<size_t>(entry.resRef.size(), 16));
+				keyTable.writeZeros(16 - MIN<size_t>(entry.resRef.size(), 16));
+				keyTable.writeUint32LE(i);
+				keyTable.writeUint16LE(entry.resType);
+				keyTable.writeUint16LE(0); // Unused
+
+				resourceTable.writeUint32LE(entry.offset);
+				resourceTable.writeUint32LE(entry.size);
+				break;
+
+			case kERFVersion20:
+				Common::writeStringFixed(resourceTable, TypeMan.addFileType(entry.resRef, entry.resType),
+				                         Common::kEncodingUTF16LE, 64);
+				resourceTable.writeUint32LE(entry.offset);
+				resourceTable.writeUint32LE(entry.size);
+				break;
+
+			case kERFVersion22:
+				Common::writeStringFixed(resourceTable, TypeMan.addFileType(entry.resRef, entry.resType),
+				                         Common::kEncodingUTF16LE, 64);
+				resourceTable.writeUint32LE(entry.offset);
+				resourceTable.writeUint32LE(entry.size);
+				resourceTable.writeUint32LE(entry.uncompressedSize);
+				break;
+		}
+	}
+
+	if (keyTable.size() > 0) {
+		_stream.seek(_keyTableOffset + _writtenEntries * 24);
+		_stream.write(keyTable.getData(), keyTable.size());
+	}
+
+	const size_t resourceEntrySize = (_version == kERFVersion10) ? 8 : ((_version == kERFVersion20) ? 72 : 76);
+
+	_stream.seek(_resourceTableOffset + _writtenEntries * resourceEntrySize);
+	_stream.write(resourceTable.getData(), resourceTable.size());
+
+	// Go back to the end of the data, for the next file
+	_stream.seek(_offsetToResourceData);
+
+	_writtenEntries = _entries.size();
+}
+
 } // End of namespace Aurora
@@ -25,10 +25,18 @@
 #ifndef AURORA_ERFWRITER_H
 #define AURORA_ERFWRITER_H
 
+#include <deque>
+#include <vector>
+#include <memory>
+#include <future>
+#include <functional>
+
 #include "src/common/writestream.h"
 #include "src/common/readstream.h"
+#include "src/common/threadpool.h"
 
 #include "src/aurora/locstring.h"
+#include "src/aurora/compression.h"
 
 namespace Aurora {
 
@@ -46,6 +54,9 @@ public:
 		kCompressionHeaderlessZlib
 	};
 
+	/** Called after a file has been written, with the index of the file in the order it was added. */
+	typedef std::function<void(size_t)> WrittenCallback;
+
 	/** Create an ERF writer by writing the header to the stream and reserve fileCount
 	 *  places in the key and resource table.
 	 *
@@ -55,15 +66,40 @@ public:
 	 *  @param version The ERF version to write
 	 *  @param compression The compression which has to be applied to every file.
 	 *  @param description The LocString, that should be used for the description.
+	 *  @param threadCount The number of threads to compress files with. 0 means one
+	 *                     per CPU core, 1 compresses each file within add().
+	 *  @param compressionOptions How to compress the files.
+	 *  @param statistics  If not nullptr, collect statistics about the compressed files here.
 	 */
 	ERFWriter(uint32_t id, uint32_t fileCount, Common::SeekableWriteStream &stream,
 	          Version version = kERFVersion10, Compression compression = kCompressionNone,
-	          LocString description = LocString());
-	~ERFWriter() = default;
+	          LocString description = LocString(), size_t threadCount = 1,
+	          const CompressionOptions &compressionOptions = CompressionOptions(),
+	          CompressionStatistics *statistics = nullptr);
+	/** Write all pending files and the tables. Errors are ignored; call flush() to see them. */
+	~ERFWriter();
 
-	/** Add a new stream to this archive to be packed. */
+	/** Add a new stream to this archive to be packed.
+	 *
+	 *  When compressing with several threads, the file is only queued for
+	 *  compression here, and written once compressed, in the order the files
+	 *  were added. The stream can be safely discarded after add() returns.
+	 *
+	 *  The file data is written sequentially. The key and resource tables
+	 *  are only written by flush().
+	 */
 	void add(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream);
 
+	/** Wait for all queued files to be compressed, and write them. Then write the tables. */
+	void flush();
+
+	/** Set a function to call whenever a file has been written.
+	 *
+	 *  When compressing with several threads, a file is only written once its
+	 *  compression has finished, long after add() returned.
+	 */
+	void setWrittenCallback(const WrittenCallback &callback);
+
 private:
 	void initV10(uint32_t id, LocString description);
 	void initV20();
@@ -73,16 +109,60 @@ private:
 	void addV20(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream);
 	void addV22(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream);
 
+	/** A file queued for compression. */
+	struct PendingFile {
+		Common::UString resRef;
+		FileType resType;
+		size_t uncompressedSize;
+
+		std::future<std::unique_ptr<Common::SeekableReadStream>> data;
+	};
+
+	Common::SeekableReadStream *compressV22(Common::SeekableReadStream &stream, FileType resType) const;
+	void writeV22(const Common::UString &resRef, FileType resType, size_t uncompressedSize,
+	              Common::SeekableReadStream &data);
+
+	/** Write the oldest queued file, waiting for it to be compressed if necessary. */
+	void writePending();
+
+	/** Write the table entries of all files written since the last call. */
+	void writeTables();
+
+	/** A key and resource table entry of a written file. */
+	struct Entry {
+		Common::UString resRef;
+		FileType resType;
+
+		uint32_t offset;
+		uint32_t size;
+		uint32_t uncompressedSize;
+	};
+
+	/** Remember the table entry of a file that was just written. */
+	void addEntry(const Entry &entry);
+
 	Common::SeekableWriteStream &_stream;
 
 	const Version _version;
 	const Compression _compression;
+	const CompressionOptions _compressionOptions;
+
+	CompressionStatistics *_statistics;
 
 	uint32_t _currentFileCount { 0 };
 	uint32_t _fileCount { 0 };
 	uint32_t _offsetToResourceData { 0 };
 	uint32_t _keyTableOffset { 0 };
 	uint32_t _resourceTableOffset { 0 };
+
+	std::unique_ptr<Common::ThreadPool> _threadPool;
+	std::deque<PendingFile> _pending;
+
+	std::vector<Entry> _entries;
+	/** The number of entries already written into the tables. */
+	size_t _writtenEntries { 0 };
+
+	WrittenCallback _writtenCallback;
 };
 
 } // End of namespace Aurora
@@ -98,7 +98,21 @@ size_t GDAFile::findRow(uint32_t id) const {
 	if (idColumn == kInvalidColumn)
 		return kInvalidRow;
 
-	// Go through all rows of all GFF4s, and look for the ID
+	if (!_rowIDMap)
+		createRowIDMap(idColumn);
+
+	RowIDMap::const_iterator row = _rowIDMap->find(id);
+	if (row == _rowIDMap->end())
+		return kInvalidRow;
+
+	return row->second;
+}
+
+void GDAFile::createRowIDMap(size_t idColumn) const {
+	_rowIDMap = std::make_unique<RowIDMap>();
+	_rowIDMap->reserve(_rowCount);
+
+	// Go through all rows of all GFF4s, and remember where we found each ID
 
 	size_t gff4 = 0;
 	for (size_t i = 0, j = 0; i < _rowCount; i++, j++) {
@@ -109,11 +123,9 @@ size_t GDAFile::findRow(uint32_t id) const {
 			j = 0;
 		}
 
-		if ((*_rows[gff4])[j] && ((*_rows[gff4])[j]->getUint(idColumn) == id))
-			return i;
+		if ((*_rows[gff4])[j])
+			_rowIDMap->insert(std::make_pair((*_rows[gff4])[j]->getUint(idColumn), i));
 	}
-
-	return kInvalidRow;
 }
 
 size_t GDAFile::findColumn(const Common::UString &name) const {
@@ -305,6 +317,9 @@ void GDAFile::load(Common::SeekableReadStream *gda) {
 }
 
 void GDAFile::add(Common::SeekableReadStream *gda) {
+	// The new rows need to be indexed as well
+	_rowIDMap.reset();
+
 	try {
 		_gff4s.emplace_back(std::make_unique<GFF4File>(gda, kG2DAID));
 
@@ -30,6 +30,7 @@
 #include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "src/common/ustring.h"
 
@@ -113,7 +114,11 @@ public:
 	/** Get a row as a GFF4 struct. */
 	const GFF4Struct *getRow(size_t row) const;
 
-	/** Find a row by its ID value. */
+	/** Find a row by its ID value.
+	 *
+	 *  If several rows share the same ID, the first one is returned. The first
+	 *  call indexes the IDs of all rows, making further lookups O(1).
+	 */
 	size_t findRow(uint32_t id) const;
 
 	/** Find a column by its name. */
@@ -142,6 +147,8 @@ private:
 	typedef std::map<uint32_t, size_t> ColumnHashMap;
 	typedef std::map<Common::UString, size_t> ColumnNameMap;
 
+	typedef boost::unordered_map<uint64_t, size_t> RowIDMap;
+
 
 	GFF4s _gff4s;
 
@@ -157,9 +164,14 @@ private:
 	mutable ColumnHashMap _columnHashMap;
 	mutable ColumnNameMap _columnNameMap;
 
+	/** Map of row IDs to row indices, created on first use by findRow(). */
+	mutable std::unique_ptr<RowIDMap> _rowIDMap;
+
 
 	void load(Common::SeekableReadStream *gda);
 
+	void createRowIDMap(size_t idColumn) const;
+
 	Type identifyType(const Columns &columns, const Row &rows, size_t column) const;
 
 	const GFF4Struct *getRowColumn(size_t row, uint32_t hash, size_t &column) const;
@@ -28,6 +28,8 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
@@ -41,6 +43,8 @@
 static const uint32_t kVersion32 = MKTAG('V', '3', '.', '2');
 static const uint32_t kVersion33 = MKTAG('V', '3', '.', '3'); // Found in The Witcher, different language table
 
+static const uint32_t kStructSize = 12;
+
 namespace Aurora {
 
 GFF3File::Header::Header() {
@@ -62,8 +66,8 @@ void GFF3File::Header::read(Common::SeekableReadStream &gff3) {
 }
 
 
-GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32_t id, bool repairNWNPremium) :
-	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32_t id, bool repairNWNPremium, bool lazy) :
+	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0), _lazy(lazy) {
 
 	assert(_stream);
 
@@ -170,7 +174,12 @@ void GFF3File::loadHeader(uint32_t id) {
 }
 
 void GFF3File::loadStructs() {
-	static const uint32_t kStructSize = 12;
+	_labelIDs.resize(_header.labelCount, 0xFFFFFFFF);
+
+	if (_lazy) {
+		_structs.resize(_header.structCount);
+		return;
+	}
 
 	_structs.reserve(_header.structCount);
 	for (uint32_t i = 0; i < _header.structCount; i++)
@@ -178,6 +187,10 @@ void GFF3File::loadStructs() {
 }
 
 void GFF3File::loadLists() {
+	// When lazy loading, each list is read in getLazyList() once it's reached
+	if (_lazy)
+		return;
+
 	/* Read in the lists section of the GFF3.
 	 *
 	 * GFF3s store lists in a linear fashion, with the indices prefixes by
@@ -243,10 +256,24 @@ const GFF3Struct &GFF3File::getStruct(uint32_t i) const {
 	if (i >= _structs.size())
 		throw Common::Exception("GFF3: Struct index out of range (%u >= %u)", i, (uint) _structs.size());
 
+	if (!_structs[i]) {
+		assert(_lazy);
+
+		try {
+			_structs[i].reset(new GFF3Struct(*this, _header.structOffset + i * kStructSize));
+		} catch (Common::Exception &e) {
+			e.add("Failed reading GFF3 struct %u", i);
+			throw;
+		}
+	}
+
 	return *_structs[i].get();
 }
 
 const GFF3List &GFF3File::getList(uint32_t i) const {
+	if (_lazy)
+		return getLazyList(i);
+
 	if (i >= _listOffsetToIndex.size())
 		throw Common::Exception("GFF3: List offset index out of range (%u >= %u)",
 		                        i, (uint) _listOffsetToIndex.size());
@@ -261,6 +288,75 @@ const GFF3List &GFF3File::getList(uint32_t i) const {
 	return _lists[listIndex];
 }
 
+const GFF3List &GFF3File::getLazyList(uint32_t i) const {
+	std::map<uint32_t, GFF3List>::const_iterator list = _lazyLists.find(i);
+	if (list != _lazyLists.end())
+		return list->second;
+
+	/* Read only this one list out of the list indices section. Since we
+	 * don't scan the whole section, we can't check whether the offset
+	 * points to the start of a list, only that the list fits. */
+
+	const uint32_t rawCount = _header.listIndicesCount / 4;
+	if (i >= rawCount)
+		throw Common::Exception("GFF3: List offset index out of range (%u >= %u)", i, rawCount);
+
+	_stream->seek(_header.listIndicesOffset + i * 4);
+
+	const uint32_t n = _stream->readUint32LE();
+	if ((n > rawCount) || ((i + 1 + n) > rawCount))
+		throw Common::Exception("GFF3: List indices broken");
+
+	std::vector<uint32_t> structIndices(n);
+	for (std::vector<uint32_t>::iterator it = structIndices.begin(); it != structIndices.end(); ++it)
+		*it = _stream->readUint32LE();
+
+	GFF3List structs(n);
+	for (uint32_t j = 0; j < n; j++) {
+		if (structIndices[j] >= _structs.size())
+			throw Common::Exception("GFF3: List struct index out of range (%u >= %u)",
+			                        structIndices[j], (uint) _structs.size());
+
+		structs[j] = &getStruct(structIndices[j]);
+	}
+
+	return _lazyLists.emplace(i, std::move(structs)).first->second;
+}
+
+uint32_t GFF3File::internLabel(uint32_t index) const {
+	/* Labels are interned: every distinct label string gets a small integer
+	 * ID, so that the structs can look up their fields by comparing IDs. */
+
+	if ((index < _labelIDs.size()) && (_labelIDs[index] != 0xFFFFFFFF))
+		return _labelIDs[index];
+
+	_stream->seek(_header.labelOffset + index * 16);
+	Common::UString label = Common::readStringFixed(*_stream, Common::kEncodingASCII, 16);
+
+	std::pair<LabelMap::iterator, bool> interned = _labelMap.emplace(label, (uint32_t) _labels.size());
+	if (interned.second)
+		_labels.push_back(label);
+
+	if (index < _labelIDs.size())
+		_labelIDs[index] = interned.first->second;
+
+	return interned.first->second;
+}
+
+const Common::UString &GFF3File::getLabel(uint32_t id) const {
+	assert(id < _labels.size());
+
+	return _labels[id];
+}
+
+uint32_t GFF3File::findLabel(const Common::UString &label) const {
+	LabelMap::const_iterator id = _labelMap.find(label);
+	if (id == _labelMap.end())
+		return 0xFFFFFFFF;
+
+	return id->second;
+}
+
 Common::SeekableReadStream &GFF3File::getStream(uint32_t offset) const {
 	_stream->seek(offset);
 
@@ -272,10 +368,10 @@ Common::SeekableReadStream &GFF3File::getFieldData() const {
 }
 
 
-GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFF3Struct::Field::Field() : label(0xFFFFFFFF), type(kFieldTypeNone), data(0), extended(false) {
 }
 
-GFF3Struct::Field::Field(FieldType t, uint32_t d) : type(t), data(d) {
+GFF3Struct::Field::Field(uint32_t l, FieldType t, uint32_t d) : label(l), type(t), data(d) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -312,6 +408,8 @@ void GFF3Struct::load(uint32_t offset) {
 		readField (data, _fieldIndex);
 	else if (_fieldCount > 1)
 		readFields(data, _fieldIndex, _fieldCount);
+
+	sortFields();
 }
 
 void GFF3Struct::readField(Common::SeekableReadStream &data, uint32_t index) {
@@ -328,13 +426,13 @@ void GFF3Struct::readField(Common::SeekableReadStream &data, uint32_t index) {
 	const uint32_t fieldLabel = data.readUint32LE();
 	const uint32_t fieldData  = data.readUint32LE();
 
-	// Read the name
-	Common::UString fieldName = readLabel(data, fieldLabel);
+	// Intern the name
+	const uint32_t label = _parent->internLabel(fieldLabel);
 
-	// And add the field to the map and name list
-	_fields[fieldName] = Field((FieldType) fieldType, fieldData);
+	// And add the field to the field and name lists
+	_fields.push_back(Field(label, (FieldType) fieldType, fieldData));
 
-	_fieldNames.push_back(fieldName);
+	_fieldNames.push_back(_parent->getLabel(label));
 }
 
 void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32_t index, uint32_t count) {
@@ -350,6 +448,9 @@ void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32_t index, ui
 	std::vector<uint32_t> indices;
 	readIndices(data, indices, count);
 
+	_fields.reserve(count);
+	_fieldNames.reserve(count);
+
 	// Read the fields
 	for (std::vector<uint32_t>::const_iterator i = indices.begin(); i != indices.end(); ++i)
 		readField(data, *i);
@@ -362,10 +463,23 @@ void GFF3Struct::readIndices(Common::SeekableReadStream &data,
 		indices.push_back(data.readUint32LE());
 }
 
-Common::UString GFF3Struct::readLabel(Common::SeekableReadStream &data, uint32_t index) const {
-	data.seek(_parent->_header.labelOffset + index * 16);
+void GFF3Struct::sortFields() {
+	/* Sort the fields by their label IDs, for quick lookup. When several
+	 * fields share the same label, the last one in the struct wins. */
+
+	std::stable_sort(_fields.begin(), _fields.end(), [](const Field &a, const Field &b) {
+		return a.label < b.label;
+	});
+
+	FieldArray::iterator last = _fields.begin();
+	for (FieldArray::iterator f = _fields.begin(); f != _fields.end(); ++f) {
+		if (((f + 1) != _fields.end()) && ((f + 1)->label == f->label))
+			continue;
+
+		*last++ = *f;
+	}
 
-	return Common::readStringFixed(data, Common::kEncodingASCII, 16);
+	_fields.erase(last, _fields.end());
 }
 
 Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
@@ -402,11 +516,20 @@ GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) con
 // --- Field value reader helpers ---
 
 const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
+	if (_fields.empty())
+		return 0;
+
+	const uint32_t label = _parent->findLabel(name);
+	if (label == 0xFFFFFFFF)
+		return 0;
+
+	FieldArray::const_iterator field = std::lower_bound(_fields.begin(), _fields.end(), label,
+			[](const Field &f, uint32_t l) { return f.label < l; });
+
+	if ((field == _fields.end()) || (field->label != label))
 		return 0;
 
-	return &field->second;
+	return &*field;
 }
 
 char GFF3Struct::getChar(const Common::UString &field, char def) const {
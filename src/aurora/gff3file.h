@@ -30,6 +30,7 @@
 #include <memory>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
@@ -78,13 +79,21 @@ class GFF3Struct;
  *  LocStrings is different. Since xoreos has more flexible handling of
  *  language IDs anyway, this doesn't concern us.
  *
+ *  When the constructor parameter lazy is set to true, GFF3File will not
+ *  read all structs and lists when opening the file. Instead, each struct
+ *  and each list is read when it is first reached, through the top-level
+ *  struct or a struct or list field. Opening a large GFF3 file to read a
+ *  few fields is then fast and uses little memory, but broken structs and
+ *  lists only lead to exceptions when they are reached.
+ *
  *  See also: GFF4File in gff4file.h for the later V4.0/V4.1 versions of
  *  the GFF format.
  */
 class GFF3File : boost::noncopyable, public AuroraFile {
 public:
 	/** Take over this stream and read a GFF3 file out of it. */
-	GFF3File(Common::SeekableReadStream *gff3, uint32_t id = 0xFFFFFFFF, bool repairNWNPremium = false);
+	GFF3File(Common::SeekableReadStream *gff3, uint32_t id = 0xFFFFFFFF,
+	         bool repairNWNPremium = false, bool lazy = false);
 	virtual ~GFF3File();
 
 	/** Return the GFF3's specific type. */
@@ -118,6 +127,9 @@ private:
 	typedef std::vector<std::unique_ptr<GFF3Struct>> StructArray;
 	typedef std::vector<GFF3List> ListArray;
 
+	/** Map of a label string to its interned label ID. */
+	typedef boost::unordered_map<Common::UString, uint32_t, Common::hashUStringCaseSensitive> LabelMap;
+
 
 	std::unique_ptr<Common::SeekableReadStream> _stream;
 
@@ -128,12 +140,26 @@ private:
 	/** The correctional value for offsets to repair Neverwinter Nights premium modules. */
 	uint32_t _offsetCorrection;
 
-	StructArray _structs; ///< Our structs.
-	ListArray   _lists;   ///< Our lists.
+	/** Only read structs and lists once they're reached? */
+	bool _lazy;
+
+	/** Our structs. When lazy loading, a struct is only created once it's reached. */
+	mutable StructArray _structs;
+	ListArray _lists; ///< Our lists, when not lazy loading.
 
 	/** To convert list offsets found in GFF3 to real indices. */
 	std::vector<uint32_t> _listOffsetToIndex;
 
+	/** The lists read so far when lazy loading, indexed by their list offset. */
+	mutable std::map<uint32_t, GFF3List> _lazyLists;
+
+	/** All distinct labels, indexed by their interned label ID. */
+	mutable std::vector<Common::UString> _labels;
+	/** The interned label ID of each entry in the label table, once read. */
+	mutable std::vector<uint32_t> _labelIDs;
+	/** Map of a label string to its interned label ID. */
+	mutable LabelMap _labelMap;
+
 
 	// .--- Loading helpers
 	void load(uint32_t id);
@@ -152,6 +178,16 @@ private:
 	const GFF3Struct &getStruct(uint32_t i) const;
 	/** Return a list within the GFF3. */
 	const GFF3List   &getList  (uint32_t i) const;
+
+	/** Read a list within the GFF3 when lazy loading. */
+	const GFF3List &getLazyList(uint32_t i) const;
+
+	/** Intern the label at this index in the label table, returning its ID. */
+	uint32_t internLabel(uint32_t index) const;
+	/** Return the string of an interned label. */
+	const Common::UString &getLabel(uint32_t id) const;
+	/** Return the interned ID of this label, or 0xFFFFFFFF if no field has it. */
+	uint32_t findLabel(const Common::UString &label) const;
 	// '---
 
 	friend class GFF3Struct;
@@ -241,15 +277,17 @@ public:
 private:
 	/** A field in the GFF3 struct. */
 	struct Field {
+		uint32_t  label;    ///< Interned label ID of the field.
 		FieldType type;     ///< Type of the field.
 		uint32_t  data;     ///< Data of the field.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32_t d);
+		Field(uint32_t l, FieldType t, uint32_t d);
 	};
 
-	typedef std::map<Common::UString, Field> FieldMap;
+	/** The fields of a struct, sorted by their interned label ID. */
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF3File *_parent; ///< The parent GFF3.
@@ -258,7 +296,7 @@ private:
 	uint32_t _fieldIndex; ///< Field / Field indices index.
 	uint32_t _fieldCount; ///< Field count.
 
-	FieldMap _fields; ///< The fields, indexed by their label.
+	FieldArray _fields; ///< The fields, sorted by their label ID.
 
 	/** The names of all fields in this struct. */
 	std::vector<Common::UString> _fieldNames;
@@ -274,7 +312,7 @@ private:
 	void readIndices(Common::SeekableReadStream &data,
 	                 std::vector<uint32_t> &indices, uint32_t count) const;
 
-	Common::UString readLabel(Common::SeekableReadStream &data, uint32_t index) const;
+	void sortFields();
 	// '---
 
 	// .--- Field and field data accessors
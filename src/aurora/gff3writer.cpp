@@ -30,6 +30,7 @@
 
 #include "src/common/writestream.h"
 #include "src/common/memreadstream.h"
+#include "src/common/hash.h"
 
 #include "src/aurora/gff3writer.h"
 
@@ -52,8 +53,112 @@ GFF3Writer::VoidData &GFF3Writer::VoidData::operator=(const VoidData &rhs) {
 	return *this;
 }
 
+uint64_t GFF3Writer::VoidData::hashContents() const {
+	uint64_t hash = 0xCBF29CE484222325LL;
+	if (!data)
+		return hash;
+
+	byte buffer[4096];
+
+	data->seek(0);
+
+	size_t n;
+	while ((n = data->read(buffer, sizeof(buffer))) > 0)
+		for (size_t i = 0; i < n; i++)
+			hash = Common::hashFNV64(hash, buffer[i]);
+
+	data->seek(0);
+
+	return hash;
+}
+
+bool GFF3Writer::VoidData::equalContents(const VoidData &rhs) const {
+	if (data.get() == rhs.data.get())
+		return true;
+
+	if (!data || !rhs.data || (data->size() != rhs.data->size()))
+		return false;
+
+	byte buffer1[4096], buffer2[4096];
+
+	data->seek(0);
+	rhs.data->seek(0);
+
+	bool equal = true;
+
+	size_t n;
+	while (equal && ((n = data->read(buffer1, sizeof(buffer1))) > 0))
+		equal = (rhs.data->read(buffer2, n) == n) && (std::memcmp(buffer1, buffer2, n) == 0);
+
+	data->seek(0);
+	rhs.data->seek(0);
+
+	return equal;
+}
+
+
+size_t GFF3Writer::ValueDataHash::operator()(const Vector4 &v) const {
+	size_t seed = 0;
+
+	boost::hash_combine(seed, v.x);
+	boost::hash_combine(seed, v.y);
+	boost::hash_combine(seed, v.z);
+	boost::hash_combine(seed, v.w);
+
+	return seed;
+}
+
+size_t GFF3Writer::ValueDataHash::operator()(const Common::UString &v) const {
+	return Common::hashUStringCaseSensitive()(v);
+}
+
+size_t GFF3Writer::ValueDataHash::operator()(const LocString &v) const {
+	size_t seed = 0;
+
+	boost::hash_combine(seed, v.getID());
+	boost::hash_combine(seed, v.getNumStrings());
+
+	std::vector<LocString::SubLocString> strings;
+	v.getStrings(strings);
+
+	for (const auto &string : strings) {
+		boost::hash_combine(seed, string.language);
+		boost::hash_combine(seed, Common::hashUStringCaseSensitive()(string.str));
+	}
+
+	return seed;
+}
+
+size_t GFF3Writer::ValueDataHash::operator()(const VoidData &v) const {
+	// Void data is compared by identity
+	return boost::hash<const Common::SeekableReadStream *>()(v.data.get());
+}
+
+size_t GFF3Writer::ValuePtrHash::operator()(const Value *value) const {
+	size_t seed = 0;
+
+	boost::hash_combine(seed, static_cast<int>(value->type));
+	boost::hash_combine(seed, value->data.which());
+
+	if (byContents && value->isRaw)
+		boost::hash_combine(seed, boost::get<VoidData>(value->data).hashContents());
+	else
+		boost::hash_combine(seed, boost::apply_visitor(ValueDataHash(), value->data));
+
+	return seed;
+}
+
+bool GFF3Writer::ValuePtrEqual::operator()(const Value *value1, const Value *value2) const {
+	if (byContents && value1->isRaw && value2->isRaw && (value1->type == value2->type))
+		return boost::get<VoidData>(value1->data).equalContents(boost::get<VoidData>(value2->data));
+
+	return *value1 == *value2;
+}
+
+
+GFF3Writer::GFF3Writer(uint32_t id, uint32_t version, bool deduplicateData) :
+	_id(id), _version(version), _deduplicateData(deduplicateData) {
 
-GFF3Writer::GFF3Writer(uint32_t id, uint32_t version) : _id(id), _version(version) {
 	_structs.push_back(boost::make_shared<GFF3WriterStruct>(this));
 }
 
@@ -62,11 +167,26 @@ GFF3WriterStructPtr GFF3Writer::getTopLevel() {
 }
 
 void GFF3Writer::write(Common::WriteStream &stream) {
-	// Extract all individual values of the fields.
-	std::list<Value> individualValues;
-	for (const auto &field : _fields) {
-		if (std::find(individualValues.begin(), individualValues.end(), field->value) == individualValues.end())
-			individualValues.push_back(field->value);
+	/* Extract all individual complex values of the fields, in the order they first
+	 * appear in, and find the offset into the field data for each field. */
+	std::vector<const Value *> individualValues;
+	std::vector<uint32_t> fieldDataOffsets(_fields.size(), 0);
+
+	ValueOffsetMap valueOffsets(_fields.size(), ValuePtrHash(_deduplicateData), ValuePtrEqual(_deduplicateData));
+
+	uint32_t fieldDataCount = 0;
+	for (size_t i = 0; i < _fields.size(); ++i) {
+		const Value &value = _fields[i]->value;
+		if (isSimple(value.type))
+			continue;
+
+		std::pair<ValueOffsetMap::iterator, bool> offset = valueOffsets.insert(std::make_pair(&value, fieldDataCount));
+		if (offset.second) {
+			individualValues.push_back(&value);
+			fieldDataCount += getFieldDataSize(value);
+		}
+
+		fieldDataOffsets[i] = offset.first->second;
 	}
 
 	stream.writeUint32BE(_id);
@@ -82,12 +202,6 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 	uint32_t labelCount = static_cast<uint32_t>(_labels.size());
 
 	uint32_t fieldDataOffset = labelOffset + labelCount * 16;
-	uint32_t fieldDataCount = 0;
-
-	// Count the total size of field data
-	for (const auto &value : individualValues) {
-		fieldDataCount += getFieldDataSize(value);
-	}
 
 	uint32_t fieldIndicesOffset = fieldDataOffset + fieldDataCount;
 	uint32_t fieldIndicesCount = 0;
@@ -147,31 +261,16 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 	}
 
 	// Write fields
-	size_t fieldDataIndex = 0;
 	size_t listDataIndex = 0;
 
-	// Maps for checking for already existing values
-	std::map<Value, size_t> valueIndices;
-
 	for (size_t i = 0; i < _fields.size(); ++i) {
 		FieldPtr field = _fields[i];
 		stream.writeUint32LE(field->value.type);
 		stream.writeUint32LE(field->labelIndex);
 
-		/* Determine if this field has simple values (less equal 32 bit) which are written in the field
-		 * or complex values, bigger than 32bit like strings written in the field data section. */
-		const bool simple =
-			field->value.type == GFF3Struct::kFieldTypeByte ||
-			field->value.type == GFF3Struct::kFieldTypeChar ||
-			field->value.type == GFF3Struct::kFieldTypeUint16 ||
-			field->value.type == GFF3Struct::kFieldTypeUint32 ||
-			field->value.type == GFF3Struct::kFieldTypeStruct ||
-			field->value.type == GFF3Struct::kFieldTypeSint16 ||
-			field->value.type == GFF3Struct::kFieldTypeSint32 ||
-			field->value.type == GFF3Struct::kFieldTypeFloat ||
-			field->value.type == GFF3Struct::kFieldTypeList;
-
-		if (simple) {
+		/* Simple values (less equal 32 bit) are written in the field, while complex values,
+		 * bigger than 32bit like strings, are written in the field data section. */
+		if (isSimple(field->value.type)) {
 			// If the values are simple (less equal 4 bytes) write them to the field
 			switch (field->value.type) {
 				case GFF3Struct::kFieldTypeByte:
@@ -197,17 +296,7 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 			}
 		} else {
 			// If the values are complex (greater then 4 bytes) write the index to the field data
-
-			size_t index = 0;
-			if (valueIndices.find(field->value) == valueIndices.end()) {
-				index = fieldDataIndex;
-				fieldDataIndex += getFieldDataSize(field->value);
-				valueIndices[field->value] = index;
-			} else {
-				index = valueIndices[field->value];
-			}
-
-			stream.writeUint32LE(index);
+			stream.writeUint32LE(fieldDataOffsets[i]);
 		}
 	}
 
@@ -219,7 +308,9 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 	}
 
 	// Write field data
-	for (const auto &value : individualValues) {
+	for (const Value *individualValue : individualValues) {
+		const Value &value = *individualValue;
+
 		switch (value.type) {
 			case GFF3Struct::kFieldTypeUint64:
 				stream.writeUint64LE(boost::get<uint64_t>(value.data));
@@ -314,16 +405,28 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 }
 
 uint32_t GFF3Writer::addLabel(const Common::UString &label) {
-	std::vector<Common::UString>::iterator iter = std::find(_labels.begin(), _labels.end(), label);
-	if (iter != _labels.end()) {
-		return static_cast<uint32_t>(std::distance(_labels.begin(), iter));
-	} else {
+	std::pair<LabelMap::iterator, bool> index =
+		_labelIndices.insert(std::make_pair(label, static_cast<uint32_t>(_labels.size())));
+
+	if (index.second)
 		_labels.push_back(label);
-		return static_cast<uint32_t>(_labels.size() - 1);
-	}
+
+	return index.first->second;
+}
+
+bool GFF3Writer::isSimple(GFF3Struct::FieldType type) {
+	return type == GFF3Struct::kFieldTypeByte   ||
+	       type == GFF3Struct::kFieldTypeChar   ||
+	       type == GFF3Struct::kFieldTypeUint16 ||
+	       type == GFF3Struct::kFieldTypeUint32 ||
+	       type == GFF3Struct::kFieldTypeStruct ||
+	       type == GFF3Struct::kFieldTypeSint16 ||
+	       type == GFF3Struct::kFieldTypeSint32 ||
+	       type == GFF3Struct::kFieldTypeFloat  ||
+	       type == GFF3Struct::kFieldTypeList;
 }
 
-uint32_t GFF3Writer::getFieldDataSize(Value value) {
+uint32_t GFF3Writer::getFieldDataSize(const Value &value) {
 	switch (value.type) {
 		case GFF3Struct::kFieldTypeUint64:
 		case GFF3Struct::kFieldTypeSint64:
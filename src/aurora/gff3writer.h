@@ -31,6 +31,8 @@
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/variant.hpp>
+#include <boost/unordered/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "src/common/readstream.h"
 #include "src/common/memwritestream.h"
@@ -49,7 +51,14 @@ typedef boost::shared_ptr<GFF3WriterList> GFF3WriterListPtr;
 class GFF3Writer : boost::noncopyable {
 public:
 	// TODO: Add a constructor consuming a GFF3File object.
-	GFF3Writer(uint32_t id, uint32_t version);
+	/** Create a writer for a GFF3 with this ID and version.
+	 *
+	 *  If deduplicateData is true, void fields and raw ResRef and ExoString
+	 *  fields with identical contents share one copy in the written field
+	 *  data. This is off by default, because readers might expect each of
+	 *  these fields to have their own, unique data offset.
+	 */
+	GFF3Writer(uint32_t id, uint32_t version, bool deduplicateData = false);
 
 	/** Get the top-level struct. */
 	GFF3WriterStructPtr getTopLevel();
@@ -67,30 +76,6 @@ private:
 		bool operator==(const Vector4 &v)  const {
 			return x == v.x && y == v.y && z == v.z && w == v.w;
 		}
-
-		bool operator<(const Vector4 &v) const {
-			if (x < v.x)
-				return true;
-			if (x > v.x)
-				return false;
-
-			if (y < v.y)
-				return true;
-			if (y > v.y)
-				return false;
-
-			if (z < v.z)
-				return true;
-			if (z > v.z)
-				return false;
-
-			if (w < v.w)
-				return true;
-			if (w > v.w)
-				return false;
-
-			return false;
-		}
 	};
 
 	/** A special struct type for representing void data. */
@@ -109,9 +94,10 @@ private:
 			return data.get() == rhs.data.get();
 		}
 
-		bool operator<(const VoidData &rhs) const {
-			return std::less<Common::SeekableReadStream*>{}(data.get(), rhs.data.get());
-		}
+		/** Hash the actual contents of the data. */
+		uint64_t hashContents() const;
+		/** Does the data have the exact same contents? */
+		bool equalContents(const VoidData &rhs) const;
 	};
 
 	/** A variant containing all possible types of GFF data. */
@@ -128,11 +114,15 @@ private:
 		VoidData
 	> ValueData;
 
-	class ValueDataLess : public boost::static_visitor<bool> {
+	/** Hash a value's data, consistently with its equality operator. */
+	class ValueDataHash : public boost::static_visitor<size_t> {
 	public:
-		template<typename T, typename U> bool operator()(const T &UNUSED(v1), const U &UNUSED(v2)) const { return false; }
+		template<typename T> size_t operator()(const T &v) const { return boost::hash<T>()(v); }
 
-		template<typename T> bool operator()(const T &v1, const T &v2) const { return v1 < v2; }
+		size_t operator()(const Vector4 &v) const;
+		size_t operator()(const Common::UString &v) const;
+		size_t operator()(const LocString &v) const;
+		size_t operator()(const VoidData &v) const;
 	};
 
 	/** A value holds a type and data. */
@@ -141,22 +131,11 @@ private:
 		ValueData data;
 		bool isRaw { false };
 
-		/** Equality operator for std::find. */
+		/** Equality operator for finding duplicate values. */
 		bool operator==(const Value &rhs) const {
 			return type == rhs.type &&
 			       data == rhs.data;
 		}
-
-		/** Relational operator for map find. */
-		bool operator<(const Value &rhs) const {
-			if (type != rhs.type) {
-				return type < rhs.type;
-			} else if (data.which() != rhs.data.which()) {
-				return data.which() < rhs.data.which();
-			} else {
-				return boost::apply_visitor(ValueDataLess(), data, rhs.data);
-			}
-		}
 	};
 
 	/** An implementation for a field. */
@@ -167,13 +146,40 @@ private:
 
 	typedef boost::shared_ptr<Field> FieldPtr;
 
+	/** Hash a value. Raw data can optionally be hashed by its contents. */
+	struct ValuePtrHash {
+		bool byContents;
+
+		ValuePtrHash(bool contents = false) : byContents(contents) { }
+
+		size_t operator()(const Value *value) const;
+	};
+
+	/** Compare two values. Raw data can optionally be compared by its contents. */
+	struct ValuePtrEqual {
+		bool byContents;
+
+		ValuePtrEqual(bool contents = false) : byContents(contents) { }
+
+		bool operator()(const Value *value1, const Value *value2) const;
+	};
+
+	/** Map of a value to its offset within the field data. */
+	typedef boost::unordered_map<const Value *, uint32_t, ValuePtrHash, ValuePtrEqual> ValueOffsetMap;
+
+	typedef boost::unordered_map<Common::UString, uint32_t, Common::hashUStringCaseSensitive> LabelMap;
+
 	uint32_t _id;
 	uint32_t _version;
 
+	bool _deduplicateData;
+
 	std::vector<GFF3WriterStructPtr> _structs;
 	std::vector<GFF3WriterListPtr> _lists;
 
 	std::vector<Common::UString> _labels;
+	LabelMap _labelIndices;
+
 	std::vector<FieldPtr> _fields;
 
 	friend class GFF3WriterList;
@@ -182,7 +188,9 @@ private:
 	/** Adds a label to the writer and returns the corresponding index. */
 	uint32_t addLabel(const Common::UString &label);
 	/** Get the actual size of the field. */
-	static uint32_t getFieldDataSize(Value field);
+	static uint32_t getFieldDataSize(const Value &field);
+	/** Is this a simple value, written directly into the field instead of the field data? */
+	static bool isSimple(GFF3Struct::FieldType type);
 
 	size_t createField(GFF3Struct::FieldType type, const Common::UString &label);
 };
@@ -238,11 +238,8 @@ void GFF4File::loadStrings() {
 	if (!_header.hasSharedStrings)
 		return;
 
-	_sharedStrings.resize(_header.stringCount);
-
 	_stream->seek(_header.stringOffset);
-	for (uint32_t i = 0; i < _header.stringCount; i++)
-		_sharedStrings[i] = Common::readString(*_stream, Common::kEncodingUTF8);
+	Common::readStrings(*_stream, Common::kEncodingUTF8, _header.stringCount, _sharedStrings);
 }
 
 // --- Helpers for GFF4Struct ---
@@ -26,6 +26,8 @@
 #ifndef AURORA_KEYDATAWRITER_H
 #define AURORA_KEYDATAWRITER_H
 
+#include <functional>
+
 #include "src/common/readstream.h"
 
 #include "src/aurora/types.h"
@@ -34,8 +36,24 @@ namespace Aurora {
 
 class KEYDataWriter {
 public:
+	/**
+	 * Called after a file has been written into the data file,
+	 * with the index of the file in the order it was added.
+	 */
+	typedef std::function<void(size_t)> WrittenCallback;
+
 	virtual ~KEYDataWriter() { };
 
+	/**
+	 * Set a function to call whenever a file has been written. Writers
+	 * compressing on several threads write a file only once its compression
+	 * has finished, long after add() returned.
+	 * @param callback the function to call
+	 */
+	void setWrittenCallback(const WrittenCallback &callback) {
+		_writtenCallback = callback;
+	}
+
 	/**
 	 * Get the size of this data file, to write it into the
 	 * KEY file.
@@ -49,6 +67,15 @@ public:
 	 * @param type the type of this data
 	 */
 	virtual void add(Common::SeekableReadStream &data, FileType type) = 0;
+
+	/**
+	 * Write everything still outstanding, including the file table,
+	 * into the data file.
+	 */
+	virtual void flush() = 0;
+
+protected:
+	WrittenCallback _writtenCallback;
 };
 
 } // End of namespace Aurora
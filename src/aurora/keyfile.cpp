@@ -44,6 +44,9 @@ KEYFile::KEYFile(Common::SeekableReadStream &key) {
 	load(key);
 }
 
+KEYFile::KEYFile() {
+}
+
 KEYFile::~KEYFile() {
 }
 
@@ -94,8 +94,13 @@ private:
 	BIFList      _bifs;      ///< All managed bifs.
 	ResourceList _resources; ///< All containing resources.
 
+	/** Create an empty KEY file, to be filled by a KEYIndexCache. */
+	KEYFile();
+
 	void load(Common::SeekableReadStream &key);
 
+	friend class KEYIndexCache;
+
 	void readBIFList(Common::SeekableReadStream &key, uint32_t offset);
 	void readResList(Common::SeekableReadStream &key, uint32_t offset);
 };
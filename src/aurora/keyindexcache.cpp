@@ -0,0 +1,402 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  An on-disk cache of the resource index of KEY and BIF/BZF files.
+ */
+
+/* The cache consists of a header, a file table and one section for each
+ * file. All values are little-endian, except for the tags and IDs, which
+ * are stored like in the files they come from.
+ *
+ * Header:
+ *   uint32_t "KIDX"
+ *   uint32_t "V1.0"
+ *   uint32_t number of files
+ *
+ * File table, for each file:
+ *   uint8_t  1 for a KEY file, 0 for a data file
+ *   uint64_t size
+ *   uint64_t modification time
+ *   uint32_t offset of the file's section, relative to the end of the table
+ *   uint32_t length of the path
+ *   path, in UTF-8
+ *
+ * KEY section:
+ *   uint32_t ID
+ *   uint32_t version
+ *   uint32_t number of BIFs
+ *   for each BIF:
+ *     uint32_t length of the name
+ *     name, in UTF-8
+ *   uint32_t number of resources
+ *   for each resource:
+ *     16 bytes name
+ *     uint32_t type
+ *     uint32_t BIF index
+ *     uint32_t resource index
+ *
+ * Data file section:
+ *   uint32_t ID ("BIFF" or "BZF ")
+ *   uint32_t version
+ *   uint32_t number of internal resources
+ *   for each internal resource:
+ *     uint32_t type
+ *     uint32_t offset
+ *     uint32_t size
+ *     uint32_t packed size (BZF only)
+ *   uint32_t number of merged resources
+ *   for each merged resource:
+ *     16 bytes name
+ *     uint32_t type
+ *     uint32_t index
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/strutil.h"
+#include "src/common/error.h"
+#include "src/common/encoding.h"
+#include "src/common/filepath.h"
+#include "src/common/readstream.h"
+#include "src/common/writestream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/keyindexcache.h"
+#include "src/aurora/keyfile.h"
+#include "src/aurora/biffile.h"
+#include "src/aurora/bzffile.h"
+
+static const uint32_t kCacheID      = MKTAG('K', 'I', 'D', 'X');
+static const uint32_t kCacheVersion = MKTAG('V', '1', '.', '0');
+
+static const uint32_t kBIFID = MKTAG('B', 'I', 'F', 'F');
+static const uint32_t kBZFID = MKTAG('B', 'Z', 'F', ' ');
+
+static const size_t kNameLength = 16;
+
+namespace Aurora {
+
+KEYIndexCache::File::File() : isKEY(false), size(0), modificationTime(0) {
+}
+
+KEYIndexCache::File::File(const Common::UString &p, bool key) :
+	path(Common::FilePath::canonicalize(p)), isKEY(key), size(0), modificationTime(0) {
+
+	const size_t fileSize = Common::FilePath::getFileSize(path);
+	if (fileSize != Common::kFileInvalid)
+		size = fileSize;
+
+	modificationTime = (uint64_t) Common::FilePath::getModificationTime(path);
+}
+
+bool KEYIndexCache::File::isSameFile(const File &file) const {
+	return (path == file.path) && (size == file.size) && (modificationTime == file.modificationTime);
+}
+
+
+KEYIndexCache::KEYIndexCache(Common::SeekableReadStream *cache) : _cache(cache) {
+	assert(_cache);
+
+	load(*_cache);
+}
+
+KEYIndexCache::~KEYIndexCache() {
+}
+
+void KEYIndexCache::load(Common::SeekableReadStream &cache) {
+	const uint32_t id      = cache.readUint32BE();
+	const uint32_t version = cache.readUint32BE();
+
+	if (id != kCacheID)
+		throw Common::Exception("Not a KEY index cache (%s)", Common::debugTag(id).c_str());
+	if (version != kCacheVersion)
+		throw Common::Exception("Unsupported KEY index cache version %s", Common::debugTag(version).c_str());
+
+	const uint32_t fileCount = cache.readUint32LE();
+	if (fileCount > (cache.size() - cache.pos()))
+		throw Common::Exception("Invalid KEY index cache file count %u", fileCount);
+
+	_files.resize(fileCount);
+
+	std::vector<uint32_t> offsets(fileCount);
+	for (uint32_t i = 0; i < fileCount; i++) {
+		_files[i].isKEY            = cache.readByte() != 0;
+		_files[i].size             = cache.readUint64LE();
+		_files[i].modificationTime = cache.readUint64LE();
+
+		offsets[i] = cache.readUint32LE();
+
+		const uint32_t pathLength = cache.readUint32LE();
+		_files[i].path = Common::readStringFixed(cache, Common::kEncodingUTF8, pathLength);
+	}
+
+	const size_t sectionStart = cache.pos();
+
+	for (uint32_t i = 0; i < fileCount; i++) {
+		if ((sectionStart + offsets[i]) >= cache.size())
+			throw Common::Exception("Invalid KEY index cache section offset %u", offsets[i]);
+
+		if (_files[i].isKEY)
+			_keyOffsets.push_back(sectionStart + offsets[i]);
+		else
+			_dataOffsets.push_back(sectionStart + offsets[i]);
+	}
+}
+
+const KEYIndexCache::FileList &KEYIndexCache::getFiles() const {
+	return _files;
+}
+
+bool KEYIndexCache::isCurrent(const FileList &files) const {
+	if (files.size() != _files.size())
+		return false;
+
+	for (size_t i = 0; i < files.size(); i++)
+		if (!_files[i].isSameFile(files[i]))
+			return false;
+
+	return true;
+}
+
+static void checkCount(Common::SeekableReadStream &cache, uint32_t count, size_t entrySize) {
+	if (count > ((cache.size() - cache.pos()) / entrySize))
+		throw Common::Exception("Invalid KEY index cache entry count %u", count);
+}
+
+KEYFile *KEYIndexCache::createKEY(size_t n) const {
+	if (n >= _keyOffsets.size())
+		throw Common::Exception("KEY index out of range (%u/%u)", (uint)n, (uint)_keyOffsets.size());
+
+	_cache->seek(_keyOffsets[n]);
+
+	std::unique_ptr<KEYFile> key(new KEYFile);
+
+	key->_id      = _cache->readUint32BE();
+	key->_version = _cache->readUint32BE();
+
+	const uint32_t bifCount = _cache->readUint32LE();
+	checkCount(*_cache, bifCount, 4);
+
+	key->_bifs.resize(bifCount);
+	for (KEYFile::BIFList::iterator bif = key->_bifs.begin(); bif != key->_bifs.end(); ++bif) {
+		const uint32_t nameLength = _cache->readUint32LE();
+
+		*bif = Common::readStringFixed(*_cache, Common::kEncodingUTF8, nameLength);
+	}
+
+	const uint32_t resCount = _cache->readUint32LE();
+	checkCount(*_cache, resCount, kNameLength + 12);
+
+	key->_resources.resize(resCount);
+	for (KEYFile::ResourceList::iterator res = key->_resources.begin(); res != key->_resources.end(); ++res) {
+		res->name     = Common::readStringFixed(*_cache, Common::kEncodingUTF8, kNameLength);
+		res->type     = (FileType) _cache->readUint32LE();
+		res->bifIndex = _cache->readUint32LE();
+		res->resIndex = _cache->readUint32LE();
+	}
+
+	return key.release();
+}
+
+static void readMergedResources(Common::SeekableReadStream &cache, Archive::ResourceList &resources) {
+	const uint32_t resCount = cache.readUint32LE();
+	checkCount(cache, resCount, kNameLength + 8);
+
+	for (uint32_t i = 0; i < resCount; i++) {
+		resources.push_back(Archive::Resource());
+
+		resources.back().name  = Common::readStringFixed(cache, Common::kEncodingUTF8, kNameLength);
+		resources.back().type  = (FileType) cache.readUint32LE();
+		resources.back().index = cache.readUint32LE();
+	}
+}
+
+KEYDataFile *KEYIndexCache::createDataFile(size_t n, Common::SeekableReadStream *dataFile) const {
+	std::unique_ptr<Common::SeekableReadStream> stream(dataFile);
+	assert(stream);
+
+	if (n >= _dataOffsets.size())
+		throw Common::Exception("Data file index out of range (%u/%u)", (uint)n, (uint)_dataOffsets.size());
+
+	_cache->seek(_dataOffsets[n]);
+
+	const uint32_t id      = _cache->readUint32BE();
+	const uint32_t version = _cache->readUint32BE();
+
+	const uint32_t iResCount = _cache->readUint32LE();
+
+	if (id == kBIFID) {
+		checkCount(*_cache, iResCount, 12);
+
+		std::unique_ptr<BIFFile> bif(new BIFFile);
+
+		bif->_id      = id;
+		bif->_version = version;
+
+		bif->_iResources.resize(iResCount);
+		for (BIFFile::IResourceList::iterator res = bif->_iResources.begin(); res != bif->_iResources.end(); ++res) {
+			res->type   = (FileType) _cache->readUint32LE();
+			res->offset = _cache->readUint32LE();
+			res->size   = _cache->readUint32LE();
+		}
+
+		readMergedResources(*_cache, bif->_resources);
+
+		bif->_bif = std::move(stream);
+		return bif.release();
+	}
+
+	if (id == kBZFID) {
+		checkCount(*_cache, iResCount, 16);
+
+		std::unique_ptr<BZFFile> bzf(new BZFFile);
+
+		bzf->_id      = id;
+		bzf->_version = version;
+
+		bzf->_iResources.resize(iResCount);
+		for (BZFFile::IResourceList::iterator res = bzf->_iResources.begin(); res != bzf->_iResources.end(); ++res) {
+			res->type       = (FileType) _cache->readUint32LE();
+			res->offset     = _cache->readUint32LE();
+			res->size       = _cache->readUint32LE();
+			res->packedSize = _cache->readUint32LE();
+		}
+
+		readMergedResources(*_cache, bzf->_resources);
+
+		bzf->_bzf = std::move(stream);
+		return bzf.release();
+	}
+
+	throw Common::Exception("Invalid KEY index cache data file type %s", Common::debugTag(id).c_str());
+}
+
+static void writeMergedResources(Common::WriteStream &cache, const Archive::ResourceList &resources) {
+	cache.writeUint32LE(resources.size());
+
+	for (Archive::ResourceList::const_iterator res = resources.begin(); res != resources.end(); ++res) {
+		Common::writeStringFixed(cache, res->name, Common::kEncodingUTF8, kNameLength);
+		cache.writeUint32LE((uint32_t) res->type);
+		cache.writeUint32LE(res->index);
+	}
+}
+
+static void writeKEY(Common::WriteStream &cache, const KEYFile &key) {
+	cache.writeUint32BE(key.getID());
+	cache.writeUint32BE(key.getVersion());
+
+	const KEYFile::BIFList &bifs = key.getBIFs();
+
+	cache.writeUint32LE(bifs.size());
+	for (KEYFile::BIFList::const_iterator bif = bifs.begin(); bif != bifs.end(); ++bif) {
+		cache.writeUint32LE(std::strlen(bif->c_str()));
+		cache.writeString(*bif);
+	}
+
+	const KEYFile::ResourceList &resources = key.getResources();
+
+	cache.writeUint32LE(resources.size());
+	for (KEYFile::ResourceList::const_iterator res = resources.begin(); res != resources.end(); ++res) {
+		Common::writeStringFixed(cache, res->name, Common::kEncodingUTF8, kNameLength);
+		cache.writeUint32LE((uint32_t) res->type);
+		cache.writeUint32LE(res->bifIndex);
+		cache.writeUint32LE(res->resIndex);
+	}
+}
+
+void KEYIndexCache::write(Common::WriteStream &cache, const FileList &files,
+                          const std::vector<std::unique_ptr<KEYFile>> &keys,
+                          const std::vector<std::unique_ptr<KEYDataFile>> &dataFiles) {
+
+	// First write all sections, to find out where each of them starts
+
+	Common::MemoryWriteStreamDynamic sections(true);
+	std::vector<uint32_t> offsets;
+
+	size_t keyIndex = 0, dataIndex = 0;
+	for (FileList::const_iterator f = files.begin(); f != files.end(); ++f) {
+		offsets.push_back(sections.size());
+
+		if (f->isKEY) {
+			if (keyIndex >= keys.size())
+				throw Common::Exception("More KEY files than KEYs");
+
+			writeKEY(sections, *keys[keyIndex++]);
+			continue;
+		}
+
+		if (dataIndex >= dataFiles.size())
+			throw Common::Exception("More data files than KEY data files");
+
+		const KEYDataFile *dataFile = dataFiles[dataIndex++].get();
+
+		if (const BIFFile *bif = dynamic_cast<const BIFFile *>(dataFile)) {
+			sections.writeUint32BE(kBIFID);
+			sections.writeUint32BE(bif->getVersion());
+
+			sections.writeUint32LE(bif->_iResources.size());
+			for (BIFFile::IResourceList::const_iterator res = bif->_iResources.begin(); res != bif->_iResources.end(); ++res) {
+				sections.writeUint32LE((uint32_t) res->type);
+				sections.writeUint32LE(res->offset);
+				sections.writeUint32LE(res->size);
+			}
+
+		} else if (const BZFFile *bzf = dynamic_cast<const BZFFile *>(dataFile)) {
+			sections.writeUint32BE(kBZFID);
+			sections.writeUint32BE(bzf->getVersion());
+
+			sections.writeUint32LE(bzf->_iResources.size());
+			for (BZFFile::IResourceList::const_iterator res = bzf->_iResources.begin(); res != bzf->_iResources.end(); ++res) {
+				sections.writeUint32LE((uint32_t) res->type);
+				sections.writeUint32LE(res->offset);
+				sections.writeUint32LE(res->size);
+				sections.writeUint32LE(res->packedSize);
+			}
+
+		} else
+			throw Common::Exception("Unsupported KEY data file type");
+
+		writeMergedResources(sections, dataFile->getResources());
+	}
+
+	if ((keyIndex != keys.size()) || (dataIndex != dataFiles.size()))
+		throw Common::Exception("File list doesn't match the KEY and data files");
+
+	cache.writeUint32BE(kCacheID);
+	cache.writeUint32BE(kCacheVersion);
+
+	cache.writeUint32LE(files.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		cache.writeByte(files[i].isKEY ? 1 : 0);
+		cache.writeUint64LE(files[i].size);
+		cache.writeUint64LE(files[i].modificationTime);
+		cache.writeUint32LE(offsets[i]);
+
+		cache.writeUint32LE(std::strlen(files[i].path.c_str()));
+		cache.writeString(files[i].path);
+	}
+
+	cache.write(sections.getData(), sections.size());
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,125 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  An on-disk cache of the resource index of KEY and BIF/BZF files.
+ */
+
+#ifndef AURORA_KEYINDEXCACHE_H
+#define AURORA_KEYINDEXCACHE_H
+
+#include <vector>
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+	class SeekableReadStream;
+	class WriteStream;
+}
+
+namespace Aurora {
+
+class KEYFile;
+class KEYDataFile;
+
+/** A cache of the resource index of a set of KEY and BIF/BZF files.
+ *
+ *  Getting at the resources of a KEY/BIF install means parsing all the KEY
+ *  files, reading the resource tables of all the BIF and BZF files and
+ *  merging the names from the KEYs into the data files. The cache stores the
+ *  result of all that in a compact binary form, together with the path, size
+ *  and modification time of every file it was built from.
+ *
+ *  As long as none of these files changed, the KEY and data files can be
+ *  recreated straight out of the cache, without parsing or merging anything.
+ *  Only the sections of the files that are actually used are read, so the
+ *  cache is best read out of a MappedReadFile.
+ */
+class KEYIndexCache : boost::noncopyable {
+public:
+	/** A file the cache was built from. */
+	struct File {
+		Common::UString path; ///< The path to the file.
+
+		bool isKEY; ///< Is this a KEY file (or a data file)?
+
+		uint64_t size;             ///< The size of the file in bytes.
+		uint64_t modificationTime; ///< The time the file was last modified.
+
+		File();
+		/** Look up canonical path, size and modification time of a file on disk. */
+		File(const Common::UString &p, bool key = false);
+
+		/** Is this the same, unchanged file? Disregards isKEY. */
+		bool isSameFile(const File &file) const;
+	};
+
+	typedef std::vector<File> FileList;
+
+	/** Take over this stream and read the cache's file table out of it. */
+	KEYIndexCache(Common::SeekableReadStream *cache);
+	~KEYIndexCache();
+
+	/** Return all files the cache was built from, in their original order. */
+	const FileList &getFiles() const;
+
+	/** Was the cache built from exactly these files, and are they all unchanged? */
+	bool isCurrent(const FileList &files) const;
+
+	/** Recreate the n-th KEY file. */
+	KEYFile *createKEY(size_t n) const;
+
+	/** Recreate the n-th data file, with all KEYs already merged into it.
+	 *
+	 *  @param n The index of the data file, counting only data files.
+	 *  @param dataFile The stream of the data file itself, which will be taken over.
+	 */
+	KEYDataFile *createDataFile(size_t n, Common::SeekableReadStream *dataFile) const;
+
+	/** Write a cache of KEY and data files.
+	 *
+	 *  @param cache The stream to write the cache into.
+	 *  @param files All files, KEYs and data files, in their original order.
+	 *  @param keys The opened KEY files, in the order they appear in files.
+	 *  @param dataFiles The opened data files, in the order they appear in files,
+	 *                   with the KEYs already merged into them.
+	 */
+	static void write(Common::WriteStream &cache, const FileList &files,
+	                  const std::vector<std::unique_ptr<KEYFile>> &keys,
+	                  const std::vector<std::unique_ptr<KEYDataFile>> &dataFiles);
+
+private:
+	std::unique_ptr<Common::SeekableReadStream> _cache;
+
+	FileList _files;
+
+	std::vector<size_t> _keyOffsets;  ///< Offsets of the KEY sections within the cache.
+	std::vector<size_t> _dataOffsets; ///< Offsets of the data file sections within the cache.
+
+	void load(Common::SeekableReadStream &cache);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_KEYINDEXCACHE_H
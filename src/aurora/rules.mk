@@ -35,6 +35,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/keydatafile.h \
     src/aurora/biffile.h \
     src/aurora/bzffile.h \
+    src/aurora/keyindexcache.h \
     src/aurora/ndsrom.h \
     src/aurora/zipfile.h \
     src/aurora/herffile.h \
@@ -61,6 +62,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/xmlfixer.h \
     src/aurora/keywriter.h \
     src/aurora/keydatawriter.h \
+    src/aurora/compression.h \
     src/aurora/bifwriter.h \
     src/aurora/bzfwriter.h \
     src/aurora/rimwriter.h \
@@ -76,6 +78,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/keyfile.cpp \
     src/aurora/biffile.cpp \
     src/aurora/bzffile.cpp \
+    src/aurora/keyindexcache.cpp \
     src/aurora/ndsrom.cpp \
     src/aurora/zipfile.cpp \
     src/aurora/herffile.cpp \
@@ -95,6 +98,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/nitrofile.cpp \
     src/aurora/nsbtxfile.cpp \
     src/aurora/erfwriter.cpp \
+    src/aurora/compression.cpp \
     src/aurora/sacfile.cpp \
     src/aurora/thewitchersavefile.cpp \
     src/aurora/thewitchersavewriter.cpp \
@@ -25,7 +25,11 @@
 #include <cassert>
 
 #include <memory>
+#include <vector>
 
+#include <boost/noncopyable.hpp>
+
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
@@ -121,59 +125,170 @@ static void decompress10(Common::ReadStream &small, Common::WriteStream &out, ui
 		throw Common::Exception("Invalid \"small\" data");
 }
 
-/** Determine the maximum size of an LZSS-compressed block.
- *
- *  Since this function supports continuously copying bytes from the "edge"
- *  of the current compression pointer (which is the main difference between
- *  LZSS and vanilla LZ77), both newPtr and oldPtr need to point into the
- *  same memory region.
+/** Finds earlier occurrences of data, for the LZSS 0x10 compression.
  *
- *  Takes O(newLength * oldLength) = O(n^2) time.
+ *  All positions are put into buckets by a hash over their first 3 bytes,
+ *  the minimum length of a copy block. A bucket is a list running from the
+ *  oldest to the newest position; positions that fell out of the 0x1000
+ *  bytes window are pruned from its front on lookup.
  *
- *  @param  newPtr The start of the data that needs to be compressed.
- *  @param  newLength The number of bytes that still need to be compressed.
- *  @param  oldPtr The start of the raw file.
- *  @param  oldLength The number of bytes already compressed.
- *  @param  displacement The offset of the start of the longest block to refer to.
- *  @param  minDisplacement The minimum allowed value for a valid displacement.
- *  @return The length of the longest sequence of bytes that can be copied from oldPtr.
+ *  Only the positions in one bucket need to be compared, instead of the
+ *  whole window. Otherwise, the search works like the brute-force search
+ *  it replaced, producing the same results: among the longest occurrences,
+ *  the one furthest back wins, and a displacement of 1 is never used.
  */
-size_t getOccurrenceLength(const byte *newPtr, size_t newLength,
-                           const byte *oldPtr, size_t oldLength,
-                           size_t &displacement, size_t minDisplacement = 1) {
-	displacement = 0;
-
-	// Can we actually do anything with the data?
-	if ((minDisplacement > oldLength) || (newLength == 0))
-		return 0;
-
-	size_t maxLength = 0;
-	for (size_t i = 0; i < oldLength - minDisplacement; i++) {
-		/* Try out every single possible displacement value, from the
-		 * start of the old data to the end. */
-
-		const byte *currentOldPtr = oldPtr + i;
-		size_t currentLength = 0;
-
-		/* Determine the length we can copy if we go back (oldLength - i) bytes.
-		 *  Always check the next newLength bytes, because we do LZSS. */
-		for (size_t j = 0; j < newLength; j++, currentLength++)
-			if (currentOldPtr[j] != newPtr[j])
-				break;
-
-		if (currentLength > maxLength) {
-			// We've bettered our last try
-			maxLength = currentLength;
-			displacement = oldLength - i;
-
-			// If we can't get any better than that, stop
-			if (maxLength == newLength)
-				break;
+class SmallMatchFinder : boost::noncopyable {
+public:
+	SmallMatchFinder(const byte *data, size_t size) : _data(data), _size(size), _inserted(0),
+		_next(size, kNone), _first(kBucketCount, kNone), _last(kBucketCount, kNone) {
+	}
+
+	/** Find the longest occurrence of the data at this position within the window.
+	 *
+	 *  Positions have to be searched in ascending order.
+	 *
+	 *  @param  pos The position of the data that needs to be compressed.
+	 *  @param  displacement How many bytes back the found occurrence starts.
+	 *  @return The length of the occurrence, or 0 if there's none of at least 3 bytes.
+	 */
+	size_t find(size_t pos, size_t &displacement) {
+		displacement = 0;
+
+		insert(pos);
+
+		const size_t maxLength = MIN<size_t>(_size - pos, 0x12);
+		if ((maxLength < 3) || (pos < 2))
+			return 0;
+
+		const size_t windowStart = (pos > 0x1000) ? (pos - 0x1000) : 0;
+
+		const size_t bucket = hash(_data + pos);
+		prune(bucket, windowStart);
+
+		size_t length = 0;
+		for (uint32_t old = _first[bucket]; (old != kNone) && ((old + 2) <= pos); old = _next[old]) {
+			size_t currentLength = 0;
+			while ((currentLength < maxLength) && (_data[old + currentLength] == _data[pos + currentLength]))
+				currentLength++;
+
+			if (currentLength > length) {
+				length       = currentLength;
+				displacement = pos - old;
+
+				if (length == maxLength)
+					break;
+			}
+		}
+
+		if (length < 3) {
+			displacement = 0;
+			return 0;
 		}
+
+		return length;
 	}
 
-	return maxLength;
-}
+private:
+	static const size_t   kBucketBits  = 15;
+	static const size_t   kBucketCount = 1 << kBucketBits;
+	static const uint32_t kNone        = 0xFFFFFFFF;
+
+	const byte *_data;
+	size_t _size;
+
+	size_t _inserted; ///< The number of positions already in the buckets.
+
+	std::vector<uint32_t> _next;  ///< The next newer position in the same bucket.
+	std::vector<uint32_t> _first; ///< The oldest position in each bucket.
+	std::vector<uint32_t> _last;  ///< The newest position in each bucket.
+
+	static size_t hash(const byte *data) {
+		const uint32_t key = (data[0] << 16) | (data[1] << 8) | data[2];
+
+		return (key * 2654435761U) >> (32 - kBucketBits);
+	}
+
+	/** Put all positions before pos into their buckets. */
+	void insert(size_t pos) {
+		for (; _inserted < pos; _inserted++) {
+			// Without 3 bytes left, a position can't start a copy block
+			if ((_inserted + 2) >= _size)
+				continue;
+
+			const size_t bucket = hash(_data + _inserted);
+
+			if (_last[bucket] == kNone)
+				_first[bucket] = _inserted;
+			else
+				_next[_last[bucket]] = _inserted;
+
+			_last[bucket] = _inserted;
+		}
+	}
+
+	/** Remove all positions before windowStart from the front of a bucket. */
+	void prune(size_t bucket, size_t windowStart) {
+		while ((_first[bucket] != kNone) && (_first[bucket] < windowStart))
+			_first[bucket] = _next[_first[bucket]];
+
+		if (_first[bucket] == kNone)
+			_last[bucket] = kNone;
+	}
+};
+
+const size_t   SmallMatchFinder::kBucketBits;
+const size_t   SmallMatchFinder::kBucketCount;
+const uint32_t SmallMatchFinder::kNone;
+
+/** Writes the blocks of LZSS 0x10 compressed data, together with their flags. */
+class SmallBlockWriter : boost::noncopyable {
+public:
+	SmallBlockWriter(Common::WriteStream &small) : _small(&small), _bufferedBlocks(0), _bufferLength(1) {
+		_buffer[0] = 0x00;
+	}
+
+	void writeLiteral(byte data) {
+		_buffer[_bufferLength++] = data;
+
+		nextBlock();
+	}
+
+	void writeCopy(size_t length, size_t displacement) {
+		// Mark the block as compressed
+		_buffer[0] |= 1 << (7 - _bufferedBlocks);
+
+		_buffer[_bufferLength  ]  = ((length       - 3) << 4) & 0xF0;
+		_buffer[_bufferLength++] |= ((displacement - 1) >> 8) & 0x0F;
+		_buffer[_bufferLength++]  =  (displacement - 1)       & 0xFF;
+
+		nextBlock();
+	}
+
+	/** Write the remaining blocks. */
+	void flush() {
+		if (_bufferedBlocks > 0)
+			if (_small->write(_buffer, _bufferLength) != _bufferLength)
+				throw Common::Exception(Common::kWriteError);
+
+		_bufferedBlocks = 0;
+		_bufferLength   = 1;
+
+		_buffer[0] = 0x00;
+	}
+
+private:
+	Common::WriteStream *_small;
+
+	// Buffer for 8 blocks (max. 2 bytes each), plus their flags byte
+	byte _buffer[8 * 2 + 1];
+	size_t _bufferedBlocks, _bufferLength;
+
+	void nextBlock() {
+		// If 8 blocks have been buffered, write them and reset the buffer
+		if (++_bufferedBlocks == 8)
+			flush();
+	}
+};
 
 /* Simple LZSS 0x10 compression.
  *
@@ -182,66 +297,93 @@ size_t getOccurrenceLength(const byte *newPtr, size_t newLength,
  * See <https://github.com/gravgun/dsdecmp/blob/master/CSharp/DSDecmp/Formats/Nitro/LZ10.cs#L249>
  * and <https://code.google.com/p/dsdecmp/>.
  */
-static void compress10(Common::ReadStream &in, Common::WriteStream &small, uint32_t size) {
-	std::unique_ptr<byte[]> inBuffer = std::make_unique<byte[]>(size);
-	if (in.read(inBuffer.get(), size) != size)
-		throw Common::Exception(Common::kReadError);
-
-	// Buffer for 8 blocks (max. 2 bytes each), plus their flags byte
-	byte outBuffer[8 * 2 + 1] = { 0 };
-	size_t bufferedBlocks = 0, bufferLength = 1;
+static void compress10Greedy(const byte *data, uint32_t size, SmallBlockWriter &writer) {
+	SmallMatchFinder finder(data, size);
 
 	size_t inRead = 0;
 	while (inRead < size) {
-		// If 8 blocks have been buffered, write them and reset the buffer
-		if (bufferedBlocks == 8) {
-			if (small.write(outBuffer, bufferLength) != bufferLength)
-				throw Common::Exception(Common::kWriteError);
-
-			bufferedBlocks = 0;
-			bufferLength   = 1;
-
-			outBuffer[0] = 0x00;
-		}
-
 		/* Look for duplications in the input data:
 		 * Try to find an occurrence of data starting from the current place in the
 		 * data within the last 0x1000 bytes bytes (the maximum displacement the
 		 * format supports) of the already compressed data, but only check the next
 		 * 0x12 bytes (the maximum copy length). */
 
-		const size_t newLength = MIN<size_t>(size - inRead, 0x12);
-		const size_t oldLength = MIN<size_t>(inRead, 0x1000);
-
 		size_t displacement = 0;
-		const size_t length =
-			getOccurrenceLength(inBuffer.get() + inRead            , newLength,
-			                    inBuffer.get() + inRead - oldLength, oldLength,
-			                    displacement);
+		const size_t length = finder.find(inRead, displacement);
 
 		/* If the length of the occurrence is at least 3 bytes, we safe space by
 		 * referring to the earlier place in the data. If it's shorter (or even
 		 * non-existent), then just encode the next byte literally. */
 
 		if (length >= 3) {
+			writer.writeCopy(length, displacement);
 			inRead += length;
+		} else
+			writer.writeLiteral(data[inRead++]);
+	}
+}
 
-			// Mark the block as compressed
-			outBuffer[0] |= 1 << (7 - bufferedBlocks);
+/* Optimal LZSS 0x10 compression.
+ *
+ * Instead of always taking the longest occurrence at the current position,
+ * find the cheapest sequence of blocks for the whole data. A literal block
+ * costs 9 bits (including its flag bit), a copy block 17 bits. Going back
+ * from the end of the data, the cheapest encoding of the rest of the data
+ * starting at each position is either a literal followed by the cheapest
+ * encoding starting one byte later, or a copy of any length from 3 to the
+ * longest occurrence found at this position, followed by the cheapest
+ * encoding after that copy.
+ */
+static void compress10Optimal(const byte *data, uint32_t size, SmallBlockWriter &writer) {
+	std::vector<uint8_t>  lengths(size);
+	std::vector<uint16_t> displacements(size);
 
-			outBuffer[bufferLength  ]  = ((length       - 3) << 4) & 0xF0;
-			outBuffer[bufferLength++] |= ((displacement - 1) >> 8) & 0x0F;
-			outBuffer[bufferLength++]  =  (displacement - 1)       & 0xFF;
-		} else
-			outBuffer[bufferLength++] = inBuffer[inRead++];
+	SmallMatchFinder finder(data, size);
+	for (size_t i = 0; i < size; i++) {
+		size_t displacement = 0;
 
-		bufferedBlocks++;
+		lengths[i]       = finder.find(i, displacement);
+		displacements[i] = displacement;
+	}
+
+	// The cost of the rest of the data, in bits, and the block length to get it
+	std::vector<uint32_t> costs(size + 1);
+	std::vector<uint8_t>  choices(size);
+
+	costs[size] = 0;
+	for (size_t i = size; i-- > 0; ) {
+		costs[i]   = costs[i + 1] + 9;
+		choices[i] = 1;
+
+		for (size_t length = 3; length <= lengths[i]; length++) {
+			if ((costs[i + length] + 17) < costs[i]) {
+				costs[i]   = costs[i + length] + 17;
+				choices[i] = length;
+			}
+		}
 	}
 
-	// Write the remaining blocks
-	if (bufferedBlocks > 0)
-		if (small.write(outBuffer, bufferLength) != bufferLength)
-			throw Common::Exception(Common::kWriteError);
+	for (size_t i = 0; i < size; i += choices[i]) {
+		if (choices[i] >= 3)
+			writer.writeCopy(choices[i], displacements[i]);
+		else
+			writer.writeLiteral(data[i]);
+	}
+}
+
+static void compress10(Common::ReadStream &in, Common::WriteStream &small, uint32_t size, bool optimal) {
+	std::unique_ptr<byte[]> inBuffer = std::make_unique<byte[]>(size);
+	if (in.read(inBuffer.get(), size) != size)
+		throw Common::Exception(Common::kReadError);
+
+	SmallBlockWriter writer(small);
+
+	if (optimal)
+		compress10Optimal(inBuffer.get(), size, writer);
+	else
+		compress10Greedy(inBuffer.get(), size, writer);
+
+	writer.flush();
 }
 
 static void decompress(Common::ReadStream &small, Common::WriteStream &out,
@@ -328,13 +470,13 @@ void Small::compress00(Common::SeekableReadStream &in, Common::WriteStream &smal
 	::Aurora::compress00(in, small, size);
 }
 
-void Small::compress10(Common::SeekableReadStream &in, Common::WriteStream &small) {
+void Small::compress10(Common::SeekableReadStream &in, Common::WriteStream &small, bool optimal) {
 	const size_t size = in.size() - in.pos();
 	if (size >= 0xFFFFFF)
 		throw Common::Exception("Small::compress10(): Input stream too large");
 
 	writeSmallHeader(small, 0x10, size);
-	::Aurora::compress10(in, small, size);
+	::Aurora::compress10(in, small, size, optimal);
 }
 
 } // End of namespace Aurora
@@ -56,11 +56,17 @@ public:
 	 */
 	static void compress00(Common::SeekableReadStream &in, Common::WriteStream &small);
 	/** Compress this stream into a small file of type 0x10.
+	 *
+	 *  By default, the compression greedily uses the longest earlier occurrence
+	 *  of the data at each position. If optimal is true, the cheapest possible
+	 *  sequence of literals and copies for the whole data is searched instead,
+	 *  which results in smaller, but still compatible output.
 	 *
 	 *  Note that, depending on the input data, the result may be bigger
 	 *  that the input stream.
 	 */
-	static void compress10(Common::SeekableReadStream &in, Common::WriteStream &small);
+	static void compress10(Common::SeekableReadStream &in, Common::WriteStream &small,
+	                       bool optimal = false);
 };
 
 } // End of namespace Aurora
@@ -213,12 +213,10 @@ void TalkTable_TLK::setEntry(uint32_t strRef, const Common::UString &string, con
                              uint32_t soundID) {
 
 	if (strRef >= _entries.size()) {
+		// All new string references are larger than any existing one, so the list stays sorted
 		for (size_t i = _entries.size(); i < strRef; i++)
 			_strRefs.push_back(i);
 
-		_strRefs.sort();
-		_strRefs.unique();
-
 		_entries.resize(strRef + 1);
 	}
 
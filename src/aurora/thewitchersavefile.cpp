@@ -24,6 +24,8 @@
 
 #include <cassert>
 
+#include "src/common/memreadstream.h"
+
 #include "src/aurora/thewitchersavefile.h"
 #include "src/aurora/util.h"
 
@@ -49,12 +51,9 @@ Common::SeekableReadStream *TheWitcherSaveFile::getResource(uint32_t index, bool
 	IResource resource = _resources[index];
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_tws.get(), resource.offset, resource.offset + resource.length);
-	else {
-		_tws->seek(resource.offset);
-		Common::SeekableReadStream *readStream = _tws->readStream(resource.length);
-		return readStream;
-	}
+		return _tws->getSubStream(resource.offset, resource.offset + resource.length);
+	else
+		return _tws->readStreamAt(resource.offset, resource.length);
 }
 
 void TheWitcherSaveFile::load() {
@@ -25,6 +25,8 @@
 #ifndef AURORA_THEWITCHERSAVEFILE_H
 #define AURORA_THEWITCHERSAVEFILE_H
 
+#include <memory>
+
 #include "src/common/readstream.h"
 
 #include "src/aurora/archive.h"
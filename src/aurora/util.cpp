@@ -353,6 +353,14 @@ const FileTypeManager::Type FileTypeManager::types[] = {
 
 
 FileTypeManager::FileTypeManager() {
+	/* Build all lookup tables up front, so that the lookups themselves
+	 * never modify the manager and can be used from several threads. */
+
+	buildExtensionLookup();
+	buildTypeLookup();
+
+	for (size_t i = 0; i < Common::kHashMAX; i++)
+		buildHashLookup((Common::HashAlgo) i);
 }
 
 FileTypeManager::~FileTypeManager() {
@@ -483,9 +491,7 @@ FileType FileTypeManager::unaliasFileType(FileType type, GameID game) const {
 	return type;
 }
 
-FileType FileTypeManager::getFileType(const Common::UString &path) {
-	buildExtensionLookup();
-
+FileType FileTypeManager::getFileType(const Common::UString &path) const {
 	Common::UString ext = Common::FilePath::getExtension(path).toLower();
 
 	ExtensionLookup::const_iterator t = _extensionLookup.find(ext);
@@ -495,13 +501,11 @@ FileType FileTypeManager::getFileType(const Common::UString &path) {
 	return kFileTypeNone;
 }
 
-Common::UString FileTypeManager::addFileType(const Common::UString &path, FileType type) {
+Common::UString FileTypeManager::addFileType(const Common::UString &path, FileType type) const {
 	return setFileType(path + ".", type);
 }
 
-Common::UString FileTypeManager::setFileType(const Common::UString &path, FileType type) {
-	buildTypeLookup();
-
+Common::UString FileTypeManager::setFileType(const Common::UString &path, FileType type) const {
 	Common::UString ext;
 	TypeLookup::const_iterator t = _typeLookup.find(type);
 	if (t != _typeLookup.end())
@@ -510,12 +514,10 @@ Common::UString FileTypeManager::setFileType(const Common::UString &path, FileTy
 	return Common::FilePath::changeExtension(path, ext);
 }
 
-FileType FileTypeManager::getFileType(Common::HashAlgo algo, uint64_t hashedExtension) {
+FileType FileTypeManager::getFileType(Common::HashAlgo algo, uint64_t hashedExtension) const {
 	if ((algo < 0) || (algo >= Common::kHashMAX))
 		return kFileTypeNone;
 
-	buildHashLookup(algo);
-
 	HashLookup::const_iterator t = _hashLookup[algo].find(hashedExtension);
 	if (t != _hashLookup[algo].end())
 		return t->second->type;
@@ -50,15 +50,15 @@ public:
 	FileType unaliasFileType(FileType type, GameID game) const;
 
 	/** Return the file type of a file name, detected by its extension. */
-	FileType getFileType(const Common::UString &path);
+	FileType getFileType(const Common::UString &path) const;
 
 	/** Return the file type of a file name, detected by its hashed extension. */
-	FileType getFileType(Common::HashAlgo algo, uint64_t hashedExtension);
+	FileType getFileType(Common::HashAlgo algo, uint64_t hashedExtension) const;
 
 	/** Return the file name with an added extensions according to the specified file type. */
-	Common::UString addFileType(const Common::UString &path, FileType type);
+	Common::UString addFileType(const Common::UString &path, FileType type) const;
 	/** Return the file name with a swapped extensions according to the specified file type. */
-	Common::UString setFileType(const Common::UString &path, FileType type);
+	Common::UString setFileType(const Common::UString &path, FileType type) const;
 
 
 private:
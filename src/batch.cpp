@@ -0,0 +1,173 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Converting many files in one process.
+ */
+
+#include <list>
+#include <set>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/filepath.h"
+#include "src/common/readfile.h"
+#include "src/common/encoding.h"
+#include "src/common/threadpool.h"
+
+#include "src/batch.h"
+
+static void collectDirectory(const Common::UString &directory, const Common::UString &outDir,
+                             const BatchFilter &filter, const BatchNamer &namer, BatchFiles &files) {
+
+	std::list<Common::UString> inFiles;
+	if (!Common::FilePath::getFiles(directory, inFiles, true))
+		throw Common::Exception("Failed to read directory \"%s\"", directory.c_str());
+
+	for (std::list<Common::UString>::const_iterator f = inFiles.begin(); f != inFiles.end(); ++f) {
+		if (filter && !filter(*f))
+			continue;
+
+		const Common::UString outFile = outDir.empty() ? *f : (outDir + "/" + Common::FilePath::relativize(directory, *f));
+
+		files.push_back({ *f, namer(outFile) });
+	}
+}
+
+static void collectList(const Common::UString &listFile, const Common::UString &outDir,
+                        const BatchNamer &namer, BatchFiles &files) {
+
+	Common::ReadFile list(listFile);
+
+	while (!list.eos()) {
+		Common::UString inFile = Common::readStringLine(list, Common::kEncodingUTF8);
+		inFile.trim();
+
+		if (inFile.empty() || inFile.beginsWith("#"))
+			continue;
+
+		Common::UString outFile = inFile;
+		if (!outDir.empty()) {
+			if (Common::FilePath::isAbsolute(inFile))
+				outFile = outDir + "/" + Common::FilePath::getFile(inFile);
+			else
+				outFile = outDir + "/" + inFile;
+		}
+
+		files.push_back({ inFile, namer(outFile) });
+	}
+}
+
+void collectBatchFiles(const Common::UString &source, const Common::UString &outDir,
+                       const BatchFilter &filter, const BatchNamer &namer, BatchFiles &files) {
+
+	if (Common::FilePath::isDirectory(source))
+		collectDirectory(source, outDir, filter, namer, files);
+	else
+		collectList(source, outDir, namer, files);
+
+	std::sort(files.begin(), files.end(), [](const BatchFile &a, const BatchFile &b) {
+		return a.inFile < b.inFile;
+	});
+
+	// Two inputs converted into the same output file would clobber each other
+	std::map<Common::UString, Common::UString> outFiles;
+	for (BatchFiles::const_iterator f = files.begin(); f != files.end(); ++f) {
+		std::pair<std::map<Common::UString, Common::UString>::const_iterator, bool> out =
+			outFiles.insert(std::make_pair(Common::FilePath::normalize(f->outFile), f->inFile));
+
+		if (!out.second)
+			throw Common::Exception("Both \"%s\" and \"%s\" would be converted to \"%s\"",
+			                        out.first->second.c_str(), f->inFile.c_str(), f->outFile.c_str());
+	}
+
+	// Create the output directories up front, so that the workers won't race each other doing it
+	std::set<Common::UString> outDirs;
+	for (BatchFiles::const_iterator f = files.begin(); f != files.end(); ++f) {
+		const Common::UString dir = Common::FilePath::getDirectory(f->outFile);
+		if (!dir.empty())
+			outDirs.insert(dir);
+	}
+
+	for (std::set<Common::UString>::const_iterator d = outDirs.begin(); d != outDirs.end(); ++d)
+		Common::FilePath::createDirectories(*d);
+}
+
+size_t runBatch(const BatchFiles &files, size_t threadCount, const BatchConverter &converter) {
+	std::atomic<size_t> next(0);
+	std::atomic<size_t> failed(0);
+
+	// Serializes the output, so that messages of different files don't interleave
+	std::mutex outputMutex;
+
+	Common::ThreadPool::Job worker = [&](size_t) {
+		for (size_t i = next++; i < files.size(); i = next++) {
+			const BatchFile &file = files[i];
+
+			// Convert into a temporary file, so that a failure never touches an existing output file
+			Common::UString tmpFile;
+
+			try {
+				tmpFile = Common::FilePath::getTemporaryFile(file.outFile);
+
+				converter({ file.inFile, tmpFile });
+
+				if (!Common::FilePath::renameFile(tmpFile, file.outFile))
+					throw Common::Exception("Failed to rename \"%s\" to \"%s\"", tmpFile.c_str(), file.outFile.c_str());
+
+				std::lock_guard<std::mutex> lock(outputMutex);
+				status("Converted \"%s\" to \"%s\"", file.inFile.c_str(), file.outFile.c_str());
+
+			} catch (...) {
+				failed++;
+
+				// Don't leave a half-written temporary file behind
+				if (!tmpFile.empty())
+					Common::FilePath::removeFile(tmpFile);
+
+				std::lock_guard<std::mutex> lock(outputMutex);
+				Common::exceptionDispatcherWarnAndIgnore(
+					Common::UString::format("Failed to convert \"%s\"", file.inFile.c_str()));
+			}
+		}
+	};
+
+	threadCount = std::min(Common::ThreadPool::getThreadCount(threadCount), std::max<size_t>(files.size(), 1));
+
+	if (threadCount <= 1) {
+		worker(0);
+	} else {
+		Common::ThreadPool pool(threadCount);
+
+		for (size_t i = 0; i < threadCount; i++)
+			pool.addJob(worker);
+
+		pool.wait();
+	}
+
+	status("Converted %u of %u files, %u failed",
+	       (uint)(files.size() - failed), (uint)files.size(), (uint)failed.load());
+
+	return failed.load();
+}
@@ -0,0 +1,83 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Converting many files in one process.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+#include <functional>
+
+#include "src/common/ustring.h"
+
+/** A single input file of a batch conversion, and where to write its output. */
+struct BatchFile {
+	Common::UString inFile;
+	Common::UString outFile;
+};
+
+typedef std::vector<BatchFile> BatchFiles;
+
+/** Does this input file take part in a batch conversion? */
+typedef std::function<bool(const Common::UString &)> BatchFilter;
+/** Create the output file name for an input file name. */
+typedef std::function<Common::UString(const Common::UString &)> BatchNamer;
+/** Convert a single file. Throws on failure. */
+typedef std::function<void(const BatchFile &)> BatchConverter;
+
+/** Collect the files of a batch conversion.
+ *
+ *  If source is a directory, all regular files within it (recursively) that
+ *  pass the filter are collected. Otherwise, source is read as a list file
+ *  with one input file per line. Empty lines and lines starting with '#' are
+ *  ignored.
+ *
+ *  The output files are placed into outDir, keeping the path of the input
+ *  file relative to the source directory, or the path as written in the list
+ *  file. If outDir is empty, the output files are placed next to the inputs.
+ *
+ *  The files are returned in sorted order, and all output directories are
+ *  created. If two input files would be converted into the same output file,
+ *  for example two absolute paths in a list file with the same file name, an
+ *  exception is thrown.
+ */
+void collectBatchFiles(const Common::UString &source, const Common::UString &outDir,
+                       const BatchFilter &filter, const BatchNamer &namer, BatchFiles &files);
+
+/** Run a converter over all files of a batch, on threadCount threads.
+ *
+ *  The conversions are independent: a file that fails to convert is reported
+ *  and then skipped. Once all files are done, a summary is printed.
+ *
+ *  The converter is passed a temporary file next to the output file to write
+ *  into. Only if the conversion succeeds, it is renamed over the output file,
+ *  so that a failed conversion never destroys an existing output file.
+ *
+ *  Any shared state the converter needs (like the LanguageManager) has to be
+ *  set up before calling this function.
+ *
+ *  @return The number of files that failed to convert.
+ */
+size_t runBatch(const BatchFiles &files, size_t threadCount, const BatchConverter &converter);
+
+#endif // BATCH_H
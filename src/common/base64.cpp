@@ -208,6 +208,30 @@ void encodeBase64(ReadStream &data, std::list<UString> &base64, size_t lineLengt
 		base64.pop_back();
 }
 
+size_t encodeBase64(const byte *data, size_t size, char *base64) {
+	char *start = base64;
+
+	for (; size >= 3; data += 3, size -= 3) {
+		const uint32_t code = (data[0] << 16) | (data[1] << 8) | data[2];
+
+		*base64++ = kBase64Char[(code >> 18) & 0x3F];
+		*base64++ = kBase64Char[(code >> 12) & 0x3F];
+		*base64++ = kBase64Char[(code >>  6) & 0x3F];
+		*base64++ = kBase64Char[ code        & 0x3F];
+	}
+
+	if (size > 0) {
+		const uint32_t code = (data[0] << 16) | ((size > 1) ? (data[1] << 8) : 0);
+
+		*base64++ = kBase64Char[(code >> 18) & 0x3F];
+		*base64++ = kBase64Char[(code >> 12) & 0x3F];
+		*base64++ = (size > 1) ? kBase64Char[(code >> 6) & 0x3F] : '=';
+		*base64++ = '=';
+	}
+
+	return base64 - start;
+}
+
 SeekableReadStream *decodeBase64(const UString &base64) {
 	const size_t dataLength = (countLength(base64) / 4) * 3;
 	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(dataLength);
@@ -23,11 +23,15 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include <memory>
 
+#include <boost/noncopyable.hpp>
+
 #include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/disposableptr.h"
 #include "src/common/memreadstream.h"
 #include "src/common/blowfish.h"
 
@@ -379,4 +383,133 @@ MemoryReadStream *decryptBlowfishEBC(SeekableReadStream &input, const std::vecto
 	return blowfishEBC(input, key, kModeDecrypt);
 }
 
+/** A stream decrypting Blowfish EBC encrypted data block by block, as it's read. */
+class BlowfishEBCDecryptStream : boost::noncopyable, public SeekableReadStream {
+public:
+	BlowfishEBCDecryptStream(SeekableReadStream *input, const std::vector<byte> &key, bool disposeInput) :
+		_input(input, false), _size(input->size()), _pos(0), _eos(false),
+		_cacheBegin(0), _cacheSize(0) {
+
+		if ((_size % kBlockSize) != 0)
+			throw Exception("Blowfish operates on blocks of 8 bytes (%u)", (uint) _size);
+
+		blowfishSetKey(_ctx, &key[0], key.size());
+
+		// Only take ownership once nothing can throw anymore
+		_input.setDisposable(disposeInput);
+	}
+
+	bool eos() const {
+		return _eos;
+	}
+
+	size_t pos() const {
+		return _pos;
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin) {
+		const size_t oldPos = _pos;
+		const size_t newPos = evalSeek(offset, whence, _pos, 0, _size);
+		if (newPos > _size)
+			throw Exception(kSeekError);
+
+		_pos = newPos;
+		_eos = false;
+
+		return oldPos;
+	}
+
+	size_t read(void *dataPtr, size_t dataSize) {
+		assert(dataPtr);
+
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		byte *data = static_cast<byte *>(dataPtr);
+		size_t left = dataSize;
+
+		while (left > 0) {
+			// Serve what we can out of the cache
+			if ((_pos >= _cacheBegin) && (_pos < (_cacheBegin + _cacheSize))) {
+				const size_t n = MIN(left, _cacheBegin + _cacheSize - _pos);
+
+				std::memcpy(data, _cache + (_pos - _cacheBegin), n);
+
+				data += n;
+				_pos += n;
+				left -= n;
+				continue;
+			}
+
+			// Big, block-aligned reads are decrypted straight into the output
+			if (((_pos % kBlockSize) == 0) && (left >= kCacheSize)) {
+				const size_t n = left - (left % kBlockSize);
+
+				decrypt(_pos, data, n);
+
+				data += n;
+				_pos += n;
+				left -= n;
+				continue;
+			}
+
+			fillCache(_pos);
+		}
+
+		return dataSize;
+	}
+
+private:
+	static const size_t kCacheSize = 64 * kBlockSize;
+
+	DisposablePtr<SeekableReadStream> _input;
+
+	BlowfishContext _ctx;
+
+	size_t _size;
+	size_t _pos;
+	bool _eos;
+
+	byte _cache[kCacheSize];
+	size_t _cacheBegin;
+	size_t _cacheSize;
+
+	void fillCache(size_t pos) {
+		_cacheBegin = pos - (pos % kBlockSize);
+		_cacheSize  = MIN(kCacheSize, _size - _cacheBegin);
+
+		decrypt(_cacheBegin, _cache, _cacheSize);
+	}
+
+	void decrypt(size_t pos, byte *data, size_t size) {
+		assert(((pos % kBlockSize) == 0) && ((size % kBlockSize) == 0));
+
+		_input->seek(pos);
+		if (_input->read(data, size) != size)
+			throw Exception(kReadError);
+
+		for (size_t i = 0; i < size; i += kBlockSize)
+			blowfishECB(_ctx, kModeDecrypt, data + i, data + i);
+	}
+};
+
+SeekableReadStream *decryptBlowfishEBCStream(SeekableReadStream *input, const std::vector<byte> &key,
+                                             bool disposeInput) {
+
+	assert(input);
+
+	DisposablePtr<SeekableReadStream> inputPtr(input, disposeInput);
+
+	BlowfishEBCDecryptStream *stream = new BlowfishEBCDecryptStream(input, key, disposeInput);
+	inputPtr.setDisposable(false);
+
+	return stream;
+}
+
 } // End of namespace Common
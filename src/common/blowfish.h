@@ -39,6 +39,21 @@ MemoryReadStream *encryptBlowfishEBC(SeekableReadStream &input, const std::vecto
 /** Decrypt the stream with the Blowfish algorithm in EBC mode. */
 MemoryReadStream *decryptBlowfishEBC(SeekableReadStream &input, const std::vector<byte> &key);
 
+/** Create a stream that decrypts the Blowfish EBC encrypted input on demand.
+ *
+ *  Unlike decryptBlowfishEBC(), this does not decrypt the whole input up front.
+ *  Only the blocks that are actually read are decrypted, going through a small
+ *  cache of recently decrypted blocks. The returned stream is seekable and
+ *  reads from the input stream at the positions it needs.
+ *
+ *  @param input        The encrypted input stream. Its size has to be a multiple of 8.
+ *  @param key          The key to decrypt with.
+ *  @param disposeInput Should the input stream be deleted together with the returned stream?
+ *  @return A stream of the decrypted data.
+ */
+SeekableReadStream *decryptBlowfishEBCStream(SeekableReadStream *input, const std::vector<byte> &key,
+                                             bool disposeInput = false);
+
 } // End of namespace Common
 
 #endif // COMMON_BLOWFISH_H
@@ -32,6 +32,7 @@
 #include <boost/scope_exit.hpp>
 
 #include "src/common/deflate.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 
@@ -63,7 +64,26 @@ static void initInflateZStream(z_stream &strm, int windowBits, size_t size, cons
 		throw Exception("Could not initialize zlib inflate: %s (%d)", zError(zResult), zResult);
 }
 
-static void initDeflateZStream(z_stream &strm, int windowBits, size_t size, const byte *data) {
+static int getZStrategy(DeflateStrategy strategy) {
+	switch (strategy) {
+		case kDeflateStrategyFiltered:
+			return Z_FILTERED;
+		case kDeflateStrategyHuffmanOnly:
+			return Z_HUFFMAN_ONLY;
+		case kDeflateStrategyRLE:
+			return Z_RLE;
+		case kDeflateStrategyFixed:
+			return Z_FIXED;
+		default:
+			break;
+	}
+
+	return Z_DEFAULT_STRATEGY;
+}
+
+static void initDeflateZStream(z_stream &strm, int windowBits, int level, DeflateStrategy strategy,
+                               size_t size, const byte *data) {
+
 	/* Initialize the zlib data stream for compression with our input data. */
 
 	strm.zalloc   = Z_NULL;
@@ -74,11 +94,11 @@ static void initDeflateZStream(z_stream &strm, int windowBits, size_t size, cons
 
 	int zResult = deflateInit2(
 			&strm,
-			Z_BEST_COMPRESSION,
+			level,
 			Z_DEFLATED,
 			windowBits,
 			9,
-			Z_DEFAULT_STRATEGY
+			getZStrategy(strategy)
 	);
 
 	if (zResult != Z_OK)
@@ -228,13 +248,19 @@ size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits,
 	return strm.total_out;
 }
 
-byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits, unsigned int frameSize) {
+byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits,
+                      int level, DeflateStrategy strategy, unsigned int frameSize) {
+
+	// Check before creating the zlib stream, which we'd otherwise end without ever initializing it
+	if ((level < kDeflateLevelNone) || (level > kDeflateLevelBest))
+		throw Exception("Invalid deflate compression level %d", level);
+
 	z_stream strm;
 	BOOST_SCOPE_EXIT( (&strm) ) {
 		deflateEnd(&strm);
 	} BOOST_SCOPE_EXIT_END
 
-	initDeflateZStream(strm, windowBits, inputSize, data);
+	initDeflateZStream(strm, windowBits, level, strategy, inputSize, data);
 
 	std::vector<std::unique_ptr<byte[]>> buffers;
 
@@ -246,32 +272,33 @@ byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, in
 		strm.avail_out = frameSize;
 		strm.next_out = buffers.back().get();
 
-		// Compress.
+		/* Compress. Even once all input has been consumed, zlib might still
+		 * hold back output, so keep going until the end of the stream. */
 		zResult = deflate(&strm, Z_FINISH);
 		if (zResult != Z_STREAM_END && zResult != Z_OK)
 			throw Exception("Failed to deflate: %s (%d)", zError(zResult), zResult);
-	} while (strm.avail_in != 0);
+	} while (zResult != Z_STREAM_END);
 
 	std::unique_ptr<byte[]> compressedData = std::make_unique<byte[]>(strm.total_out);
-	for (size_t i = 0; i < buffers.size(); ++i) {
-		if (i == buffers.size() - 1)
-			std::memcpy(compressedData.get() + i * frameSize, buffers[i].get(), strm.total_out % frameSize);
-		else
-			std::memcpy(compressedData.get() + i * frameSize, buffers[i].get(), frameSize);
-	}
+	for (size_t i = 0; i < buffers.size(); ++i)
+		std::memcpy(compressedData.get() + i * frameSize, buffers[i].get(),
+		            MIN<size_t>(frameSize, strm.total_out - i * frameSize));
 
 	outputSize = strm.total_out;
 
 	return compressedData.release();
 }
 
-SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int windowBits, unsigned int frameSize) {
+SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int windowBits,
+                                    int level, DeflateStrategy strategy, unsigned int frameSize) {
+
 	std::unique_ptr<byte[]> uncompressedData = std::make_unique<byte[]>(inputSize);
 	if (input.read(uncompressedData.get(), inputSize) != inputSize)
 		throw Exception(kReadError);
 
 	size_t size = 0;
-	byte *decompressedData = compressDeflate(uncompressedData.get(), inputSize, size, windowBits, frameSize);
+	byte *decompressedData = compressDeflate(uncompressedData.get(), inputSize, size, windowBits,
+	                                         level, strategy, frameSize);
 
 	return new MemoryReadStream(decompressedData, size, true);
 }
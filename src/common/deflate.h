@@ -41,6 +41,22 @@ class SeekableReadStream;
 static const int kWindowBitsMax    =  15;
 static const int kWindowBitsMaxRaw = -kWindowBitsMax;
 
+/** Store the data in uncompressed DEFLATE blocks. */
+static const int kDeflateLevelNone    = 0;
+/** Compress as fast as possible. */
+static const int kDeflateLevelFastest = 1;
+/** Compress as well as possible. */
+static const int kDeflateLevelBest    = 9;
+
+/** The strategy zlib uses to compress. See the zlib documentation on deflateInit2(). */
+enum DeflateStrategy {
+	kDeflateStrategyDefault,     ///< For normal data.
+	kDeflateStrategyFiltered,    ///< For data produced by a filter or predictor.
+	kDeflateStrategyHuffmanOnly, ///< Only Huffman encoding, no string matching.
+	kDeflateStrategyRLE,         ///< Only match distances of one (run-length encoding).
+	kDeflateStrategyFixed        ///< No dynamic Huffman codes.
+};
+
 /** Decompress (inflate) using zlib's DEFLATE algorithm.
  *
  *  @param  data       The compressed input data.
@@ -124,10 +140,14 @@ size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits, byte *o
  *  @param windowBits The base two logarithm of the window size (the size of
  *                    the history buffer). See the zlib documentation on
  *                    deflateInit2() for details.
+ *  @param level      The compression level, from kDeflateLevelNone to kDeflateLevelBest.
+ *  @param strategy   The strategy to compress with.
  *  @param frameSize  The size of a frame for reading from the input stream.
  *  @return A stream of compressed data.
  */
 SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int windowBits,
+                                    int level = kDeflateLevelBest,
+                                    DeflateStrategy strategy = kDeflateStrategyDefault,
                                     unsigned int frameSize = 4096);
 
 /** Compress (deflate) using zlib's DEFLATE algorithm.
@@ -138,10 +158,13 @@ SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int win
  *  @param windowBits The base two logarithm of the window size (the size of
  *                    the history buffer). See the zlib documentation on
  *                    deflateInit2() for details.
+ *  @param level      The compression level, from kDeflateLevelNone to kDeflateLevelBest.
+ *  @param strategy   The strategy to compress with.
  *  @param frameSize  The size of a frame for reading from the input stream.
  *  @return A stream of compressed data.
  */
 byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits,
+                      int level = kDeflateLevelBest, DeflateStrategy strategy = kDeflateStrategyDefault,
                       unsigned int frameSize = 4096);
 
 } // End of namespace Common
@@ -27,8 +27,12 @@
 
 #include <iconv.h>
 
+#include <string>
 #include <vector>
 #include <memory>
+#include <utility>
+
+#include <boost/noncopyable.hpp>
 
 #include "src/common/encoding.h"
 #include "src/common/encoding_strings.h"
@@ -57,31 +61,41 @@ static const size_t kTerminatorLength  [kEncodingMAX] = {
 	1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1
 };
 
-/** A manager handling string encoding conversions. */
+/** A manager handling string encoding conversions.
+ *
+ *  iconv contexts carry conversion state, so they can't be shared between
+ *  threads. Every thread that converts strings gets its own set of contexts,
+ *  opened on first use, and closed again when the thread exits. Conversions
+ *  in different threads therefore never wait on each other.
+ */
 class ConversionManager : public Singleton<ConversionManager> {
 public:
 	ConversionManager() {
+		// Find out which conversions iconv supports at all, warning once
 		for (size_t i = 0; i < kEncodingMAX; i++) {
-			_contextFrom[i] = (iconv_t) -1;
-			_contextTo  [i] = (iconv_t) -1;
-		}
+			_supportFrom[i] = _supportTo[i] = false;
 
-		for (size_t i = 0; i < kEncodingMAX; i++)
-			if ((_contextFrom[i] = iconv_open("UTF-8", kEncodingName[i])) == ((iconv_t) -1))
+			iconv_t ctx;
+			if ((ctx = iconv_open("UTF-8", kEncodingName[i])) == ((iconv_t) -1))
 				warning("Failed to initialize %s -> UTF-8 conversion: %s", kEncodingName[i], strerror(errno));
+			else {
+				_supportFrom[i] = true;
+				iconv_close(ctx);
+			}
+		}
 
-		for (size_t i = 0; i < kEncodingMAX; i++)
-			if ((_contextTo  [i] = iconv_open(kEncodingName[i], "UTF-8")) == ((iconv_t) -1))
+		for (size_t i = 0; i < kEncodingMAX; i++) {
+			iconv_t ctx;
+			if ((ctx = iconv_open(kEncodingName[i], "UTF-8")) == ((iconv_t) -1))
 				warning("Failed to initialize UTF-8 -> %s conversion: %s", kEncodingName[i], strerror(errno));
+			else {
+				_supportTo[i] = true;
+				iconv_close(ctx);
+			}
+		}
 	}
 
 	~ConversionManager() {
-		for (size_t i = 0; i < kEncodingMAX; i++) {
-			if (_contextFrom[i] != ((iconv_t) -1))
-				iconv_close(_contextFrom[i]);
-			if (_contextTo  [i] != ((iconv_t) -1))
-				iconv_close(_contextTo  [i]);
-		}
 	}
 
 	bool hasSupportTranscode(Encoding from, Encoding to) {
@@ -90,19 +104,42 @@ public:
 			return false;
 
 		if (from == kEncodingUTF8)
-			return _contextTo[to] != ((iconv_t) -1);
+			return _supportTo[to];
 
 		if (to == kEncodingUTF8)
-			return _contextFrom[from] != ((iconv_t) -1);
+			return _supportFrom[from];
 
 		return false;
 	}
 
-	UString convert(Encoding encoding, byte *data, size_t n) {
+	UString convert(Encoding encoding, const byte *data, size_t n) {
+		if (((size_t) encoding) >= kEncodingMAX)
+			throw Exception("Invalid encoding %d", encoding);
+
+		return convert(getContextFrom(encoding), const_cast<byte *>(data), n, kEncodingGrowthFrom[encoding], 1);
+	}
+
+	/** Convert raw data into UTF-8, without cutting it off at the first terminator. */
+	bool convert(Encoding encoding, const byte *data, size_t n, std::vector<byte> &dataOut) {
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
-		return convert(_contextFrom[encoding], data, n, kEncodingGrowthFrom[encoding], 1);
+		iconv_t ctx = getContextFrom(encoding);
+		if (ctx == ((iconv_t) -1))
+			return false;
+
+		dataOut.clear();
+		if (n == 0)
+			return true;
+
+		dataOut.resize(n * kEncodingGrowthFrom[encoding]);
+
+		size_t size;
+		if (!doConvert(ctx, const_cast<byte *>(data), n, dataOut.data(), dataOut.size(), size, false))
+			return false;
+
+		dataOut.resize(size);
+		return true;
 	}
 
 	MemoryReadStream *convert(Encoding encoding, const UString &str, bool terminate = true) {
@@ -112,21 +149,91 @@ public:
 		if (encoding == kEncodingASCII)
 			return clean7bitASCII(str, terminate);
 
-		return convert(_contextTo[encoding], str, kEncodingGrowthTo[encoding],
+		return convert(getContextTo(encoding), str, kEncodingGrowthTo[encoding],
+		               terminate ? kTerminatorLength[encoding] : 0);
+	}
+
+	bool convert(Encoding encoding, const UString &str, std::vector<byte> &data, bool terminate = true) {
+		if (((size_t) encoding) >= kEncodingMAX)
+			throw Exception("Invalid encoding %d", encoding);
+
+		if (encoding == kEncodingASCII) {
+			clean7bitASCII(str, data, terminate);
+			return true;
+		}
+
+		return convert(getContextTo(encoding), str, data, kEncodingGrowthTo[encoding],
 		               terminate ? kTerminatorLength[encoding] : 0);
 	}
 
 private:
-	iconv_t _contextFrom[kEncodingMAX];
-	iconv_t _contextTo  [kEncodingMAX];
+	/** The iconv contexts of a single thread. */
+	class Contexts : boost::noncopyable {
+	public:
+		Contexts() {
+			for (size_t i = 0; i < kEncodingMAX; i++) {
+				_from[i] = (iconv_t) -1;
+				_to  [i] = (iconv_t) -1;
+			}
+		}
+
+		~Contexts() {
+			for (size_t i = 0; i < kEncodingMAX; i++) {
+				if (_from[i] != ((iconv_t) -1))
+					iconv_close(_from[i]);
+				if (_to  [i] != ((iconv_t) -1))
+					iconv_close(_to  [i]);
+			}
+		}
+
+		iconv_t getFrom(Encoding encoding) {
+			if (_from[encoding] == ((iconv_t) -1))
+				_from[encoding] = iconv_open("UTF-8", kEncodingName[encoding]);
+
+			return _from[encoding];
+		}
+
+		iconv_t getTo(Encoding encoding) {
+			if (_to[encoding] == ((iconv_t) -1))
+				_to[encoding] = iconv_open(kEncodingName[encoding], "UTF-8");
+
+			return _to[encoding];
+		}
+
+	private:
+		iconv_t _from[kEncodingMAX];
+		iconv_t _to  [kEncodingMAX];
+	};
+
+	bool _supportFrom[kEncodingMAX];
+	bool _supportTo  [kEncodingMAX];
+
+	static Contexts &getContexts() {
+		static thread_local Contexts contexts;
+
+		return contexts;
+	}
+
+	iconv_t getContextFrom(Encoding encoding) {
+		if (!_supportFrom[encoding])
+			return (iconv_t) -1;
+
+		return getContexts().getFrom(encoding);
+	}
+
+	iconv_t getContextTo(Encoding encoding) {
+		if (!_supportTo[encoding])
+			return (iconv_t) -1;
+
+		return getContexts().getTo(encoding);
+	}
 
-	byte *doConvert(iconv_t &ctx, byte *data, size_t nIn, size_t nOut, size_t &size) {
+	bool doConvert(iconv_t ctx, byte *data, size_t nIn, byte *dataOut, size_t nOut, size_t &size,
+	               bool warnOnFail = true) {
 		size_t inBytes  = nIn;
 		size_t outBytes = nOut;
 
-		std::unique_ptr<byte[]> convData = std::make_unique<byte[]>(outBytes);
-
-		byte *outBuf = convData.get();
+		byte *outBuf = dataOut;
 
 		// Reset the converter's state
 		iconv(ctx, 0, 0, 0, 0);
@@ -135,16 +242,26 @@ private:
 		if (iconv(ctx, const_cast<ICONV_CONST char **>(reinterpret_cast<char **>(&data)), &inBytes,
 		          reinterpret_cast<char **>(&outBuf), &outBytes) == ((size_t) -1)) {
 
-			warning("iconv() failed: %s", strerror(errno));
-			return 0;
+			if (warnOnFail)
+				warning("iconv() failed: %s", strerror(errno));
+			return false;
 		}
 
 		size = nOut - outBytes;
 
+		return true;
+	}
+
+	byte *doConvert(iconv_t ctx, byte *data, size_t nIn, size_t nOut, size_t &size) {
+		std::unique_ptr<byte[]> convData = std::make_unique<byte[]>(nOut);
+
+		if (!doConvert(ctx, data, nIn, convData.get(), nOut, size))
+			return 0;
+
 		return convData.release();
 	}
 
-	UString convert(iconv_t &ctx, byte *data, size_t n, size_t growth, size_t termSize) {
+	UString convert(iconv_t ctx, byte *data, size_t n, size_t growth, size_t termSize) {
 		if (ctx == ((iconv_t) -1))
 			return "[!!!]";
 
@@ -159,7 +276,7 @@ private:
 		return UString(reinterpret_cast<const char *>(dataOut.get()));
 	}
 
-	MemoryReadStream *convert(iconv_t &ctx, const UString &str, size_t growth, size_t termSize) {
+	MemoryReadStream *convert(iconv_t ctx, const UString &str, size_t growth, size_t termSize) {
 		if (ctx == ((iconv_t) -1))
 			return 0;
 
@@ -178,6 +295,31 @@ private:
 		return new MemoryReadStream(dataOut.release(), size, true);
 	}
 
+	bool convert(iconv_t ctx, const UString &str, std::vector<byte> &data, size_t growth, size_t termSize) {
+		if (ctx == ((iconv_t) -1))
+			return false;
+
+		byte  *dataIn = const_cast<byte *>(reinterpret_cast<const byte *>(str.c_str()));
+		size_t nIn    = std::strlen(str.c_str());
+		size_t nOut   = nIn * growth + termSize;
+
+		data.clear();
+
+		if (nIn > 0) {
+			data.resize(nOut);
+
+			size_t size;
+			if (!doConvert(ctx, dataIn, nIn, data.data(), nOut, size))
+				return false;
+
+			data.resize(size);
+		}
+
+		data.insert(data.end(), termSize, 0);
+
+		return true;
+	}
+
 	MemoryReadStream *clean7bitASCII(const UString &str, bool terminate) {
 		std::unique_ptr<byte[]> dataOut = std::make_unique<byte[]>(str.size() + (terminate ? 1 : 0));
 
@@ -191,6 +333,17 @@ private:
 
 		return new MemoryReadStream(dataOut.release(), size, true);
 	}
+
+	void clean7bitASCII(const UString &str, std::vector<byte> &data, bool terminate) {
+		data.clear();
+
+		for (UString::iterator c = str.begin(); c != str.end(); ++c)
+			if (UString::isASCII(*c))
+				data.push_back(*c);
+
+		if (terminate)
+			data.push_back('\0');
+	}
 };
 
 }
@@ -285,31 +438,221 @@ static void writeFakeChar(std::vector<byte> &output, uint32_t c, Encoding encodi
 	}
 }
 
-static UString createString(std::vector<byte> &output, Encoding encoding) {
-	if (output.empty())
+static const size_t kNoTerminator = SIZE_MAX;
+
+/** Find the first end-of-string terminator within the data.
+ *
+ *  Only whole code units of unitSize bytes are looked at. Returns the
+ *  offset of the terminator, or kNoTerminator if there is none.
+ */
+static size_t findTerminator(const byte *data, size_t size, size_t unitSize) {
+	if (unitSize == 1) {
+		const byte *terminator = static_cast<const byte *>(std::memchr(data, '\0', size));
+
+		return terminator ? (terminator - data) : kNoTerminator;
+	}
+
+	for (size_t i = 0; (i + 1) < size; i += 2)
+		if ((data[i] == 0) && (data[i + 1] == 0))
+			return i;
+
+	return kNoTerminator;
+}
+
+/** Does the data consist of only 7-bit ASCII code units?
+ *
+ *  ORs the data together a machine word at a time, and only checks the bits
+ *  that have to be clear once at the end. For single-byte encodings, that's
+ *  the high bit of every byte. For UTF-16, that's the high bit of the low
+ *  byte and all of the high byte of every code unit.
+ */
+static bool is7bitASCII(const byte *data, size_t size, Encoding encoding) {
+	byte maskBytes[8];
+	for (size_t i = 0; i < ARRAYSIZE(maskBytes); i++) {
+		const bool highByte = (encoding == kEncodingUTF16LE) ? ((i % 2) == 1) :
+		                      (encoding == kEncodingUTF16BE) ? ((i % 2) == 0) : false;
+
+		maskBytes[i] = highByte ? 0xFF : 0x80;
+	}
+
+	uint64_t mask;
+	std::memcpy(&mask, maskBytes, sizeof(mask));
+
+	uint64_t bits = 0;
+
+	size_t i = 0;
+	for (; (i + sizeof(bits)) <= size; i += sizeof(bits)) {
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+
+		bits |= word;
+	}
+
+	if (bits & mask)
+		return false;
+
+	for (; i < size; i++)
+		if (data[i] & maskBytes[i % 8])
+			return false;
+
+	return true;
+}
+
+/** Create a string out of 7-bit ASCII data in any of our encodings.
+ *
+ *  Every encoding we support is a superset of ASCII, so this needs no
+ *  conversion, only narrowing of UTF-16 code units.
+ */
+static UString create7bitString(const byte *data, size_t size, Encoding encoding) {
+	const size_t unitSize = kTerminatorLength[encoding];
+
+	size_t length = findTerminator(data, size, unitSize);
+	if (length == kNoTerminator)
+		length = size;
+
+	if (unitSize == 1)
+		return UString(reinterpret_cast<const char *>(data), length);
+
+	const size_t lowByte = (encoding == kEncodingUTF16BE) ? 1 : 0;
+
+	std::string str(length / 2, '\0');
+	for (size_t i = 0; i < str.size(); i++)
+		str[i] = data[i * 2 + lowByte];
+
+	return UString(str);
+}
+
+static UString createString(const byte *data, size_t size, Encoding encoding) {
+	if (size == 0)
 		return "";
 
 	switch (encoding) {
 		case kEncodingASCII:
 		case kEncodingUTF8:
-			output.push_back('\0');
-			return UString(reinterpret_cast<const char *>(&output[0]));
+			{
+				const byte *terminator = static_cast<const byte *>(std::memchr(data, '\0', size));
+
+				return UString(reinterpret_cast<const char *>(data), terminator ? (terminator - data) : size);
+			}
 
 		default:
-			return ConvMan.convert(encoding, &output[0], output.size());
+			// Plain 7-bit data reads the same in all encodings, so we can skip iconv
+			if ((((size_t) encoding) < kEncodingMAX) && ((size % kTerminatorLength[encoding]) == 0) &&
+			    is7bitASCII(data, size, encoding))
+				return create7bitString(data, size, encoding);
+
+			return ConvMan.convert(encoding, data, size);
 	}
 
 	return "";
 }
 
+/** Create strings out of data containing several end-of-string terminated strings.
+ *
+ *  The last string may lack its terminator. Plain 7-bit ASCII strings are
+ *  created directly, all others are converted together in a single iconv()
+ *  call. Only if that fails, they are converted one by one, so that the
+ *  failure is confined to the strings that caused it.
+ */
+static void createStrings(const byte *data, size_t size, Encoding encoding, std::vector<UString> &strings) {
+	const size_t unitSize = kTerminatorLength[encoding];
+
+	size -= size % unitSize;
+
+	std::vector<std::pair<size_t, size_t>> spans;
+	for (size_t pos = 0; pos < size; ) {
+		size_t length = findTerminator(data + pos, size - pos, unitSize);
+		if (length == kNoTerminator)
+			length = size - pos;
+
+		spans.push_back(std::make_pair(pos, length));
+		pos += length + unitSize;
+	}
+
+	const size_t first = strings.size();
+	strings.resize(first + spans.size());
+
+	const bool direct = (encoding == kEncodingASCII) || (encoding == kEncodingUTF8);
+
+	std::vector<size_t> pending;
+	for (size_t i = 0; i < spans.size(); i++) {
+		const byte  *str    = data + spans[i].first;
+		const size_t length = spans[i].second;
+
+		if (direct)
+			strings[first + i] = UString(reinterpret_cast<const char *>(str), length);
+		else if (is7bitASCII(str, length, encoding))
+			strings[first + i] = create7bitString(str, length, encoding);
+		else
+			pending.push_back(i);
+	}
+
+	if (pending.empty())
+		return;
+
+	// Gather the strings that need converting, each with its terminator
+	std::vector<byte> input;
+	for (std::vector<size_t>::const_iterator p = pending.begin(); p != pending.end(); ++p) {
+		input.insert(input.end(), data + spans[*p].first, data + spans[*p].first + spans[*p].second);
+		input.insert(input.end(), unitSize, 0);
+	}
+
+	std::vector<byte> utf8;
+	if (ConvMan.convert(encoding, input.data(), input.size(), utf8)) {
+		// Every terminator became a '\0' in UTF-8
+		size_t pos = 0;
+		for (std::vector<size_t>::const_iterator p = pending.begin(); (p != pending.end()) && (pos < utf8.size()); ++p) {
+			const byte *str        = utf8.data() + pos;
+			const byte *terminator = static_cast<const byte *>(std::memchr(str, '\0', utf8.size() - pos));
+			const size_t length    = terminator ? (terminator - str) : (utf8.size() - pos);
+
+			strings[first + *p] = UString(reinterpret_cast<const char *>(str), length);
+			pos += length + 1;
+		}
+
+		return;
+	}
+
+	for (std::vector<size_t>::const_iterator p = pending.begin(); p != pending.end(); ++p)
+		strings[first + *p] = createString(data + spans[*p].first, spans[*p].second, encoding);
+}
+
 UString readString(SeekableReadStream &stream, Encoding encoding) {
+	if (((size_t) encoding) >= kEncodingMAX)
+		return "";
+
+	const size_t unitSize = kTerminatorLength[encoding];
+
+	/* Read the stream in chunks and scan each for the terminator in bulk.
+	 * Most strings are short and end within the first chunk, so they're
+	 * created straight from it. Afterwards, we seek back to right behind
+	 * the terminator. */
+
+	byte chunk[256];
 	std::vector<byte> output;
 
-	uint32_t c;
-	while (((c = readFakeChar(stream, encoding)) != '\0') && !stream.eos())
-		writeFakeChar(output, c, encoding);
+	while (true) {
+		const size_t n = stream.read(chunk, sizeof(chunk));
+		const size_t length = findTerminator(chunk, n, unitSize);
+
+		if (length != kNoTerminator) {
+			stream.seek(((ptrdiff_t) (length + unitSize)) - ((ptrdiff_t) n), SeekableReadStream::kOriginCurrent);
 
-	return createString(output, encoding);
+			if (output.empty())
+				return createString(chunk, length, encoding);
+
+			output.insert(output.end(), chunk, chunk + length);
+			break;
+		}
+
+		// An incomplete code unit at the end of the stream is dropped
+		output.insert(output.end(), chunk, chunk + (n - (n % unitSize)));
+
+		if (n < sizeof(chunk))
+			break;
+	}
+
+	return createString(output.data(), output.size(), encoding);
 }
 
 UString readStringFixed(SeekableReadStream &stream, Encoding encoding, size_t length) {
@@ -322,7 +665,7 @@ UString readStringFixed(SeekableReadStream &stream, Encoding encoding, size_t le
 	length = stream.read(&output[0], length);
 	output.resize(length);
 
-	return createString(output, encoding);
+	return createString(output.data(), output.size(), encoding);
 }
 
 UString readStringLine(SeekableReadStream &stream, Encoding encoding) {
@@ -339,19 +682,69 @@ UString readStringLine(SeekableReadStream &stream, Encoding encoding) {
 		writeFakeChar(output, c, encoding);
 	}
 
-	return createString(output, encoding);
+	return createString(output.data(), output.size(), encoding);
 }
 
 UString readString(const byte *data, size_t size, Encoding encoding) {
-	if (size == 0)
-		return "";
+	return createString(data, size, encoding);
+}
 
-	std::vector<byte> output;
-	output.resize(size);
+void readStrings(SeekableReadStream &stream, Encoding encoding, size_t count, std::vector<UString> &strings) {
+	strings.clear();
+	if (count == 0)
+		return;
+
+	if (((size_t) encoding) >= kEncodingMAX) {
+		strings.resize(count);
+		return;
+	}
+
+	const size_t unitSize  = kTerminatorLength[encoding];
+	const size_t kChunkSize = 4096;
+
+	// Read chunks until we've seen count terminators, or the stream ends
+
+	std::vector<byte> data;
 
-	std::memcpy(&output[0], data, size);
+	size_t found = 0, end = 0;
+	while (found < count) {
+		const size_t oldSize = data.size();
 
-	return createString(output, encoding);
+		data.resize(oldSize + kChunkSize);
+		const size_t n = stream.read(data.data() + oldSize, kChunkSize);
+		data.resize(oldSize + n);
+
+		while (found < count) {
+			const size_t length = findTerminator(data.data() + end, data.size() - end, unitSize);
+			if (length == kNoTerminator)
+				break;
+
+			end += length + unitSize;
+			found++;
+		}
+
+		if (n < kChunkSize)
+			break;
+	}
+
+	if (found == count)
+		stream.seek(((ptrdiff_t) end) - ((ptrdiff_t) data.size()), SeekableReadStream::kOriginCurrent);
+	else
+		end = data.size();
+
+	createStrings(data.data(), end, encoding, strings);
+
+	// Strings past the end of the stream are empty
+	strings.resize(count);
+}
+
+void readStrings(const byte *data, size_t size, Encoding encoding, std::vector<UString> &strings) {
+	strings.clear();
+
+	if (((size_t) encoding) >= kEncodingMAX)
+		throw Exception("Invalid encoding %d", encoding);
+
+	createStrings(data, size, encoding, strings);
 }
 
 size_t writeString(WriteStream &stream, const UString &str, Encoding encoding, bool terminate) {
@@ -381,6 +774,62 @@ MemoryReadStream *convertString(const UString &str, Encoding encoding, bool term
 	return ConvMan.convert(encoding, str, terminateString);
 }
 
+/** Encode a string as UTF-16, without going through iconv.
+ *
+ *  Returns false if the string contains a codepoint that can't be represented
+ *  in UTF-16, so that the caller can let iconv decide what to do with it.
+ */
+static bool convertStringUTF16(const UString &str, std::vector<byte> &data, bool bigEndian, bool terminate) {
+	data.clear();
+	data.reserve(str.size() * 2 + (terminate ? 2 : 0));
+
+	byte unit[2];
+	auto writeUnit = [&](uint16_t u) {
+		if (bigEndian)
+			WRITE_BE_UINT16(unit, u);
+		else
+			WRITE_LE_UINT16(unit, u);
+
+		data.push_back(unit[0]);
+		data.push_back(unit[1]);
+	};
+
+	for (UString::iterator it = str.begin(); it != str.end(); ++it) {
+		const uint32_t c = *it;
+
+		if (((c >= 0xD800) && (c <= 0xDFFF)) || (c > 0x10FFFF))
+			return false;
+
+		if (c < 0x10000) {
+			writeUnit(c);
+			continue;
+		}
+
+		writeUnit(0xD800 + ((c - 0x10000) >> 10));
+		writeUnit(0xDC00 + ((c - 0x10000) & 0x3FF));
+	}
+
+	if (terminate)
+		writeUnit(0);
+
+	return true;
+}
+
+bool convertString(const UString &str, Encoding encoding, std::vector<byte> &data, bool terminateString) {
+	if (encoding == kEncodingUTF8) {
+		const byte *utf8 = reinterpret_cast<const byte *>(str.c_str());
+
+		data.assign(utf8, utf8 + std::strlen(str.c_str()) + (terminateString ? 1 : 0));
+		return true;
+	}
+
+	if ((encoding == kEncodingUTF16LE) || (encoding == kEncodingUTF16BE))
+		if (convertStringUTF16(str, data, encoding == kEncodingUTF16BE, terminateString))
+			return true;
+
+	return ConvMan.convert(encoding, str, data, terminateString);
+}
+
 size_t getBytesPerCodepoint(Encoding encoding) {
 	switch (encoding) {
 		case kEncodingASCII:
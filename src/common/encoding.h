@@ -27,6 +27,8 @@
 
 #include <cstddef>
 
+#include <vector>
+
 #include "src/common/types.h"
 
 namespace Common {
@@ -104,6 +106,25 @@ UString readStringLine(SeekableReadStream &stream, Encoding encoding);
  */
 UString readString(const byte *data, size_t size, Encoding encoding);
 
+/** Read count consecutive strings with the given encoding out of a stream.
+ *
+ *  Each string ends with an end-of-string terminating sequence, like with
+ *  readString(). The strings are read in bulk and converted all at once,
+ *  which is a lot faster than calling readString() count times. The stream
+ *  is left right behind the last string's terminator.
+ *
+ *  Strings past the end of the stream are returned empty.
+ */
+void readStrings(SeekableReadStream &stream, Encoding encoding, size_t count, std::vector<UString> &strings);
+
+/** Read all strings with the given encoding from the raw buffer.
+ *
+ *  The buffer contains strings that each end with an end-of-string terminating
+ *  sequence, except for the last one, where it's optional. The strings are
+ *  converted all at once.
+ */
+void readStrings(const byte *data, size_t size, Encoding encoding, std::vector<UString> &strings);
+
 /** Write a string into a stream with a given encoding.
  *
  *  @param  stream The stream to write into.
@@ -137,6 +158,20 @@ void writeStringFixed(WriteStream &stream, const Common::UString &str, Encoding
  */
 MemoryReadStream *convertString(const UString &str, Encoding encoding, bool terminateString = true);
 
+/** Convert a string into the given encoding, into a buffer.
+ *
+ *  The previous contents of the buffer are replaced. Converting many strings
+ *  into the same buffer avoids allocating memory for each of them.
+ *
+ *  @param  str The string to convert.
+ *  @param  encoding The encoding to convert the string into.
+ *  @param  data The buffer to convert the string into.
+ *  @param  terminateString Should the result contain a terminating end-of-
+ *                          string sequence?
+ *  @return false if the string could not be converted.
+ */
+bool convertString(const UString &str, Encoding encoding, std::vector<byte> &data, bool terminateString = true);
+
 /** Return the number of bytes per codepoint in this encoding.
  *
  *  Note: This will throw on encodings with a variable number of bytes per codepoint.
@@ -40,8 +40,11 @@ using boost::filesystem::exists;
 using boost::filesystem::is_regular_file;
 using boost::filesystem::is_directory;
 using boost::filesystem::file_size;
+using boost::filesystem::last_write_time;
 using boost::filesystem::directory_iterator;
+using boost::filesystem::recursive_directory_iterator;
 using boost::filesystem::create_directories;
+using boost::filesystem::unique_path;
 
 // boost-string_algo
 using boost::equals;
@@ -78,6 +81,20 @@ size_t FilePath::getFileSize(const UString &p) {
 	return size;
 }
 
+std::time_t FilePath::getModificationTime(const UString &p) {
+	std::time_t modificationTime = (std::time_t) -1;
+
+	try {
+		modificationTime = last_write_time(p.c_str());
+	} catch (...) {
+	}
+
+	if (modificationTime == ((std::time_t) -1))
+		warning("Failed to get modification time of file \"%s\"", p.c_str());
+
+	return modificationTime;
+}
+
 UString FilePath::getFile(const UString &p) {
 	path file(p.c_str());
 
@@ -340,6 +357,29 @@ UString FilePath::findSubDirectory(const UString &directory, const UString &subD
 	return curDir;
 }
 
+bool FilePath::getFiles(const UString &directory, std::list<UString> &files, bool recursive) {
+	path dirPath(directory.c_str());
+
+	try {
+		if (recursive) {
+			recursive_directory_iterator itEnd;
+			for (recursive_directory_iterator itDir(dirPath); itDir != itEnd; ++itDir)
+				if (is_regular_file(itDir->status()))
+					files.push_back(itDir->path().generic_string());
+
+		} else {
+			directory_iterator itEnd;
+			for (directory_iterator itDir(dirPath); itDir != itEnd; ++itDir)
+				if (is_regular_file(itDir->status()))
+					files.push_back(itDir->path().generic_string());
+		}
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
 bool FilePath::createDirectories(const UString &path) {
 	try {
 		return create_directories(path.c_str());
@@ -348,6 +388,33 @@ bool FilePath::createDirectories(const UString &path) {
 	}
 }
 
+UString FilePath::getTemporaryFile(const UString &p) {
+	UString file;
+
+	try {
+		do {
+			file = p + "." + unique_path("%%%%-%%%%.tmp").generic_string();
+		} while (exists(file.c_str()));
+	} catch (std::exception &se) {
+		throw Exception(se);
+	}
+
+	return file;
+}
+
+bool FilePath::renameFile(const UString &from, const UString &to) {
+	boost::system::error_code error;
+	boost::filesystem::rename(from.c_str(), to.c_str(), error);
+
+	return !error;
+}
+
+bool FilePath::removeFile(const UString &p) {
+	boost::system::error_code error;
+
+	return boost::filesystem::remove(p.c_str(), error) && !error;
+}
+
 UString FilePath::escapeStringLiteral(const UString &str) {
 	const std::regex esc("[\\^\\.\\$\\|\\(\\)\\[\\]\\*\\+\\?\\/\\\\]");
 	const std::string rep("\\$&");
@@ -25,6 +25,8 @@
 #ifndef COMMON_FILEPATH_H
 #define COMMON_FILEPATH_H
 
+#include <ctime>
+
 #include <list>
 
 #include "src/common/types.h"
@@ -58,6 +60,13 @@ public:
 	 */
 	static size_t getFileSize(const UString &p);
 
+	/** Return the time a file was last modified.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The modification time of the file or -1 if not a valid file.
+	 */
+	static std::time_t getModificationTime(const UString &p);
+
 	/** Return a file name without its path.
 	 *
 	 *  Example: "/path/to/file.ext" > "file.ext"
@@ -191,6 +200,16 @@ public:
 	 */
 	static bool getSubDirectories(const UString &directory, std::list<UString> &subDirectories);
 
+	/** Collect all regular files within a directory in a list.
+	 *
+	 *  @param  directory The directory in which to look.
+	 *  @param  files The list to add the files to.
+	 *  @param  recursive Should files in subdirectories be collected too?
+	 *  @return false if the specified path was not a directory or could not be searched;
+	 *          true otherwise.
+	 */
+	static bool getFiles(const UString &directory, std::list<UString> &files, bool recursive = false);
+
 	/** Create all directories in this path.
 	 *
 	 *  For example, if called on the path "/foo/bar/quux/", this will create
@@ -201,6 +220,25 @@ public:
 	 */
 	static bool createDirectories(const UString &path);
 
+	/** Return the name of a file next to the given one that doesn't exist yet.
+	 *
+	 *  The name is the given file name with a random suffix appended, for
+	 *  example "/foo/bar.txt.3f2a-91c7.tmp" for "/foo/bar.txt".
+	 */
+	static UString getTemporaryFile(const UString &p);
+
+	/** Rename a file, replacing the target if it already exists.
+	 *
+	 *  @return true if the file was renamed.
+	 */
+	static bool renameFile(const UString &from, const UString &to);
+
+	/** Remove a file, if it exists.
+	 *
+	 *  @return true if the file was removed.
+	 */
+	static bool removeFile(const UString &p);
+
 	/** Escape a string literal for use in a regexp. */
 	static UString escapeStringLiteral(const UString &str);
 
@@ -25,12 +25,11 @@
 #ifndef COMMON_HASH_H
 #define COMMON_HASH_H
 
-#include <memory>
+#include <vector>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/encoding.h"
-#include "src/common/memreadstream.h"
 
 namespace Common {
 
@@ -58,19 +57,28 @@ static inline uint32_t hashStringDJB2(const UString &string) {
 	return hash;
 }
 
-static inline uint32_t hashStringDJB2(const UString &string, Encoding encoding) {
+static inline uint32_t hashDataDJB2(const byte *data, size_t size) {
 	uint32_t hash = 5381;
 
-	std::unique_ptr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32_t c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashDJB2(hash, c);
+	for (size_t i = 0; i < size; i++)
+		hash = hashDJB2(hash, data[i]);
 
 	return hash;
 }
+
+/** Hash the string as a series of bytes in the given encoding, using buffer to hold the bytes. */
+static inline uint32_t hashStringDJB2(const UString &string, Encoding encoding, std::vector<byte> &buffer) {
+	if (!convertString(string, encoding, buffer, false))
+		return 5381;
+
+	return hashDataDJB2(buffer.data(), buffer.size());
+}
+
+static inline uint32_t hashStringDJB2(const UString &string, Encoding encoding) {
+	std::vector<byte> buffer;
+
+	return hashStringDJB2(string, encoding, buffer);
+}
 // '--- djb2 hash function by Daniel J. Bernstein ---'
 
 // .--- 32bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---.
@@ -87,19 +95,28 @@ static inline uint32_t hashStringFNV32(const UString &string) {
 	return hash;
 }
 
-static inline uint32_t hashStringFNV32(const UString &string, Encoding encoding) {
+static inline uint32_t hashDataFNV32(const byte *data, size_t size) {
 	uint32_t hash = 0x811C9DC5;
 
-	std::unique_ptr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32_t c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashFNV32(hash, c);
+	for (size_t i = 0; i < size; i++)
+		hash = hashFNV32(hash, data[i]);
 
 	return hash;
 }
+
+/** Hash the string as a series of bytes in the given encoding, using buffer to hold the bytes. */
+static inline uint32_t hashStringFNV32(const UString &string, Encoding encoding, std::vector<byte> &buffer) {
+	if (!convertString(string, encoding, buffer, false))
+		return 0x811C9DC5;
+
+	return hashDataFNV32(buffer.data(), buffer.size());
+}
+
+static inline uint32_t hashStringFNV32(const UString &string, Encoding encoding) {
+	std::vector<byte> buffer;
+
+	return hashStringFNV32(string, encoding, buffer);
+}
 // '--- 32bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---'
 
 // .--- 64bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---.
@@ -116,19 +133,28 @@ static inline uint64_t hashStringFNV64(const UString &string) {
 	return hash;
 }
 
-static inline uint64_t hashStringFNV64(const UString &string, Encoding encoding) {
+static inline uint64_t hashDataFNV64(const byte *data, size_t size) {
 	uint64_t hash = 0xCBF29CE484222325LL;
 
-	std::unique_ptr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32_t c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashFNV64(hash, c);
+	for (size_t i = 0; i < size; i++)
+		hash = hashFNV64(hash, data[i]);
 
 	return hash;
 }
+
+/** Hash the string as a series of bytes in the given encoding, using buffer to hold the bytes. */
+static inline uint64_t hashStringFNV64(const UString &string, Encoding encoding, std::vector<byte> &buffer) {
+	if (!convertString(string, encoding, buffer, false))
+		return 0xCBF29CE484222325LL;
+
+	return hashDataFNV64(buffer.data(), buffer.size());
+}
+
+static inline uint64_t hashStringFNV64(const UString &string, Encoding encoding) {
+	std::vector<byte> buffer;
+
+	return hashStringFNV64(string, encoding, buffer);
+}
 // '--- 64bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---'
 
 /* .--- CRC32, based on the implementation by Gary S. Brown ---.
@@ -200,19 +226,28 @@ static inline uint32_t hashStringCRC32(const UString &string) {
 	return hash ^ 0xFFFFFFFF;
 }
 
-static inline uint32_t hashStringCRC32(const UString &string, Encoding encoding) {
+static inline uint32_t hashDataCRC32(const byte *data, size_t size) {
 	uint32_t hash = 0xFFFFFFFF;
 
-	std::unique_ptr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32_t c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashCRC32(hash, c);
+	for (size_t i = 0; i < size; i++)
+		hash = hashCRC32(hash, data[i]);
 
 	return hash ^ 0xFFFFFFFF;
 }
+
+/** Hash the string as a series of bytes in the given encoding, using buffer to hold the bytes. */
+static inline uint32_t hashStringCRC32(const UString &string, Encoding encoding, std::vector<byte> &buffer) {
+	if (!convertString(string, encoding, buffer, false))
+		return 0xFFFFFFFF;
+
+	return hashDataCRC32(buffer.data(), buffer.size());
+}
+
+static inline uint32_t hashStringCRC32(const UString &string, Encoding encoding) {
+	std::vector<byte> buffer;
+
+	return hashStringCRC32(string, encoding, buffer);
+}
 // '--- CRC32, based on the implementation by Gary S. Brown ---'
 
 /** Hash the string with the given algorithm, as a series of UTF-8 characters. */
@@ -237,20 +272,54 @@ static inline uint64_t hashString(const UString &string, HashAlgo algo) {
 	return 0;
 }
 
+/** Hash the string with the given algorithm, as a series of bytes in the given encoding.
+ *
+ *  The buffer is used to hold the encoded bytes. Reusing it across calls saves
+ *  allocating memory for every string.
+ */
+static inline uint64_t hashString(const UString &string, HashAlgo algo, Encoding encoding,
+                                  std::vector<byte> &buffer) {
+	switch (algo) {
+		case kHashDJB2:
+			return hashStringDJB2(string, encoding, buffer);
+
+		case kHashFNV32:
+			return hashStringFNV32(string, encoding, buffer);
+
+		case kHashFNV64:
+			return hashStringFNV64(string, encoding, buffer);
+
+		case kHashCRC32:
+			return hashStringCRC32(string, encoding, buffer);
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
 /** Hash the string with the given algorithm, as a series of bytes in the given encoding. */
 static inline uint64_t hashString(const UString &string, HashAlgo algo, Encoding encoding) {
+	std::vector<byte> buffer;
+
+	return hashString(string, algo, encoding, buffer);
+}
+
+/** Hash a buffer of bytes with the given algorithm. */
+static inline uint64_t hashData(const byte *data, size_t size, HashAlgo algo) {
 	switch (algo) {
 		case kHashDJB2:
-			return hashStringDJB2(string, encoding);
+			return hashDataDJB2(data, size);
 
 		case kHashFNV32:
-			return hashStringFNV32(string, encoding);
+			return hashDataFNV32(data, size);
 
 		case kHashFNV64:
-			return hashStringFNV64(string, encoding);
+			return hashDataFNV64(data, size);
 
 		case kHashCRC32:
-			return hashStringCRC32(string, encoding);
+			return hashDataCRC32(data, size);
 
 		default:
 			break;
@@ -259,6 +328,32 @@ static inline uint64_t hashString(const UString &string, HashAlgo algo, Encoding
 	return 0;
 }
 
+/** Hash many strings with the given algorithm, as series of UTF-8 characters.
+ *
+ *  hashes[i] will be the hash of strings[i].
+ */
+static inline void hashStrings(const std::vector<UString> &strings, HashAlgo algo, std::vector<uint64_t> &hashes) {
+	hashes.resize(strings.size());
+
+	for (size_t i = 0; i < strings.size(); i++)
+		hashes[i] = hashString(strings[i], algo);
+}
+
+/** Hash many strings with the given algorithm, as series of bytes in the given encoding.
+ *
+ *  hashes[i] will be the hash of strings[i]. All strings are encoded into the
+ *  same buffer, so this is a lot cheaper than hashing them one by one.
+ */
+static inline void hashStrings(const std::vector<UString> &strings, HashAlgo algo, Encoding encoding,
+                               std::vector<uint64_t> &hashes) {
+
+	hashes.resize(strings.size());
+
+	std::vector<byte> buffer;
+	for (size_t i = 0; i < strings.size(); i++)
+		hashes[i] = hashString(strings[i], algo, encoding, buffer);
+}
+
 static inline UString formatHash(uint64_t hash) {
 	return UString::format("0x%04X%04X%04X%04X",
 			(uint) ((hash >> 48) & 0xFFFF),
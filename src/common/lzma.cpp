@@ -132,9 +132,13 @@ SeekableReadStream *decompressLZMA1(ReadStream &input, size_t inputSize, size_t
 	return new MemoryReadStream(outputData, outputSize, true);
 }
 
-SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize) {
+byte *compressLZMA1(const byte *data, size_t inputSize, size_t &outputSize, uint level, bool extreme) {
+	if (level > kLZMALevelBest)
+		throw Exception("Invalid LZMA1 compression level %u", level);
+
 	lzma_options_lzma opt_lzma;
-	lzma_lzma_preset(&opt_lzma, LZMA_PRESET_DEFAULT);
+	if (lzma_lzma_preset(&opt_lzma, level | (extreme ? LZMA_PRESET_EXTREME : 0)))
+		throw Exception("Unsupported LZMA1 compression level %u", level);
 
 	lzma_filter filters[2] = {
 		{ LZMA_FILTER_LZMA1, &opt_lzma },
@@ -148,14 +152,13 @@ SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize) {
 	if (lzma_properties_size(&propsSize, &filters[0]) != LZMA_OK)
 		throw Exception("Can't get LZMA1 properties size");
 
-	byte *properties = new byte[propsSize];
-	if (lzma_properties_encode(&filters[0], properties) != LZMA_OK)
+	std::unique_ptr<byte[]> properties = std::make_unique<byte[]>(propsSize);
+	if (lzma_properties_encode(&filters[0], properties.get()) != LZMA_OK)
 		throw Exception("Failed to decode LZMA1 properties");
 
-	MemoryWriteStreamDynamic writeStream;
+	MemoryWriteStreamDynamic writeStream(true, propsSize + inputSize / 2);
 
-	writeStream.write(properties, propsSize);
-	delete[] properties;
+	writeStream.write(properties.get(), propsSize);
 
 	lzma_stream strm = LZMA_STREAM_INIT;
 	BOOST_SCOPE_EXIT( (&strm) ) {
@@ -167,31 +170,43 @@ SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize) {
 	if ((lzmaRet = lzma_raw_encoder(&strm, filters)) != LZMA_OK)
 		throw Exception("Failed to create raw LZMA1 encode: %d", (int) lzmaRet);
 
-	byte *data = new byte[inputSize];
-	input.read(data, inputSize);
-
 	strm.avail_in = inputSize;
 	strm.next_in = data;
 
+	/* With LZMA_FINISH, lzma_code() returns LZMA_OK for as long as there's
+	 * still output pending, even after all input has been consumed. */
+
 	byte outputData[4096];
 	do {
-		strm.avail_out = 4096;
+		strm.avail_out = sizeof(outputData);
 		strm.next_out = outputData;
 
 		lzmaRet = lzma_code(&strm, LZMA_FINISH);
 
-		writeStream.write(outputData, 4096 - strm.avail_out);
-	} while (strm.avail_in != 0 && lzmaRet != LZMA_OK);
-
-	delete[] data;
+		writeStream.write(outputData, sizeof(outputData) - strm.avail_out);
+	} while (lzmaRet == LZMA_OK);
 
-	if (lzmaRet == LZMA_OK)
-		throw Exception("Failed to compress LZMA1 data: premature end of output buffer");
+	if (lzmaRet != LZMA_STREAM_END)
+		throw Exception("Failed to compress LZMA1 data: %d", (int) lzmaRet);
 
 	if (strm.avail_in != 0)
 		throw Exception("Failed to compress LZMA1 data: input buffer not completely used");
 
-	return new MemoryReadStream(writeStream.getData(), writeStream.size(), true);
+	outputSize = writeStream.size();
+	writeStream.setDisposable(false);
+
+	return writeStream.getData();
+}
+
+SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize, uint level, bool extreme) {
+	std::unique_ptr<byte[]> inputData = std::make_unique<byte[]>(inputSize);
+	if (input.read(inputData.get(), inputSize) != inputSize)
+		throw Exception(kReadError);
+
+	size_t outputSize = 0;
+	byte *outputData = compressLZMA1(inputData.get(), inputSize, outputSize, level, extreme);
+
+	return new MemoryReadStream(outputData, outputSize, true);
 }
 
 } // End of namespace Common
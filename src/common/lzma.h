@@ -32,6 +32,11 @@ namespace Common {
 class ReadStream;
 class SeekableReadStream;
 
+/** The compression level LZMA uses by default. */
+static const uint kLZMALevelDefault = 6;
+/** The highest LZMA compression level. */
+static const uint kLZMALevelBest    = 9;
+
 /** Decompress using the LZMA1 algorithm.
  *
  *  @param  data       The compressed input data.
@@ -58,15 +63,30 @@ byte *decompressLZMA1(const byte *data, size_t inputSize, size_t outputSize, boo
  */
 SeekableReadStream *decompressLZMA1(ReadStream &input, size_t inputSize, size_t outputSize, bool noEndMarker = false);
 
+/**
+ * Compress using the LZMA1 algorithm.
+ *
+ * @param data       the uncompressed input data.
+ * @param inputSize  the size of the input data in bytes.
+ * @param outputSize a reference which will be filled with the compressed size.
+ * @param level      the compression preset, from 0 (fastest) to kLZMALevelBest.
+ * @param extreme    use the slower, "extreme" variant of the preset.
+ * @return The compressed data, prefixed by the encoded LZMA1 properties.
+ */
+byte *compressLZMA1(const byte *data, size_t inputSize, size_t &outputSize,
+                    uint level = kLZMALevelDefault, bool extreme = false);
+
 /**
  * Compress using the LZMA1 algorithm.
  *
  * @param input      the uncompressed input data.
  * @param inputSize  the size of the input data to read in bytes.
- * @param outputSize a reference which will be filled with the compressed size.
+ * @param level      the compression preset, from 0 (fastest) to kLZMALevelBest.
+ * @param extreme    use the slower, "extreme" variant of the preset.
  * @return A stream of the compressed data.
  */
-SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize);
+SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize,
+                                  uint level = kLZMALevelDefault, bool extreme = false);
 
 } // End of namespace Common
 
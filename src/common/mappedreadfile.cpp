@@ -0,0 +1,197 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/mappedreadfile.h"
+#include "src/common/memreadstream.h"
+#include "src/common/readfile.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+
+namespace Common {
+
+MappedReadFile::MappedReadFile() : _handle(0), _data(0), _size(kSizeInvalid), _pos(0), _eos(false) {
+}
+
+MappedReadFile::MappedReadFile(const UString &fileName) :
+	_handle(0), _data(0), _size(kSizeInvalid), _pos(0), _eos(false) {
+
+	if (!open(fileName))
+		throw Exception("Can't open file \"%s\"", fileName.c_str());
+}
+
+MappedReadFile::~MappedReadFile() {
+	close();
+}
+
+static long getFileSize(std::FILE *handle) {
+	if (std::fseek(handle, 0, SEEK_END) != 0)
+		return -1;
+
+	return std::ftell(handle);
+}
+
+bool MappedReadFile::open(const UString &fileName) {
+	close();
+
+	long fileSize = -1;
+	if (!(_handle  = Platform::openFile(fileName, Platform::kFileModeRead)) ||
+	    ((fileSize = getFileSize(_handle)) < 0)) {
+
+		close();
+		return false;
+	}
+
+	if ((uint64_t)((unsigned long)fileSize) > (uint64_t)0x7FFFFFFFULL) {
+		warning("MappedReadFile \"%s\" is too big", fileName.c_str());
+
+		close();
+		return false;
+	}
+
+	_size = (size_t)fileSize;
+
+	// Empty files can't be mapped, but there's nothing to read anyway
+	if ((_size > 0) && !(_data = Platform::mapFile(_handle, _size))) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedReadFile::close() {
+	Platform::unmapFile(_data, _size);
+
+	if (_handle)
+		std::fclose(_handle);
+
+	_handle = 0;
+	_data   = 0;
+	_size   = kSizeInvalid;
+	_pos    = 0;
+	_eos    = false;
+}
+
+bool MappedReadFile::isOpen() const {
+	return _handle != 0;
+}
+
+bool MappedReadFile::eos() const {
+	if (!_handle)
+		return true;
+
+	return _eos;
+}
+
+size_t MappedReadFile::pos() const {
+	if (!_handle)
+		return kPositionInvalid;
+
+	return _pos;
+}
+
+size_t MappedReadFile::size() const {
+	return _size;
+}
+
+size_t MappedReadFile::seek(ptrdiff_t offset, Origin whence) {
+	if (!_handle)
+		throw Exception(kSeekError);
+
+	const size_t oldPos = _pos;
+	const size_t newPos = evalSeek(offset, whence, _pos, 0, _size);
+	if (newPos > _size)
+		throw Exception(kSeekError);
+
+	_pos = newPos;
+	_eos = false;
+
+	return oldPos;
+}
+
+size_t MappedReadFile::read(void *dataPtr, size_t dataSize) {
+	if (!_handle)
+		return 0;
+
+	assert(dataPtr);
+
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	if (dataSize > 0)
+		std::memcpy(dataPtr, _data + _pos, dataSize);
+
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+size_t MappedReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (!_handle || (offset > _size))
+		return 0;
+
+	assert(dataPtr);
+
+	dataSize = MIN(dataSize, _size - offset);
+	if (dataSize > 0)
+		std::memcpy(dataPtr, _data + offset, dataSize);
+
+	return dataSize;
+}
+
+size_t MappedReadFile::copyAt(size_t offset, std::FILE *file, size_t dataSize) {
+	if (!_handle || (offset > _size))
+		return 0;
+
+	return Platform::copyFileRange(_handle, offset, file, MIN(dataSize, _size - offset));
+}
+
+SeekableReadStream *MappedReadFile::getSubStream(size_t begin, size_t end) {
+	if (!_handle || (begin > end) || (end > _size))
+		throw Exception(kSeekError);
+
+	return new MemoryReadStream(_data + begin, end - begin);
+}
+
+const byte *MappedReadFile::getData() const {
+	return _data;
+}
+
+SeekableReadStream *MappedReadFile::openFile(const UString &fileName) {
+	MappedReadFile *file = new MappedReadFile;
+	if (file->open(fileName))
+		return file;
+
+	delete file;
+	return new ReadFile(fileName);
+}
+
+} // End of namespace Common
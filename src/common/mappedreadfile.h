@@ -0,0 +1,103 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#ifndef COMMON_MAPPEDREADFILE_H
+#define COMMON_MAPPEDREADFILE_H
+
+#include <cstdio>
+#include <cstddef>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/readstream.h"
+
+namespace Common {
+
+class UString;
+
+/** A file reading class that maps the whole file into memory.
+ *
+ *  Reading is a plain memory copy out of the mapping, and getSubStream()
+ *  returns streams that point straight into the mapping. This allows
+ *  archives to hand out their uncompressed resources without copying them.
+ *
+ *  If the file can't be mapped, the MappedReadFile will fail to open.
+ */
+class MappedReadFile : boost::noncopyable, public SeekableReadStream {
+public:
+	MappedReadFile();
+	MappedReadFile(const UString &fileName);
+	~MappedReadFile();
+
+	/** Try to open and map the file with the given fileName.
+	 *
+	 *  @param  fileName the name of the file to open
+	 *  @return true if file was opened and mapped successfully, false otherwise
+	 */
+	bool open(const UString &fileName);
+
+	/** Unmap and close the file, if open. */
+	void close();
+
+	/** Checks if the object opened a file successfully.
+	 *
+	 *  @return true if any file is opened, false otherwise.
+	 */
+	bool isOpen() const;
+
+	bool eos() const;
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+	size_t read(void *dataPtr, size_t dataSize);
+
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	size_t copyAt(size_t offset, std::FILE *file, size_t dataSize);
+
+	/** Return a MemoryReadStream pointing into the mapping, without copying. */
+	SeekableReadStream *getSubStream(size_t begin, size_t end);
+
+	/** Return the mapped contents of the file. */
+	const byte *getData() const;
+
+	/** Open a file, mapped into memory if possible, as a plain ReadFile otherwise. */
+	static SeekableReadStream *openFile(const UString &fileName);
+
+
+private:
+	std::FILE *_handle; ///< The actual file handle.
+
+	const byte *_data;  ///< The mapped contents of the file.
+	size_t _size;       ///< The file's size.
+
+	size_t _pos;
+	bool _eos;
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDREADFILE_H
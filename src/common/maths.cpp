@@ -36,4 +36,24 @@ const int8_t intLog2Table256[256] = {
 };
 #endif
 
+double getEntropy(const byte *data, size_t size) {
+	if (size == 0)
+		return 0.0;
+
+	size_t counts[256] = { 0 };
+	for (size_t i = 0; i < size; i++)
+		counts[data[i]]++;
+
+	double entropy = 0.0;
+	for (size_t i = 0; i < 256; i++) {
+		if (counts[i] == 0)
+			continue;
+
+		const double p = static_cast<double>(counts[i]) / size;
+		entropy -= p * std::log2(p);
+	}
+
+	return entropy;
+}
+
 } // End of namespace Common
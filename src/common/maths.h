@@ -92,6 +92,14 @@ static inline float deg2rad(float deg) {
 	return deg * M_PI / 180.0f;
 }
 
+/** Return the Shannon entropy of the bytes in this data, in bits per byte.
+ *
+ *  This ranges from 0.0 (all bytes are the same) to 8.0 (all byte values
+ *  appear equally often), and is a cheap estimate of how well the data
+ *  could be compressed.
+ */
+double getEntropy(const byte *data, size_t size);
+
 } // End of namespace Common
 
 #endif // COMMON_MATHS_H
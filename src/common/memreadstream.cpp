@@ -101,6 +101,25 @@ size_t MemoryReadStream::size() const {
 	return _size;
 }
 
+size_t MemoryReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	assert(dataPtr);
+
+	if (offset > _size)
+		return 0;
+
+	dataSize = MIN(dataSize, _size - offset);
+	std::memcpy(dataPtr, _ptrOrig.get() + offset, dataSize);
+
+	return dataSize;
+}
+
+SeekableReadStream *MemoryReadStream::getSubStream(size_t begin, size_t end) {
+	if ((begin > end) || (end > _size))
+		throw Exception(kSeekError);
+
+	return new MemoryReadStream(_ptrOrig.get() + begin, end - begin);
+}
+
 const byte *MemoryReadStream::getData() const {
 	return _ptrOrig.get();
 }
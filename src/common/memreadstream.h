@@ -101,6 +101,11 @@ public:
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Return a MemoryReadStream pointing into this stream's memory, without copying. */
+	SeekableReadStream *getSubStream(size_t begin, size_t end);
+
 	const byte *getData() const;
 
 private:
@@ -31,9 +31,19 @@
 	#include <wchar.h>
 #endif
 
+#if defined(WIN32)
+	#include <io.h>
+#endif
+
 #if defined(UNIX)
 	#include <pwd.h>
 	#include <unistd.h>
+	#include <errno.h>
+	#include <sys/mman.h>
+#endif
+
+#if defined(HAVE_SYS_SENDFILE_H)
+	#include <sys/sendfile.h>
 #endif
 
 #include <cassert>
@@ -119,6 +129,194 @@ std::FILE *Platform::openFile(const UString &fileName, FileMode mode) {
 }
 // '--- openFile() ---'
 
+// .--- mapFile() ---.
+#if defined(WIN32)
+
+const byte *Platform::mapFile(std::FILE *file, size_t size) {
+	if (!file || (size == 0))
+		return 0;
+
+	HANDLE fileHandle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return 0;
+
+	HANDLE mapping = CreateFileMappingW(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mapping)
+		return 0;
+
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+
+	// The view keeps a reference to the mapping object
+	CloseHandle(mapping);
+
+	return static_cast<const byte *>(data);
+}
+
+void Platform::unmapFile(const byte *data, size_t UNUSED(size)) {
+	if (data)
+		UnmapViewOfFile(data);
+}
+
+#elif defined(UNIX)
+
+const byte *Platform::mapFile(std::FILE *file, size_t size) {
+	if (!file || (size == 0))
+		return 0;
+
+	void *data = mmap(0, size, PROT_READ, MAP_SHARED, fileno(file), 0);
+	if (data == MAP_FAILED)
+		return 0;
+
+	return static_cast<const byte *>(data);
+}
+
+void Platform::unmapFile(const byte *data, size_t size) {
+	if (data)
+		munmap(const_cast<byte *>(data), size);
+}
+
+#else
+
+const byte *Platform::mapFile(std::FILE *UNUSED(file), size_t UNUSED(size)) {
+	return 0;
+}
+
+void Platform::unmapFile(const byte *UNUSED(data), size_t UNUSED(size)) {
+}
+
+#endif
+// '--- mapFile() ---'
+
+// .--- readFileAt() ---.
+#if defined(UNIX)
+
+size_t Platform::readFileAt(std::FILE *file, size_t offset, void *data, size_t size) {
+	if (!file)
+		return 0;
+
+	const int fd = fileno(file);
+
+	size_t bytesRead = 0;
+	while (bytesRead < size) {
+		const ssize_t n = pread(fd, static_cast<byte *>(data) + bytesRead, size - bytesRead, offset + bytesRead);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if (n == 0)
+			break;
+
+		bytesRead += n;
+	}
+
+	return bytesRead;
+}
+
+#else
+
+/* On Windows, ReadFile() with an OVERLAPPED offset still moves the file
+ * pointer, which would confuse the C runtime's buffering of the FILE. */
+size_t Platform::readFileAt(std::FILE *UNUSED(file), size_t UNUSED(offset),
+                            void *UNUSED(data), size_t UNUSED(size)) {
+	return SIZE_MAX;
+}
+
+#endif
+// '--- readFileAt() ---'
+
+// .--- copyFileRange() ---.
+#if defined(UNIX)
+
+#if defined(HAVE_COPY_FILE_RANGE)
+static ssize_t copyFileRangeKernel(int in, size_t inOffset, int out, size_t outOffset, size_t size) {
+	loff_t inPos = inOffset, outPos = outOffset;
+
+	return copy_file_range(in, &inPos, out, &outPos, size, 0);
+}
+#else
+static ssize_t copyFileRangeKernel(int UNUSED(in), size_t UNUSED(inOffset), int UNUSED(out),
+                                   size_t UNUSED(outOffset), size_t UNUSED(size)) {
+	errno = ENOSYS;
+	return -1;
+}
+#endif
+
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+static ssize_t sendFileKernel(int in, size_t inOffset, int out, size_t outOffset, size_t size) {
+	// sendfile() writes at the file offset of the output
+	if (lseek(out, outOffset, SEEK_SET) == (off_t) -1)
+		return -1;
+
+	off_t inPos = inOffset;
+
+	return sendfile(out, in, &inPos, size);
+}
+#else
+static ssize_t sendFileKernel(int UNUSED(in), size_t UNUSED(inOffset), int UNUSED(out),
+                              size_t UNUSED(outOffset), size_t UNUSED(size)) {
+	errno = ENOSYS;
+	return -1;
+}
+#endif
+
+size_t Platform::copyFileRange(std::FILE *in, size_t offset, std::FILE *out, size_t size) {
+	if (!in || !out || (size == 0))
+		return 0;
+
+	// Everything still buffered has to land in the file before the copied data
+	if (std::fflush(out) != 0)
+		return 0;
+
+	const long outOffset = std::ftell(out);
+	if (outOffset < 0)
+		return 0;
+
+	const int inFD  = fileno(in);
+	const int outFD = fileno(out);
+
+	bool useCopyFileRange = true;
+
+	size_t copied = 0;
+	while (copied < size) {
+		const ssize_t n = useCopyFileRange ?
+			copyFileRangeKernel(inFD, offset + copied, outFD, outOffset + copied, size - copied) :
+			sendFileKernel     (inFD, offset + copied, outFD, outOffset + copied, size - copied);
+
+		if ((n < 0) && (errno == EINTR))
+			continue;
+
+		// Not every kernel and file system can copy_file_range() between any two files
+		if ((n <= 0) && useCopyFileRange) {
+			useCopyFileRange = false;
+			continue;
+		}
+
+		if (n <= 0)
+			break;
+
+		copied += n;
+	}
+
+	if (copied > 0)
+		if (std::fseek(out, outOffset + copied, SEEK_SET) != 0)
+			throw Exception(kSeekError);
+
+	return copied;
+}
+
+#else
+
+size_t Platform::copyFileRange(std::FILE *UNUSED(in), size_t UNUSED(offset),
+                               std::FILE *UNUSED(out), size_t UNUSED(size)) {
+	return 0;
+}
+
+#endif
+// '--- copyFileRange() ---'
+
 // .--- Windows utility functions ---.
 #if defined(WIN32)
 
@@ -29,6 +29,7 @@
 
 #include <vector>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 namespace Common {
@@ -51,6 +52,33 @@ public:
 	/** Open a file with an UTF-8 encoded name. */
 	static std::FILE *openFile(const UString &fileName, FileMode mode);
 
+	/** Map the first size bytes of an opened file read-only into memory.
+	 *
+	 *  @return A pointer to the mapped data, or 0 if the mapping failed.
+	 */
+	static const byte *mapFile(std::FILE *file, size_t size);
+	/** Unmap a file previously mapped with mapFile(). */
+	static void unmapFile(const byte *data, size_t size);
+
+	/** Read from an opened file at the given offset, without moving its file position.
+	 *
+	 *  @return The number of bytes read, or SIZE_MAX if the platform doesn't
+	 *          support positional reads.
+	 */
+	static size_t readFileAt(std::FILE *file, size_t offset, void *data, size_t size);
+
+	/** Copy data at the given offset of an opened file to the current position
+	 *  of another opened file, letting the kernel copy it where possible.
+	 *
+	 *  The output file is flushed before and positioned after the copied data.
+	 *  The position of the input file is not changed.
+	 *
+	 *  @return The number of bytes copied. This is less than requested, maybe
+	 *          even 0, if the platform or the file systems don't support
+	 *          copying between files; the caller has to copy the rest itself.
+	 */
+	static size_t copyFileRange(std::FILE *in, size_t offset, std::FILE *out, size_t size);
+
 	/** Return the OS-specific path of the user's home directory. */
 	static UString getHomeDirectory();
 	/** Return the OS-specific path of the config directory. */
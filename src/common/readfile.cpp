@@ -24,6 +24,7 @@
 
 #include <cassert>
 
+#include "src/common/util.h"
 #include "src/common/readfile.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
@@ -139,6 +140,30 @@ size_t ReadFile::read(void *dataPtr, size_t dataSize) {
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+size_t ReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (!_handle || (offset > _size))
+		return 0;
+
+	assert(dataPtr);
+
+	dataSize = MIN(dataSize, _size - offset);
+
+	const size_t bytesRead = Platform::readFileAt(_handle, offset, dataPtr, dataSize);
+	if (bytesRead != SIZE_MAX)
+		return bytesRead;
+
+	std::lock_guard<std::mutex> lock(_readAtMutex);
+
+	return SeekableReadStream::readAt(offset, dataPtr, dataSize);
+}
+
+size_t ReadFile::copyAt(size_t offset, std::FILE *file, size_t dataSize) {
+	if (!_handle || (offset > _size))
+		return 0;
+
+	return Platform::copyFileRange(_handle, offset, file, MIN(dataSize, _size - offset));
+}
+
 MemoryReadStream *ReadFile::readIntoMemory(const UString &fileName) {
 	ReadFile file(fileName);
 
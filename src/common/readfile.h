@@ -28,6 +28,8 @@
 #include <cstdio>
 #include <cstddef>
 
+#include <mutex>
+
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
@@ -69,6 +71,22 @@ public:
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 	size_t read(void *dataPtr, size_t dataSize);
 
+	/** Read from the given position, using pread() where available.
+	 *
+	 *  Positional reads can be made from several threads at once. Where the
+	 *  platform has no pread(), they are serialized and emulated with seeking,
+	 *  so they're only safe against each other, not against read() or seek().
+	 */
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Copy from the given position into another file, using copy_file_range()
+	 *  or sendfile() where available.
+	 *
+	 *  Like readAt(), this never disturbs the file position or other positional
+	 *  reads and copies.
+	 */
+	size_t copyAt(size_t offset, std::FILE *file, size_t dataSize);
+
 	/** Read the whole file into memory and return a stream of its contents. */
 	static MemoryReadStream *readIntoMemory(const UString &fileName);
 
@@ -76,6 +94,8 @@ public:
 protected:
 	std::FILE *_handle; ///< The actual file handle.
 	size_t _size;       ///< The file's size.
+
+	std::mutex _readAtMutex; ///< Serializes emulated positional reads.
 };
 
 } // End of namespace Common
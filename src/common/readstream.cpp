@@ -51,6 +51,7 @@
 
 #include <memory>
 
+#include "src/common/util.h"
 #include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
 #include "src/common/error.h"
@@ -81,6 +82,37 @@ SeekableReadStream::SeekableReadStream() {
 SeekableReadStream::~SeekableReadStream() {
 }
 
+size_t SeekableReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		return 0;
+
+	const size_t oldPos = seek(offset);
+	const size_t bytesRead = read(dataPtr, dataSize);
+	seek(oldPos);
+
+	return bytesRead;
+}
+
+size_t SeekableReadStream::copyAt(size_t UNUSED(offset), std::FILE *UNUSED(file), size_t UNUSED(dataSize)) {
+	return 0;
+}
+
+MemoryReadStream *SeekableReadStream::readStreamAt(size_t offset, size_t dataSize) {
+	std::unique_ptr<byte[]> buf = std::make_unique<byte[]>(dataSize);
+
+	if (readAt(offset, buf.get(), dataSize) != dataSize)
+		throw Exception(kReadError);
+
+	return new MemoryReadStream(buf.release(), dataSize, true);
+}
+
+SeekableReadStream *SeekableReadStream::getSubStream(size_t begin, size_t end) {
+	if ((begin > end) || (end > size()))
+		throw Exception(kSeekError);
+
+	return new SeekableSubReadStream(this, begin, end);
+}
+
 size_t SeekableReadStream::evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size) {
 	switch (whence) {
 		case kOriginEnd:
@@ -131,13 +163,34 @@ SeekableSubReadStream::SeekableSubReadStream(SeekableReadStream *parentStream, s
 
 	assert(_begin <= _end);
 
+	if (_begin > _parentStream->size())
+		throw Exception(kSeekError);
+
 	_pos = begin;
-	_parentStream->seek(_pos);
 }
 
 SeekableSubReadStream::~SeekableSubReadStream() {
 }
 
+bool SeekableSubReadStream::eos() const {
+	return _eos;
+}
+
+size_t SeekableSubReadStream::read(void *dataPtr, size_t dataSize) {
+	if (dataSize > (size_t)(_end - _pos)) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	const size_t bytesRead = _parentStream->readAt(_pos, dataPtr, dataSize);
+	if (bytesRead < dataSize)
+		_eos = true;
+
+	_pos += bytesRead;
+
+	return bytesRead;
+}
+
 size_t SeekableSubReadStream::pos() const {
 	return _pos - _begin;
 }
@@ -157,12 +210,29 @@ size_t SeekableSubReadStream::seek(ptrdiff_t offset, Origin whence) {
 
 	_pos = newPos;
 
-	_parentStream->seek(_pos);
 	_eos = false; // reset eos on successful seek
 
 	return oldPos;
 }
 
+size_t SeekableSubReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		return 0;
+
+	dataSize = MIN(dataSize, size() - offset);
+
+	return _parentStream->readAt(_begin + offset, dataPtr, dataSize);
+}
+
+size_t SeekableSubReadStream::copyAt(size_t offset, std::FILE *file, size_t dataSize) {
+	if (offset > size())
+		return 0;
+
+	dataSize = MIN(dataSize, size() - offset);
+
+	return _parentStream->copyAt(_begin + offset, file, dataSize);
+}
+
 
 SeekableSubReadStreamEndian::SeekableSubReadStreamEndian(SeekableReadStream *parentStream,
 		size_t begin, size_t end, bool bigEndian, bool disposeParentStream) :
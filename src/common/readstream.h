@@ -51,6 +51,7 @@
 #define COMMON_READSTREAM_H
 
 #include <cstddef>
+#include <cstdio>
 
 #include "src/common/types.h"
 #include "src/common/endianness.h"
@@ -320,6 +321,57 @@ public:
 		return seek(offset, kOriginCurrent);
 	}
 
+	/** Read data from the given position in the stream, without using or
+	 *  changing the stream position indicator.
+	 *
+	 *  By default, this seeks to the position, reads and then seeks back,
+	 *  so it is no safer than a plain seek() and read(). Streams that can do
+	 *  better override it: for ReadFile, MappedReadFile and MemoryReadStream,
+	 *  positional reads never disturb each other, and they can be made from
+	 *  several threads at once.
+	 *
+	 *  @param  offset   the position within the stream to read from.
+	 *  @param  dataPtr  pointer to a buffer into which the data is read.
+	 *  @param  dataSize number of bytes to be read.
+	 *  @return the number of bytes which were actually read.
+	 */
+	virtual size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Copy data from the given position in the stream to the current position
+	 *  of an opened file, without using or changing the stream position indicator.
+	 *
+	 *  This is meant for streams backed by a file, so that the kernel can copy
+	 *  the data without it ever passing through user space. By default, nothing
+	 *  is copied. ReadFile and MappedReadFile copy from their file, and
+	 *  SeekableSubReadStream passes the request on to its parent.
+	 *
+	 *  @param  offset   the position within the stream to copy from.
+	 *  @param  file     the file to copy into.
+	 *  @param  dataSize number of bytes to be copied.
+	 *  @return the number of bytes which were actually copied. The caller has
+	 *          to read and write whatever wasn't copied itself.
+	 */
+	virtual size_t copyAt(size_t offset, std::FILE *file, size_t dataSize);
+
+	/** Read the specified amount of data from the given position into a new[]'ed
+	 *  buffer which then is wrapped into a MemoryReadStream. Like readAt(), this
+	 *  does not change the stream position indicator.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	MemoryReadStream *readStreamAt(size_t offset, size_t dataSize);
+
+	/** Create a new stream reading the range [begin, end) of this stream.
+	 *
+	 *  The new stream references this stream, which has to outlive it. By
+	 *  default, this is a SeekableSubReadStream. Streams that already hold
+	 *  all their data in memory return a stream pointing straight into
+	 *  that memory instead, without copying anything.
+	 *
+	 *  When the range lies outside the stream, a kSeekError exception is thrown.
+	 */
+	virtual SeekableReadStream *getSubStream(size_t begin, size_t end);
+
 	/** Evaluate the seek offset relative to whence into a position from the beginning. */
 	static size_t evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size);
 };
@@ -353,10 +405,12 @@ protected:
 
 /** SeekableSubReadStream provides access to a SeekableReadStream restricted to
  *  the range [begin, end).
- *  The same caveats apply to SeekableSubReadStream as do to SeekableReadStream.
  *
- *  Manipulating the parent stream directly /will/ mess up a substream.
- *  @see SubReadStream
+ *  Unlike SubReadStream, a SeekableSubReadStream keeps its own position and
+ *  reads from its parent with readAt(). Several substreams of the same parent
+ *  can therefore be read interleaved, and the parent's own position is never
+ *  touched. If the parent's readAt() can be called from several threads at
+ *  once (like for a ReadFile), so can the substreams be read concurrently.
  */
 class SeekableSubReadStream : public SubReadStream, public SeekableReadStream {
 public:
@@ -364,11 +418,18 @@ public:
 	                      bool disposeParentStream = false);
 	~SeekableSubReadStream();
 
+	bool eos() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+
 	size_t pos() const;
 	size_t size() const;
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	size_t copyAt(size_t offset, std::FILE *file, size_t dataSize);
+
 protected:
 	SeekableReadStream *_parentStream;
 
@@ -379,8 +440,7 @@ protected:
 /** This is a wrapper around SeekableSubReadStream, but it adds non-endian
  *  read methods whose endianness is set on the stream creation.
  *
- *  Manipulating the parent stream directly /will/ mess up a substream.
- *  @see SubReadStream
+ *  @see SeekableSubReadStream
  */
 class SeekableSubReadStreamEndian : public SeekableSubReadStream {
 private:
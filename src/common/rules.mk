@@ -52,12 +52,14 @@ src_common_libcommon_la_SOURCES += \
     src/common/stdoutstream.h \
     src/common/streamtokenizer.h \
     src/common/readfile.h \
+    src/common/mappedreadfile.h \
     src/common/writefile.h \
     src/common/filepath.h \
     src/common/zipfile.h \
     src/common/binsearch.h \
     src/common/cli.h \
     src/common/stringmap.h \
+    src/common/threadpool.h \
     $(EMPTY)
 
 src_common_libcommon_la_SOURCES += \
@@ -81,9 +83,11 @@ src_common_libcommon_la_SOURCES += \
     src/common/stdoutstream.cpp \
     src/common/streamtokenizer.cpp \
     src/common/readfile.cpp \
+    src/common/mappedreadfile.cpp \
     src/common/writefile.cpp \
     src/common/filepath.cpp \
     src/common/zipfile.cpp \
     src/common/cli.cpp \
     src/common/stringmap.cpp \
+    src/common/threadpool.cpp \
     $(EMPTY)
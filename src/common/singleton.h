@@ -50,6 +50,9 @@
 #ifndef COMMON_SINGLETON_H
 #define COMMON_SINGLETON_H
 
+#include <atomic>
+#include <mutex>
+
 #include <boost/noncopyable.hpp>
 
 namespace Common {
@@ -63,7 +66,13 @@ private:
 	Singleton<T>(const Singleton<T> &);
 	Singleton<T> &operator=(const Singleton<T> &);
 
-	static T *_singleton;
+	static std::atomic<T *> _singleton;
+
+	/** Guards the creation and destruction of the instance. */
+	static std::mutex &getMutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
 
 	/**
 	 * The default object factory used by the template class Singleton.
@@ -82,23 +91,34 @@ public:
 	}
 
 	static void destroyInstance() {
-		delete _singleton;
-		_singleton = 0;
+		std::lock_guard<std::mutex> lock(getMutex());
+
+		delete _singleton.exchange(0);
 	}
 
 
 public:
 	static T& instance() {
-		// TODO: We aren't thread safe. For now we ignore it since the
-		// only thing using this singleton template is the config manager,
-		// and that is first instantiated long before any threads.
+		// The instance is created on first use, which may happen from several
+		// threads at once. Double-checked locking makes sure only one of them
+		// creates it, while the fast path after that is a single atomic load.
+		// Destroying the instance while other threads still use it is not safe.
 		// TODO: We don't leak, but the destruction order is nevertheless
 		// semi-random. If we use multiple singletons, the destruction
 		// order might become an issue. There are various approaches
 		// to solve that problem, but for now this is sufficient
-		if (!_singleton)
-			_singleton = T::makeInstance();
-		return *_singleton;
+		T *singleton = _singleton.load(std::memory_order_acquire);
+		if (!singleton) {
+			std::lock_guard<std::mutex> lock(getMutex());
+
+			singleton = _singleton.load(std::memory_order_relaxed);
+			if (!singleton) {
+				singleton = T::makeInstance();
+				_singleton.store(singleton, std::memory_order_release);
+			}
+		}
+
+		return *singleton;
 	}
 
 	static void destroy() {
@@ -121,7 +141,7 @@ protected:
  */
 #define DECLARE_SINGLETON(T) \
 	namespace Common { \
-	template<> T *Singleton<T>::_singleton = 0; \
+	template<> std::atomic<T *> Singleton<T>::_singleton(0); \
 	} // End of namespace Common
 
 } // End of namespace Common
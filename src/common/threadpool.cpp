@@ -0,0 +1,123 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A simple pool of worker threads.
+ */
+
+#include "src/common/threadpool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(size_t threadCount) {
+	threadCount = getThreadCount(threadCount);
+
+	_threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++)
+		_threads.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_jobsDone.wait(lock, [this]() { return _jobs.empty() && (_running == 0); });
+
+		_quit = true;
+	}
+
+	_jobAvailable.notify_all();
+
+	for (std::vector<std::thread>::iterator t = _threads.begin(); t != _threads.end(); ++t)
+		t->join();
+}
+
+size_t ThreadPool::getThreadCount() const {
+	return _threads.size();
+}
+
+size_t ThreadPool::getHardwareThreadCount() {
+	const size_t count = std::thread::hardware_concurrency();
+
+	return (count == 0) ? 1 : count;
+}
+
+size_t ThreadPool::getThreadCount(size_t threadCount) {
+	return (threadCount == 0) ? getHardwareThreadCount() : threadCount;
+}
+
+void ThreadPool::addJob(const Job &job) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_jobs.push_back(job);
+	}
+
+	_jobAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::exception_ptr exception;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_jobsDone.wait(lock, [this]() { return _jobs.empty() && (_running == 0); });
+
+		std::swap(exception, _exception);
+	}
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void ThreadPool::run(size_t thread) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (true) {
+		_jobAvailable.wait(lock, [this]() { return _quit || !_jobs.empty(); });
+
+		if (_jobs.empty())
+			break;
+
+		Job job = std::move(_jobs.front());
+		_jobs.pop_front();
+
+		_running++;
+		lock.unlock();
+
+		try {
+			job(thread);
+		} catch (...) {
+			lock.lock();
+			if (!_exception)
+				_exception = std::current_exception();
+			lock.unlock();
+		}
+
+		lock.lock();
+		_running--;
+
+		if (_jobs.empty() && (_running == 0))
+			_jobsDone.notify_all();
+	}
+}
+
+} // End of namespace Common
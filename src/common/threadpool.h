@@ -0,0 +1,119 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A simple pool of worker threads.
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include <cstddef>
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <exception>
+
+#include <boost/noncopyable.hpp>
+
+namespace Common {
+
+/** A fixed-size pool of worker threads working through a queue of jobs.
+ *
+ *  Jobs are started in the order they were added. Each job is given the
+ *  index of the worker thread it runs on, which can be used to look up
+ *  per-thread state (like a thread's own file handle).
+ *
+ *  If a job throws, the first exception is stored and rethrown by wait().
+ */
+class ThreadPool : boost::noncopyable {
+public:
+	/** A job, taking the index of the thread it runs on. */
+	typedef std::function<void(size_t)> Job;
+
+	/** Create a pool of threadCount threads. 0 means one per hardware thread. */
+	ThreadPool(size_t threadCount = 0);
+	/** Wait for all queued jobs to finish, then stop the threads. */
+	~ThreadPool();
+
+	/** Return the number of worker threads in this pool. */
+	size_t getThreadCount() const;
+
+	/** Queue a job to be run on one of the worker threads. */
+	void addJob(const Job &job);
+
+	/** Queue a task producing a value, and return a future for that value.
+	 *
+	 *  An exception thrown by the task is stored in the future, to be rethrown
+	 *  by its get(), instead of by wait().
+	 */
+	template<typename T>
+	std::future<T> addTask(const std::function<T()> &task) {
+		std::shared_ptr<std::promise<T>> promise = std::make_shared<std::promise<T>>();
+
+		addJob([promise, task](size_t) {
+			try {
+				promise->set_value(task());
+			} catch (...) {
+				promise->set_exception(std::current_exception());
+			}
+		});
+
+		return promise->get_future();
+	}
+
+	/** Wait until all queued jobs have finished.
+	 *
+	 *  If any of the jobs threw an exception, the first one is rethrown here.
+	 */
+	void wait();
+
+	/** Return the number of concurrent threads the hardware supports, or 1 if unknown. */
+	static size_t getHardwareThreadCount();
+
+	/** Resolve a user-given thread count: 0 means one per hardware thread. */
+	static size_t getThreadCount(size_t threadCount);
+
+private:
+	std::vector<std::thread> _threads;
+
+	std::deque<Job> _jobs;
+	size_t _running { 0 };
+
+	bool _quit { false };
+
+	std::exception_ptr _exception;
+
+	std::mutex _mutex;
+	std::condition_variable _jobAvailable;
+	std::condition_variable _jobsDone;
+
+	void run(size_t thread);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_THREADPOOL_H
@@ -48,19 +48,26 @@ public:
 	typedef utf8::iterator<std::string::const_iterator> iterator;
 
 	// Case sensitive compare
-	struct sless : std::binary_function<UString, UString, bool> {
+	struct sless {
 		bool operator() (const UString &str1, const UString &str2) const {
 			return str1.less(str2);
 		}
 	};
 
 	// Case insensitive compare
-	struct iless : std::binary_function<UString, UString, bool> {
+	struct iless {
 		bool operator() (const UString &str1, const UString &str2) const {
 			return str1.lessIgnoreCase(str2);
 		}
 	};
 
+	// Case insensitive equality
+	struct iequal {
+		bool operator() (const UString &str1, const UString &str2) const {
+			return str1.equalsIgnoreCase(str2);
+		}
+	};
+
 	/** Construct an empty string. */
 	UString();
 	/** Copy constructor. */
@@ -24,7 +24,9 @@
 
 #include <cassert>
 
+#include "src/common/util.h"
 #include "src/common/writefile.h"
+#include "src/common/readstream.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/platform.h"
@@ -101,6 +103,31 @@ size_t WriteFile::write(const void *dataPtr, size_t dataSize) {
 	return written;
 }
 
+size_t WriteFile::copyStream(ReadStream &stream, size_t n) {
+	if (!_handle)
+		return 0;
+
+	// Only seekable streams can be asked for a copy of their data
+	SeekableReadStream *input = dynamic_cast<SeekableReadStream *>(&stream);
+	if (!input)
+		return 0;
+
+	const size_t inputPos  = input->pos();
+	const size_t inputSize = input->size();
+	if ((inputPos == ReadStream::kPositionInvalid) || (inputSize == ReadStream::kSizeInvalid) || (inputPos >= inputSize))
+		return 0;
+
+	const size_t oldPos = pos();
+	const size_t copied = input->copyAt(inputPos, _handle, MIN(n, inputSize - inputPos));
+	if (copied == 0)
+		return 0;
+
+	input->skip(copied);
+	_size = MAX(_size, oldPos + copied);
+
+	return copied;
+}
+
 size_t WriteFile::size() const {
 	return _size;
 }
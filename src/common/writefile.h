@@ -77,6 +77,9 @@ protected:
 	std::FILE *_handle; ///< The actual file handle.
 
 	size_t _size;
+
+	/** Let the kernel copy from the input stream, if it is backed by a file. */
+	size_t copyStream(ReadStream &stream, size_t n);
 };
 
 } // End of namespace Common
@@ -49,6 +49,8 @@
 
 #include <cstring>
 
+#include <memory>
+
 #include "src/common/writestream.h"
 #include "src/common/readstream.h"
 #include "src/common/util.h"
@@ -69,18 +71,37 @@ WriteStream::~WriteStream() {
 void WriteStream::flush() {
 }
 
-size_t WriteStream::writeStream(ReadStream &stream, size_t n) {
-	size_t haveRead = 0, haveWritten = 0;
+size_t WriteStream::copyStream(ReadStream &UNUSED(stream), size_t UNUSED(n)) {
+	return 0;
+}
+
+size_t WriteStream::writeStream(ReadStream &stream, size_t n, size_t bufferSize) {
+	const size_t copied = copyStream(stream, n);
+
+	n -= copied;
+
+	size_t haveWritten = copied;
+	if (n == 0)
+		return haveWritten;
+
+	// Don't allocate a bigger buffer than there's data left in the input stream
+	const SeekableReadStream *seekable = dynamic_cast<const SeekableReadStream *>(&stream);
+	if (seekable) {
+		const size_t size = seekable->size(), pos = seekable->pos();
+		if ((size != SeekableReadStream::kSizeInvalid) && (pos != SeekableReadStream::kPositionInvalid) && (pos <= size))
+			bufferSize = MIN(bufferSize, size - pos);
+	}
+
+	bufferSize = MAX<size_t>(MIN(bufferSize, n), 1);
 
-	byte buf[4096];
+	std::unique_ptr<byte[]> buf(new byte[bufferSize]);
 	while (!stream.eos() && (n > 0)) {
-		const size_t toRead  = MIN<size_t>(4096, n);
-		const size_t bufRead = stream.read(buf, toRead);
+		const size_t toRead  = MIN(bufferSize, n);
+		const size_t bufRead = stream.read(buf.get(), toRead);
 
-		const size_t bufWrite = write(buf, bufRead);
+		const size_t bufWrite = write(buf.get(), bufRead);
 
 		n           -= bufRead;
-		haveRead    += bufRead;
 		haveWritten += bufWrite;
 	}
 
@@ -65,6 +65,9 @@ class ReadStream;
 /** Generic interface for a writable data stream. */
 class WriteStream {
 public:
+	/** The default size of the buffer writeStream() copies through. */
+	static const size_t kCopyBufferSize = 64 * 1024;
+
 	WriteStream();
 	virtual ~WriteStream();
 
@@ -192,11 +195,15 @@ public:
 	 *  stream, all requested bytes will always be read from the
 	 *  input stream.
 	 *
+	 *  The data is copied through a buffer of bufferSize bytes, unless
+	 *  copyStream() can copy it directly.
+	 *
 	 *  @param  stream The stream to read from.
 	 *  @param  n The number of bytes to read from the stream.
+	 *  @param  bufferSize The size of the buffer to copy through.
 	 *  @return the number of bytes which were actually written.
 	 */
-	size_t writeStream(ReadStream &stream, size_t n);
+	size_t writeStream(ReadStream &stream, size_t n, size_t bufferSize = kCopyBufferSize);
 
 	/** Copy the complete contents of the given stream.
 	 *
@@ -212,6 +219,18 @@ public:
 	/** Write the given string to the stream, encoded as UTF-8.
 	 *  No terminating zero byte is written. */
 	void writeString(const UString &str);
+
+protected:
+	/** Copy up to n bytes of the given stream without going through a buffer.
+	 *
+	 *  writeStream() calls this first, and then copies whatever is left through
+	 *  its buffer. By default, nothing is copied. WriteFile lets the kernel copy
+	 *  straight from the file backing the input stream, if there is one.
+	 *
+	 *  @return the number of bytes which were copied, and thereby also
+	 *          skipped in the input stream.
+	 */
+	virtual size_t copyStream(ReadStream &stream, size_t n);
 };
 
 class SeekableWriteStream : public WriteStream {
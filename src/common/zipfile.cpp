@@ -168,7 +168,7 @@ SeekableReadStream *ZipFile::getFile(uint32_t index, bool tryNoCopy) const {
 	getFileProperties(*_zip, file, compMethod, compSize, realSize);
 
 	if (tryNoCopy && (compMethod == 0))
-		return new SeekableSubReadStream(_zip.get(), _zip->pos(), _zip->pos() + compSize);
+		return _zip->getSubStream(_zip->pos(), _zip->pos() + compSize);
 
 	return decompressFile(*_zip, compMethod, compSize, realSize);
 }
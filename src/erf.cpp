@@ -23,15 +23,19 @@
  */
 
 #include <set>
+#include <vector>
+#include <memory>
 
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/cli.h"
 #include "src/common/readfile.h"
 #include "src/common/writefile.h"
+#include "src/common/stdoutstream.h"
 #include "src/common/filepath.h"
 
 #include "src/aurora/erfwriter.h"
+#include "src/aurora/compression.h"
 #include "src/aurora/util.h"
 
 #include "src/util.h"
@@ -44,7 +48,8 @@ static const uint32_t kSAVID = MKTAG('S', 'A', 'V', ' ');
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &archive, std::set<Common::UString> &files,
                       Aurora::ERFWriter::Version &version, Aurora::ERFWriter::Compression &compression,
-                      uint32_t &id, Aurora::GameID &game);
+                      Aurora::CompressionOptions &compressionOptions, bool &printStatistics,
+                      uint32_t &id, Aurora::GameID &game, uint32_t &jobs);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -61,32 +66,69 @@ int main(int argc, char **argv) {
 		Aurora::ERFWriter::Version version = Aurora::ERFWriter::kERFVersion10;
 		Aurora::ERFWriter::Compression compression = Aurora::ERFWriter::kCompressionNone;
 		std::set<Common::UString> files;
+		uint32_t jobs = 1;
 
-		if (!parseCommandLine(args, returnValue, archive, files, version, compression, id, game))
+		Aurora::CompressionOptions compressionOptions;
+		bool printStatistics = false;
+
+		if (!parseCommandLine(args, returnValue, archive, files, version, compression,
+		                      compressionOptions, printStatistics, id, game, jobs))
 			return returnValue;
 
 		if (compression != Aurora::ERFWriter::kCompressionNone && version != Aurora::ERFWriter::kERFVersion22)
 			throw Common::Exception("Compression is only allowed in ERF V2.2");
 
+		if ((compressionOptions.level < -1) || (compressionOptions.level > Common::kDeflateLevelBest))
+			throw Common::Exception("Invalid compression level %d", compressionOptions.level);
+
 		for (const auto &file : files)
 			if (file.equalsIgnoreCase(archive))
 				throw Common::Exception("Trying to pack file \"%s\" into itself?!?", file.c_str());
 
 		Common::WriteFile writeFile(archive);
 
-		size_t i = 1;
-		Aurora::ERFWriter erfWriter(id, files.size(), writeFile, version, compression);
-		for (std::set<Common::UString>::const_iterator iter = files.begin(); iter != files.end(); ++iter, ++i) {
-			std::printf("Packing %u/%u: %s ... ", (uint)i, (uint)files.size(), iter->c_str());
-			std::fflush(stdout);
+		Aurora::CompressionStatistics statistics;
+
+		Aurora::ERFWriter erfWriter(id, files.size(), writeFile, version, compression, Aurora::LocString(), jobs,
+		                            compressionOptions, printStatistics ? &statistics : nullptr);
 
-			Common::UString file = *iter;
-			Common::ReadFile fileStream(file);
+		/* When compressing on several threads, a file is only done once it has
+		 * been written, after its compression finished. So report it then. */
+		const std::vector<Common::UString> fileList(files.begin(), files.end());
+		erfWriter.setWrittenCallback([&fileList](size_t index) {
+			std::printf("Packing %u/%u: %s ... Done\n", (uint)(index + 1), (uint)fileList.size(), fileList[index].c_str());
+			std::fflush(stdout);
+		});
+
+		/* With several threads, add() can also fail on an earlier file that
+		 * was still being compressed. The writer names the file in that case. */
+		for (const auto &file : fileList) {
+			std::unique_ptr<Common::ReadFile> fileStream;
+			try {
+				fileStream = std::make_unique<Common::ReadFile>(file);
+			} catch (Common::Exception &e) {
+				e.add("Failed to pack \"%s\"", file.c_str());
+				throw;
+			}
 
 			const Aurora::FileType type = TypeMan.unaliasFileType(TypeMan.getFileType(file), game);
 
-			erfWriter.add(Common::FilePath::getStem(file), type, fileStream);
-			std::printf("Done\n");
+			erfWriter.add(Common::FilePath::getStem(file), type, *fileStream);
+		}
+
+		try {
+			erfWriter.flush();
+			writeFile.flush();
+		} catch (Common::Exception &e) {
+			e.add("Failed to write \"%s\"", archive.c_str());
+			throw;
+		}
+
+		if (printStatistics && (compression != Aurora::ERFWriter::kCompressionNone)) {
+			std::printf("\n");
+
+			Common::StdOutStream out;
+			statistics.write(out);
 		}
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -98,7 +140,8 @@ int main(int argc, char **argv) {
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &archive, std::set<Common::UString> &files,
                       Aurora::ERFWriter::Version &version, Aurora::ERFWriter::Compression &compression,
-                      uint32_t &id, Aurora::GameID &game) {
+                      Aurora::CompressionOptions &compressionOptions, bool &printStatistics,
+                      uint32_t &id, Aurora::GameID &game, uint32_t &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -147,6 +190,32 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("zlib", "Compress using headerless zlib method",
 	                 kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::ERFWriter::Compression>(Aurora::ERFWriter::kCompressionHeaderlessZlib, compression)));
+	parser.addOption("jobs", 'j', "Compress using this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("level", "Compression level, from 0 (fastest) to 9 (best, default)",
+	                 kContinueParsing, new ValGetter<int32_t &>(compressionOptions.level, "n"));
+	parser.addOption("filtered", "Compress using zlib's strategy for filtered data",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<Common::DeflateStrategy>(Common::kDeflateStrategyFiltered,
+	                                                                        compressionOptions.deflateStrategy)));
+	parser.addOption("huffman", "Compress using Huffman coding only",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<Common::DeflateStrategy>(Common::kDeflateStrategyHuffmanOnly,
+	                                                                        compressionOptions.deflateStrategy)));
+	parser.addOption("rle", "Compress using run-length encoding only",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<Common::DeflateStrategy>(Common::kDeflateStrategyRLE,
+	                                                                        compressionOptions.deflateStrategy)));
+	parser.addOption("fixed", "Compress using fixed Huffman codes only",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<Common::DeflateStrategy>(Common::kDeflateStrategyFixed,
+	                                                                        compressionOptions.deflateStrategy)));
+	parser.addOption("fast-incompressible", "Only store files that look incompressible",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, compressionOptions.fastIncompressible)));
+	parser.addOption("stats", "Print compression statistics per file type",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, printStatistics)));
 	parser.addSpace();
 	parser.addOption("jade", "Unalias file types according to Jade Empire rules",
 	                 kContinueParsing,
@@ -39,6 +39,7 @@
 #include "src/common/stdoutstream.h"
 #include "src/common/encoding.h"
 #include "src/common/cli.h"
+#include "src/common/filepath.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/language.h"
@@ -46,18 +47,22 @@
 #include "src/xml/gffdumper.h"
 
 #include "src/util.h"
+#include "src/batch.h"
 
 typedef std::map<uint32_t, Common::Encoding> EncodingOverrides;
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Common::Encoding &encoding, Aurora::GameID &game,
-                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile);
+                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile,
+                      bool &batch, uint32_t &jobs);
 
 bool parseEncodingOverride(const Common::UString &arg, EncodingOverrides &encOverrides);
 
 void dumpGFF(const Common::UString &inFile, const Common::UString &outFile, Common::Encoding encoding, bool nwnPremium,
              bool sacFile);
+size_t dumpGFFs(const Common::UString &source, const Common::UString &outDir, Common::Encoding encoding, bool nwnPremium,
+                bool sacFile, size_t jobs);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -73,11 +78,15 @@ int main(int argc, char **argv) {
 
 		bool nwnPremium = false;
 		bool sacFile = false;
+		bool batch = false;
+
+		uint32_t jobs = 1;
 
 		int returnValue = 1;
 		Common::UString inFile, outFile;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, encoding, game, encOverrides, nwnPremium, sacFile))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, encoding, game, encOverrides, nwnPremium, sacFile,
+		                      batch, jobs))
 			return returnValue;
 
 		LangMan.declareLanguages(game);
@@ -85,7 +94,13 @@ int main(int argc, char **argv) {
 		for (EncodingOverrides::const_iterator e = encOverrides.begin(); e != encOverrides.end(); ++e)
 			LangMan.overrideEncoding(e->first, e->second);
 
+		if (batch)
+			return (dumpGFFs(inFile, outFile, encoding, nwnPremium, sacFile, jobs) == 0) ? 0 : 1;
+
 		dumpGFF(inFile, outFile, encoding, nwnPremium, sacFile);
+
+		if (!outFile.empty())
+			status("Converted \"%s\" to \"%s\"", inFile.c_str(), outFile.c_str());
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -120,7 +135,8 @@ bool parseEncodingOverride(const Common::UString &arg, EncodingOverrides &encOve
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Common::Encoding &encoding, Aurora::GameID &game,
-                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile) {
+                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile,
+                      bool &batch, uint32_t &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -143,11 +159,22 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              "for a specific language ID. The string has to be of the form n=encoding,\n"
 	              "for example 0=cp-1252 to override the encoding of the (ungendered) language\n"
 	              "ID 0 to be Windows codepage 1252. To override several encodings, specify\n"
-	              "the --encoding parameter multiple times.\n",
+	              "the --encoding parameter multiple times.\n\n"
+	              "In batch mode, the input is either a directory, of which all files\n"
+	              "are converted recursively, or a text file listing one input file per\n"
+	              "line. The output is then a directory, mirroring the input paths and\n"
+	              "appending \".xml\" to each file name. If no output directory is given,\n"
+	              "each XML file is written next to its GFF file.\n",
 	              returnValue,
 	              makeEndArgs(&inFileOpt, &outFileOpt));
 
 
+	parser.addSpace();
+	parser.addOption("batch", 'b', "Convert all files of a directory or list file", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of files to convert in parallel in batch mode "
+	                 "(0: one per CPU core)", kContinueParsing,
+	                 new ValGetter<uint32_t &>(jobs, "n"));
 	parser.addSpace();
 	parser.addOption("cp1252", "Read GFF4 strings as Windows CP-1252", kContinueParsing,
 	                 makeAssigners(new ValAssigner<Common::Encoding>(Common::kEncodingCP1252,
@@ -195,7 +222,20 @@ void dumpGFF(const Common::UString &inFile, const Common::UString &outFile, Comm
 	dumper->dump(*out, gff.release(), encoding, nwnPremium);
 
 	out->flush();
+}
+
+size_t dumpGFFs(const Common::UString &source, const Common::UString &outDir, Common::Encoding encoding, bool nwnPremium,
+                bool sacFile, size_t jobs) {
+
+	BatchFiles files;
+	collectBatchFiles(source, outDir, [](const Common::UString &file) {
+		// Don't pick up our own output when converting in-place
+		return !Common::FilePath::getExtension(file).equalsIgnoreCase(".xml");
+	}, [](const Common::UString &file) {
+		return file + ".xml";
+	}, files);
 
-	if (!outFile.empty())
-		status("Converted \"%s\" to \"%s\"", inFile.c_str(), outFile.c_str());
+	return runBatch(files, jobs, [=](const BatchFile &file) {
+		dumpGFF(file.inFile, file.outFile, encoding, nwnPremium, sacFile);
+	});
 }
@@ -25,10 +25,12 @@
 #include <cassert>
 
 #include <memory>
+#include <atomic>
+#include <algorithm>
 
 #include "src/common/util.h"
 #include "src/common/error.h"
-#include "src/common/memreadstream.h"
+#include "src/common/threadpool.h"
 
 #include "src/images/decoder.h"
 #include "src/images/util.h"
@@ -37,6 +39,8 @@
 
 namespace Images {
 
+static std::atomic<size_t> decompressThreadCount(1);
+
 Decoder::MipMap::MipMap() : width(0), height(0), size(0) {
 }
 
@@ -154,31 +158,74 @@ void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
 
 	out.data = std::make_unique<byte[]>(out.size);
 
-	std::unique_ptr<Common::MemoryReadStream> stream = std::make_unique<Common::MemoryReadStream>(in.data.get(), in.size);
-
 	if      (format == kPixelFormatDXT1)
-		decompressDXT1(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT1(out.data.get(), in.data.get(), in.size, out.width, out.height, out.width * 4);
 	else if (format == kPixelFormatDXT3)
-		decompressDXT3(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT3(out.data.get(), in.data.get(), in.size, out.width, out.height, out.width * 4);
 	else if (format == kPixelFormatDXT5)
-		decompressDXT5(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT5(out.data.get(), in.data.get(), in.size, out.width, out.height, out.width * 4);
 }
 
 void Decoder::decompress() {
 	if (!isCompressed())
 		return;
 
-	for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m) {
-		MipMap decompressed;
+	const size_t threadCount = MIN(Common::ThreadPool::getThreadCount(getThreadCount()), _mipMaps.size());
+
+	if (threadCount <= 1) {
+		for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m) {
+			MipMap decompressed;
 
-		decompress(decompressed, **m, _format);
+			decompress(decompressed, **m, _format);
 
-		decompressed.swap(**m);
+			decompressed.swap(**m);
+		}
+
+		_format = kPixelFormatR8G8B8A8;
+		return;
 	}
 
+	/* Every mip map of every layer is decompressed independently, each in a
+	 * job of its own. Queue the largest mip maps first, so that the small
+	 * ones fill the gaps at the end. */
+
+	std::vector<MipMap *> mipMaps;
+	mipMaps.reserve(_mipMaps.size());
+
+	for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m)
+		mipMaps.push_back(m->get());
+
+	std::stable_sort(mipMaps.begin(), mipMaps.end(), [](const MipMap *a, const MipMap *b) {
+		return a->size > b->size;
+	});
+
+	const PixelFormat format = _format;
+
+	Common::ThreadPool pool(threadCount);
+
+	for (MipMap *mipMap : mipMaps) {
+		pool.addJob([mipMap, format](size_t) {
+			MipMap decompressed;
+
+			decompress(decompressed, *mipMap, format);
+
+			decompressed.swap(*mipMap);
+		});
+	}
+
+	pool.wait();
+
 	_format = kPixelFormatR8G8B8A8;
 }
 
+void Decoder::setThreadCount(size_t threadCount) {
+	decompressThreadCount = threadCount;
+}
+
+size_t Decoder::getThreadCount() {
+	return decompressThreadCount;
+}
+
 void Decoder::dumpTGA(const Common::UString &fileName) const {
 	if (_mipMaps.size() < 1)
 		throw Common::Exception("Image contains no mip maps");
@@ -92,6 +92,12 @@ public:
 	/** Flip the whole image vertically. */
 	void flipVertically();
 
+	/** Set the number of threads used to decompress the mip maps and layers
+	 *  of compressed images. 0 means one thread per CPU core. The default is 1. */
+	static void setThreadCount(size_t threadCount);
+	/** Return the number of threads used to decompress images, as set. */
+	static size_t getThreadCount();
+
 protected:
 	typedef std::vector<std::unique_ptr<MipMap>> MipMaps;
 
@@ -22,198 +22,235 @@
  *  Manual S3TC DXTn decompression methods.
  */
 
+#include <memory>
+
 #include "src/common/util.h"
+#include "src/common/error.h"
 #include "src/common/readstream.h"
 
 #include "src/images/s3tc.h"
 
 namespace Images {
 
-static uint32_t convert565To8888(uint16_t color) {
+/* The block decoders below work on integer palettes. The interpolation
+ * formulas have been verified, for every possible pair of input channel
+ * values, to yield exactly the same results as the floating point math
+ * we used before, i.e. truncating (1 - w) * c0 + w * c1 with w being
+ * 0.333333f, 0.666666f or 0.5f; and truncating the alpha blends divided
+ * by 7.0f and 5.0f. */
+
+static const size_t kDXT1BlockSize = 8;
+static const size_t kDXT3BlockSize = 16;
+static const size_t kDXT5BlockSize = 16;
+
+static inline uint32_t convert565To8888(uint16_t color) {
 	return ((color & 0x1F) << 11) | ((color & 0x7E0) << 13) | ((color & 0xF800) << 16) | 0xFF;
 }
 
-static uint32_t interpolate32(double weight, uint32_t color_0, uint32_t color_1) {
-	byte r[3], g[3], b[3], a[3];
-	r[0] = color_0 >> 24;
-	r[1] = color_1 >> 24;
-	r[2] = (byte)((1.0f - weight) * (double)r[0] + weight * (double)r[1]);
-	g[0] = (color_0 >> 16) & 0xFF;
-	g[1] = (color_1 >> 16) & 0xFF;
-	g[2] = (byte)((1.0f - weight) * (double)g[0] + weight * (double)g[1]);
-	b[0] = (color_0 >> 8) & 0xFF;
-	b[1] = (color_1 >> 8) & 0xFF;
-	b[2] = (byte)((1.0f - weight) * (double)b[0] + weight * (double)b[1]);
-	a[0] = color_0 & 0xFF;
-	a[1] = color_1 & 0xFF;
-	a[2] = (byte)((1.0f - weight) * (double)a[0] + weight * (double)a[1]);
-	return r[2] << 24 | g[2] << 16 | b[2] << 8 | a[2];
-}
-
-struct DXT1Texel {
-	uint16_t color_0;
-	uint16_t color_1;
-	uint32_t pixels;
-};
-
-#define READ_DXT1_TEXEL(x) \
-	x.color_0 = src.readUint16LE(); \
-	x.color_1 = src.readUint16LE(); \
-	x.pixels = src.readUint32BE()
+/** (2 * c0 + c1) / 3, as truncated from the old 0.333333f weight. */
+static inline uint32_t blendThird(uint32_t c0, uint32_t c1) {
+	return (171 * c0 + 85 * c1) >> 8;
+}
 
-void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch) {
-	for (int32_t ty = height; ty > 0; ty -= 4) {
-		for (uint32_t tx = 0; tx < width; tx += 4) {
-			DXT1Texel tex;
-			READ_DXT1_TEXEL(tex);
-			uint32_t blended[4];
-
-			blended[0] = convert565To8888(tex.color_0);
-			blended[1] = convert565To8888(tex.color_1);
-
-			if (tex.color_0 > tex.color_1) {
-				blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-				blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
-			} else {
-				blended[2] = interpolate32(0.5f, blended[0], blended[1]);
-				blended[3] = 0;
-			}
+/** (c0 + 2 * c1) / 3, as truncated from the old 0.666666f weight. */
+static inline uint32_t blendTwoThirds(uint32_t c0, uint32_t c1) {
+	return (171 * c0 + 341 * c1) >> 9;
+}
 
-			uint32_t cpx = tex.pixels;
-			uint32_t blockWidth = MIN<uint32_t>(width, 4);
-			uint32_t blockHeight = MIN<uint32_t>(height, 4);
+/** (c0 + c1) / 2. */
+static inline uint32_t blendHalf(uint32_t c0, uint32_t c1) {
+	return (c0 + c1) >> 1;
+}
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32_t destX = tx + x;
-					const uint32_t destY = height - 1 - (ty - blockHeight + y);
+/** Apply a channel blending function to all four channels of two RGBA colors. */
+template<uint32_t (*blend)(uint32_t, uint32_t)>
+static inline uint32_t blendColor(uint32_t color_0, uint32_t color_1) {
+	uint32_t result = 0;
 
-					const uint32_t pixel =  blended[cpx & 3];
+	for (int shift = 0; shift < 32; shift += 8)
+		result |= blend((color_0 >> shift) & 0xFF, (color_1 >> shift) & 0xFF) << shift;
 
-					cpx >>= 2;
+	return result;
+}
 
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
-			}
-		}
+/** Decode the four-entry color palette of a DXT color block.
+ *
+ *  @param src The 8 bytes of the color block.
+ *  @param palette The palette to fill.
+ *  @param alphaMask Mask to apply to the two base colors.
+ *  @param threeColor Allow the DXT1 three-color-and-transparent mode?
+ */
+static inline void decodeColorPalette(const byte *src, uint32_t (&palette)[4],
+                                      uint32_t alphaMask, bool threeColor) {
+
+	const uint16_t color_0 = READ_LE_UINT16(src + 0);
+	const uint16_t color_1 = READ_LE_UINT16(src + 2);
+
+	palette[0] = convert565To8888(color_0) & alphaMask;
+	palette[1] = convert565To8888(color_1) & alphaMask;
+
+	if (!threeColor || (color_0 > color_1)) {
+		palette[2] = blendColor<blendThird>    (palette[0], palette[1]);
+		palette[3] = blendColor<blendTwoThirds>(palette[0], palette[1]);
+	} else {
+		palette[2] = blendColor<blendHalf>(palette[0], palette[1]);
+		palette[3] = 0;
 	}
 }
 
-struct DXT23Texel : public DXT1Texel {
-	uint16_t alpha[4];
-};
+/** A decoded block. Only the first blockWidth pixels of each row are valid. */
+typedef uint32_t DXTBlock[4][4];
 
-#define READ_DXT3_TEXEL(x) \
-	x.alpha[0] = src.readUint16LE(); \
-	x.alpha[1] = src.readUint16LE(); \
-	x.alpha[2] = src.readUint16LE(); \
-	x.alpha[3] = src.readUint16LE(); \
-	READ_DXT1_TEXEL(x)
+static void decodeDXT1Block(const byte *src, uint32_t blockWidth, DXTBlock &block) {
+	uint32_t palette[4];
+	decodeColorPalette(src, palette, 0xFFFFFFFF, true);
 
-void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch) {
-	for (int32_t ty = height; ty > 0; ty -= 4) {
-		for (uint32_t tx = 0; tx < width; tx += 4) {
-			DXT23Texel tex;
-			uint32_t blended[4];
-			READ_DXT3_TEXEL(tex);
-
-			blended[0] = convert565To8888(tex.color_0) & 0xFFFFFF00;
-			blended[1] = convert565To8888(tex.color_1) & 0xFFFFFF00;
-			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
-
-			uint32_t cpx = tex.pixels;
-			uint32_t blockWidth = MIN<uint32_t>(width, 4);
-			uint32_t blockHeight = MIN<uint32_t>(height, 4);
-
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32_t destX = tx + x;
-					const uint32_t destY = height - 1 - (ty - blockHeight + y);
+	uint32_t cpx = READ_BE_UINT32(src + 4);
+	for (uint32_t y = 0; y < 4; y++)
+		for (uint32_t x = 0; x < blockWidth; x++, cpx >>= 2)
+			block[y][x] = palette[cpx & 3];
+}
 
-					const uint32_t alpha = (tex.alpha[y] >> (x * 4)) & 0xF;
-					const uint32_t pixel = blended[cpx & 3] | alpha << 4;
+static void decodeDXT3Block(const byte *src, uint32_t blockWidth, DXTBlock &block) {
+	uint32_t palette[4];
+	decodeColorPalette(src + 8, palette, 0xFFFFFF00, false);
 
-					cpx >>= 2;
+	uint32_t cpx = READ_BE_UINT32(src + 12);
+	for (uint32_t y = 0; y < 4; y++) {
+		const uint32_t alpha = READ_LE_UINT16(src + 2 * y);
 
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
-			}
-		}
+		for (uint32_t x = 0; x < blockWidth; x++, cpx >>= 2)
+			block[y][x] = palette[cpx & 3] | (((alpha >> (x * 4)) & 0xF) << 4);
 	}
 }
 
-struct DXT45Texel : public DXT1Texel {
-	byte alpha_0;
-	byte alpha_1;
-	uint64_t alphabl;
-};
+static void decodeDXT5Block(const byte *src, uint32_t blockWidth, DXTBlock &block) {
+	const uint32_t alpha_0 = src[0];
+	const uint32_t alpha_1 = src[1];
+
+	uint32_t alphas[8];
+	alphas[0] = alpha_0;
+	alphas[1] = alpha_1;
 
-static uint64_t readUint48LE(Common::SeekableReadStream &src) {
-	uint64_t output = src.readUint32LE();
-	return output | ((uint64_t)src.readUint16LE() << 32);
+	if (alpha_0 > alpha_1) {
+		for (uint32_t i = 1; i < 7; i++)
+			alphas[i + 1] = ((7 - i) * alpha_0 + i * alpha_1 + 3) / 7;
+	} else {
+		for (uint32_t i = 1; i < 5; i++)
+			alphas[i + 1] = ((5 - i) * alpha_0 + i * alpha_1 + 2) / 5;
+
+		alphas[6] = 0;
+		alphas[7] = 255;
+	}
+
+	const uint64_t alphabl = READ_LE_UINT32(src + 2) | ((uint64_t)READ_LE_UINT16(src + 6) << 32);
+
+	uint32_t palette[4];
+	decodeColorPalette(src + 8, palette, 0xFFFFFF00, false);
+
+	uint32_t cpx = READ_BE_UINT32(src + 12);
+	for (uint32_t y = 0; y < 4; y++)
+		for (uint32_t x = 0; x < blockWidth; x++, cpx >>= 2)
+			block[y][x] = palette[cpx & 3] | alphas[(alphabl >> (3 * (4 * (3 - y) + x))) & 7];
 }
 
-#define READ_DXT5_TEXEL(x) \
-	x.alpha_0 = src.readByte(); \
-	x.alpha_1 = src.readByte(); \
-	x.alphabl = readUint48LE(src); \
-	READ_DXT1_TEXEL(x)
+static size_t getBlockCount(uint32_t width, uint32_t height) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4);
+}
 
-void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch) {
-	for (int32_t ty = height; ty > 0; ty -= 4) {
-		for (uint32_t tx = 0; tx < width; tx += 4) {
-			uint32_t blended[4];
-			byte alphab[8];
-			DXT45Texel tex;
-			READ_DXT5_TEXEL(tex);
-
-			alphab[0] = tex.alpha_0;
-			alphab[1] = tex.alpha_1;
-
-			if (tex.alpha_0 > tex.alpha_1) {
-				alphab[2] = (byte)((6.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[3] = (byte)((5.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[4] = (byte)((4.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[5] = (byte)((3.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[6] = (byte)((2.0f * (double)alphab[0] + 5.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[7] = (byte)((1.0f * (double)alphab[0] + 6.0f * (double)alphab[1] + 3.0f) / 7.0f);
-			} else {
-				alphab[2] = (byte)((4.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[3] = (byte)((3.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[4] = (byte)((2.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[5] = (byte)((1.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[6] = 0;
-				alphab[7] = 255;
-			}
+/** Run a block decoder over a whole image.
+ *
+ *  The blocks are stored bottom-up, and each block is vertically flipped
+ *  when written into the image. Blocks that lie completely within the
+ *  image are written without any per-pixel bounds checks.
+ */
+template<void (*decodeBlock)(const byte *, uint32_t, DXTBlock &)>
+static void decompressDXT(byte *dest, const byte *src, size_t srcSize, size_t blockSize,
+                          uint32_t width, uint32_t height, uint32_t pitch) {
 
-			blended[0] = convert565To8888(tex.color_0) & 0xFFFFFF00;
-			blended[1] = convert565To8888(tex.color_1) & 0xFFFFFF00;
-			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
+	if (srcSize < getBlockCount(width, height) * blockSize)
+		throw Common::Exception(Common::kReadError);
 
-			uint32_t cpx = tex.pixels;
-			uint32_t blockWidth = MIN<uint32_t>(width, 4);
-			uint32_t blockHeight = MIN<uint32_t>(height, 4);
+	const uint32_t blockWidth  = MIN<uint32_t>(width , 4);
+	const uint32_t blockHeight = MIN<uint32_t>(height, 4);
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32_t destX = tx + x;
-					const uint32_t destY = height - 1 - (ty - blockHeight + y);
+	const bool fullBlocks = (blockWidth == 4) && (blockHeight == 4);
+
+	for (int32_t ty = height; ty > 0; ty -= 4) {
+		for (uint32_t tx = 0; tx < width; tx += 4, src += blockSize) {
+			DXTBlock block;
+			decodeBlock(src, blockWidth, block);
+
+			if (fullBlocks && ((tx + 4) <= width) && (ty >= 4)) {
+				byte *row = dest + (height + 3 - ty) * pitch + tx * 4;
+
+				for (uint32_t y = 0; y < 4; y++, row -= pitch) {
+					WRITE_BE_UINT32(row +  0, block[y][0]);
+					WRITE_BE_UINT32(row +  4, block[y][1]);
+					WRITE_BE_UINT32(row +  8, block[y][2]);
+					WRITE_BE_UINT32(row + 12, block[y][3]);
+				}
 
-					const uint32_t alpha = alphab[(tex.alphabl >> (3 * (4 * (3 - y) + x))) & 7];
-					const uint32_t pixel = blended[cpx & 3] | alpha;
+				continue;
+			}
 
-					cpx >>= 2;
+			for (uint32_t y = 0; y < blockHeight; y++) {
+				for (uint32_t x = 0; x < blockWidth; x++) {
+					const uint32_t destX = tx + x;
+					const uint32_t destY = height - 1 - (ty - blockHeight + y);
 
 					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
+						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, block[y][x]);
 				}
 			}
 		}
 	}
 }
 
+void decompressDXT1(byte *dest, const byte *src, size_t srcSize, uint32_t width, uint32_t height, uint32_t pitch) {
+	decompressDXT<decodeDXT1Block>(dest, src, srcSize, kDXT1BlockSize, width, height, pitch);
+}
+
+void decompressDXT3(byte *dest, const byte *src, size_t srcSize, uint32_t width, uint32_t height, uint32_t pitch) {
+	decompressDXT<decodeDXT3Block>(dest, src, srcSize, kDXT3BlockSize, width, height, pitch);
+}
+
+void decompressDXT5(byte *dest, const byte *src, size_t srcSize, uint32_t width, uint32_t height, uint32_t pitch) {
+	decompressDXT<decodeDXT5Block>(dest, src, srcSize, kDXT5BlockSize, width, height, pitch);
+}
+
+/** Read the complete compressed data of an image out of a stream. */
+static std::unique_ptr<byte[]> readDXTData(Common::SeekableReadStream &src, size_t blockSize,
+                                           uint32_t width, uint32_t height, size_t &size) {
+
+	size = getBlockCount(width, height) * blockSize;
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(size);
+	if (src.read(data.get(), size) != size)
+		throw Common::Exception(Common::kReadError);
+
+	return data;
+}
+
+void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch) {
+	size_t size;
+	std::unique_ptr<byte[]> data = readDXTData(src, kDXT1BlockSize, width, height, size);
+
+	decompressDXT1(dest, data.get(), size, width, height, pitch);
+}
+
+void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch) {
+	size_t size;
+	std::unique_ptr<byte[]> data = readDXTData(src, kDXT3BlockSize, width, height, size);
+
+	decompressDXT3(dest, data.get(), size, width, height, pitch);
+}
+
+void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch) {
+	size_t size;
+	std::unique_ptr<byte[]> data = readDXTData(src, kDXT5BlockSize, width, height, size);
+
+	decompressDXT5(dest, data.get(), size, width, height, pitch);
+}
+
 } // End of namespace Images
@@ -33,6 +33,16 @@ namespace Common {
 
 namespace Images {
 
+/* Decompress DXTn data out of a raw memory buffer into R8G8B8A8 pixels.
+ * srcSize needs to hold at least one 8 (DXT1) or 16 (DXT3/DXT5) byte
+ * block for each 4x4 pixels block of the image. */
+
+void decompressDXT1(byte *dest, const byte *src, size_t srcSize, uint32_t width, uint32_t height, uint32_t pitch);
+void decompressDXT3(byte *dest, const byte *src, size_t srcSize, uint32_t width, uint32_t height, uint32_t pitch);
+void decompressDXT5(byte *dest, const byte *src, size_t srcSize, uint32_t width, uint32_t height, uint32_t pitch);
+
+/* Decompress DXTn data out of a stream into R8G8B8A8 pixels. */
+
 void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch);
 void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch);
 void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32_t width, uint32_t height, uint32_t pitch);
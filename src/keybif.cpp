@@ -23,6 +23,7 @@
  */
 
 #include <set>
+#include <vector>
 
 #include "src/aurora/keydatafile.h"
 #include "src/common/error.h"
@@ -30,11 +31,14 @@
 #include "src/common/cli.h"
 #include "src/common/readfile.h"
 #include "src/common/writefile.h"
+#include "src/common/stdoutstream.h"
 #include "src/common/filepath.h"
+#include "src/common/lzma.h"
 
 #include "src/aurora/bifwriter.h"
 #include "src/aurora/bzfwriter.h"
 #include "src/aurora/keywriter.h"
+#include "src/aurora/compression.h"
 #include "src/aurora/util.h"
 
 #include "src/util.h"
@@ -45,7 +49,8 @@ struct BIFGroup {
 };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Common::UString &keyfile, std::set<Common::UString> &files);
+                      Common::UString &keyfile, std::set<Common::UString> &files,
+                      Aurora::CompressionOptions &compressionOptions, bool &printStatistics, uint32_t &jobs);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -57,10 +62,19 @@ int main(int argc, char **argv) {
 		int returnValue = 1;
 		Common::UString keyFile;
 		std::set<Common::UString> files;
+		uint32_t jobs = 1;
 
-		if (!parseCommandLine(args, returnValue, keyFile, files))
+		Aurora::CompressionOptions compressionOptions;
+		bool printStatistics = false;
+
+		if (!parseCommandLine(args, returnValue, keyFile, files, compressionOptions, printStatistics, jobs))
 			return returnValue;
 
+		if ((compressionOptions.level < -1) || (compressionOptions.level > (int)Common::kLZMALevelBest))
+			throw Common::Exception("Invalid compression level %d", compressionOptions.level);
+
+		Aurora::CompressionStatistics statistics;
+
 		Aurora::KEYWriter keyWriter;
 
 		std::list<BIFGroup> groups;
@@ -90,28 +104,41 @@ int main(int argc, char **argv) {
 			std::unique_ptr<Aurora::KEYDataWriter> dataFile;
 
 			if (group.name.endsWith(".bzf"))
-				dataFile = std::make_unique<Aurora::BZFWriter>(group.files.size(), writeBIFFile);
+				dataFile = std::make_unique<Aurora::BZFWriter>(group.files.size(), writeBIFFile, jobs, compressionOptions,
+				                                               printStatistics ? &statistics : nullptr);
 			else
 				dataFile = std::make_unique<Aurora::BIFWriter>(group.files.size(), writeBIFFile);
 
-			size_t i = 1;
-			for (const auto &file : group.files) {
-				std::printf("\tPacking %u/%u: %s ... ", (uint)i, static_cast<uint>(group.files.size()), file.c_str());
+			/* When compressing on several threads, a file is only done once it has
+			 * been written, after its compression finished. So report it then. */
+			const std::vector<Common::UString> fileList(group.files.begin(), group.files.end());
+			dataFile->setWrittenCallback([&fileList](size_t index) {
+				std::printf("\tPacking %u/%u: %s ... Done\n", (uint)(index + 1), static_cast<uint>(fileList.size()),
+				            fileList[index].c_str());
 				std::fflush(stdout);
+			});
 
+			for (const auto &file : group.files) {
 				Common::ReadFile packFile(file);
 				dataFile->add(packFile, TypeMan.getFileType(file));
-
-				++i;
-
-				std::printf("Done\n");
 			}
 
+			dataFile->flush();
+			writeBIFFile.flush();
+
 			keyWriter.addBIF(group.name, group.files, dataFile->size());
 		}
 
 		Common::WriteFile writeFile(keyFile);
 		keyWriter.write(writeFile);
+		writeFile.flush();
+
+		if (printStatistics && !statistics.getTypes().empty()) {
+			std::printf("\n");
+
+			Common::StdOutStream out;
+			statistics.write(out);
+		}
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -120,7 +147,8 @@ int main(int argc, char **argv) {
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Common::UString &keyfile, std::set<Common::UString> &files) {
+                      Common::UString &keyfile, std::set<Common::UString> &files,
+                      Aurora::CompressionOptions &compressionOptions, bool &printStatistics, uint32_t &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -139,5 +167,20 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 				  returnValue,
 				  makeEndArgs(&archiveOpt, &filesOpt));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Compress .bzf files using this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("level", "Compression level for .bzf files, from 0 (fastest) to 9 (best) "
+	                 "(default: 6)", kContinueParsing, new ValGetter<int32_t &>(compressionOptions.level, "n"));
+	parser.addOption("extreme", "Compress .bzf files using the slower, extreme variant of the level",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, compressionOptions.lzmaExtreme)));
+	parser.addOption("fast-incompressible", "Compress files that look incompressible as fast as possible",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, compressionOptions.fastIncompressible)));
+	parser.addOption("stats", "Print compression statistics per file type",
+	                 kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, printStatistics)));
+
 	return parser.process(argv);
 }
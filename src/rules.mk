@@ -23,6 +23,7 @@
 
 noinst_HEADERS += \
     src/util.h \
+    src/batch.h \
     $(EMPTY)
 
 # The individual tools
@@ -43,6 +44,7 @@ bin_PROGRAMS += src/gff2xml
 src_gff2xml_SOURCES = \
     src/gff2xml.cpp \
     src/util.cpp \
+    src/batch.cpp \
     $(EMPTY)
 src_gff2xml_LDADD = \
     src/xml/libxml.la \
@@ -352,6 +354,7 @@ bin_PROGRAMS += src/xml2gff
 src_xml2gff_SOURCES = \
     src/xml2gff.cpp \
     src/util.cpp \
+    src/batch.cpp \
     $(EMPTY)
 src_xml2gff_LDADD = \
     src/xml/libxml.la \
@@ -35,6 +35,7 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedreadfile.h"
 #include "src/common/md5.h"
 #include "src/common/cli.h"
 
@@ -59,7 +60,7 @@ const char *kCommandChar[kCommandMAX] = { "i", "l", "v", "e", "x" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive, std::set<Common::UString> &files,
-                      Aurora::GameID &game, std::vector<byte> &password);
+                      Aurora::GameID &game, std::vector<byte> &password, uint32_t &jobs);
 
 bool parsePassword(const Common::UString &arg, std::vector<byte> &password);
 bool readNWMMD5   (const Common::UString &arg, std::vector<byte> &password);
@@ -80,13 +81,18 @@ int main(int argc, char **argv) {
 		Common::UString archive;
 		std::set<Common::UString> files;
 		std::vector<byte> password;
+		uint32_t jobs = 1;
 
-		if (!parseCommandLine(args, returnValue, command, archive, files, game, password))
+		if (!parseCommandLine(args, returnValue, command, archive, files, game, password, jobs))
 			return returnValue;
 
-		Aurora::ERFFile erf(new Common::ReadFile(archive), password);
+		Aurora::ERFFile erf(Common::MappedReadFile::openFile(archive), password);
 		files = Archives::fixPathSeparator(files);
 
+		const Archives::ArchiveOpener opener = [&archive, &password]() {
+			return new Aurora::ERFFile(Common::MappedReadFile::openFile(archive), password);
+		};
+
 		if      (command == kCommandInfo)
 			displayInfo(erf);
 		else if (command == kCommandList)
@@ -94,9 +100,9 @@ int main(int argc, char **argv) {
 		else if (command == kCommandListVerbose)
 			Archives::listFiles(erf, game, true);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(erf, game, false, files);
+			Archives::extractFiles(erf, game, false, files, jobs, opener);
 		else if (command == kCommandExtractDir)
-			Archives::extractFiles(erf, game, true, files);
+			Archives::extractFiles(erf, game, true, files, jobs, opener);
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -162,7 +168,7 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive, std::set<Common::UString> &files,
-                      Aurora::GameID &game, std::vector<byte> &password) {
+                      Aurora::GameID &game, std::vector<byte> &password, uint32_t &jobs) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -202,6 +208,9 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 "Neverwinter Nights premium module file(for decrypting their HAK file)",
 	                 kContinueParsing,
 	                 new Callback<std::vector<byte> &>("file", readNWMMD5, password));
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Extract using this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 
 	return parser.process(argv);
 }
@@ -28,6 +28,7 @@
 #include <list>
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 #include "src/version/version.h"
 
@@ -37,6 +38,8 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/mappedreadfile.h"
 #include "src/common/filepath.h"
 #include "src/common/cli.h"
 
@@ -45,6 +48,7 @@
 #include "src/aurora/keydatafile.h"
 #include "src/aurora/biffile.h"
 #include "src/aurora/bzffile.h"
+#include "src/aurora/keyindexcache.h"
 
 #include "src/archives/util.h"
 
@@ -60,20 +64,35 @@ enum Command {
 const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game);
+                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game,
+                      uint32_t &jobs, Common::UString &cacheFile);
 
 uint32_t getFileID(const Common::UString &fileName);
 void identifyFiles(const std::list<Common::UString> &files, std::vector<Common::UString> &keyFiles,
                    std::vector<Common::UString> &bifFiles);
 
 void openKEYs(const std::vector<Common::UString> &keyFiles, std::vector<std::unique_ptr<Aurora::KEYFile>> &keys);
+Aurora::KEYDataFile *openKEYDataFile(const Common::UString &dataFile);
 void openKEYDataFiles(const std::vector<Common::UString> &dataFiles, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData);
 
+void mergeKEYDataFile(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, Aurora::KEYDataFile &dataFile,
+                      const Common::UString &dataFileName);
 void mergeKEYDataFiles(std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData,
                        const std::vector<Common::UString> &dataFiles);
 
+Aurora::KEYIndexCache *openCache(const Common::UString &cacheFile, const std::list<Common::UString> &files);
+void loadCache(const Aurora::KEYIndexCache &cache, const std::list<Common::UString> &files,
+               std::vector<Common::UString> &keyFiles, std::vector<Common::UString> &dataFiles,
+               std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData);
+void writeCache(const Common::UString &cacheFile, const std::list<Common::UString> &files,
+                const std::vector<Common::UString> &keyFiles, const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys,
+                const std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData);
+
 void listFiles(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, const std::vector<Common::UString> &keyFiles, Aurora::GameID game);
-void extractFiles(const std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData, const std::vector<Common::UString> &dataFiles, Aurora::GameID game);
+void extractFiles(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys,
+                  const std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData,
+                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game, uint32_t jobs,
+                  const Aurora::KEYIndexCache *cache);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -87,25 +106,42 @@ int main(int argc, char **argv) {
 		int returnValue = 1;
 		Command command = kCommandNone;
 		std::list<Common::UString> files;
+		uint32_t jobs = 1;
+		Common::UString cacheFile;
 
-		if (!parseCommandLine(args, returnValue, command, files, game))
+		if (!parseCommandLine(args, returnValue, command, files, game, jobs, cacheFile))
 			return returnValue;
 
 		std::vector<Common::UString> keyFiles, dataFiles;
-		identifyFiles(files, keyFiles, dataFiles);
 
 		std::vector<std::unique_ptr<Aurora::KEYFile>> keys;
 		std::vector<std::unique_ptr<Aurora::KEYDataFile>> keyData;
 
-		openKEYs(keyFiles, keys);
-		openKEYDataFiles(dataFiles, keyData);
+		std::unique_ptr<Aurora::KEYIndexCache> cache;
+		if (!cacheFile.empty()) {
+			cacheFile = Common::FilePath::absolutize(cacheFile);
+
+			cache.reset(openCache(cacheFile, files));
+		}
+
+		if (cache) {
+			loadCache(*cache, files, keyFiles, dataFiles, keys, keyData);
+		} else {
+			identifyFiles(files, keyFiles, dataFiles);
+
+			openKEYs(keyFiles, keys);
+			openKEYDataFiles(dataFiles, keyData);
+
+			mergeKEYDataFiles(keys, keyData, dataFiles);
 
-		mergeKEYDataFiles(keys, keyData, dataFiles);
+			if (!cacheFile.empty())
+				writeCache(cacheFile, files, keyFiles, keys, keyData);
+		}
 
 		if      (command == kCommandList)
 			listFiles(keys, keyFiles, game);
 		else if (command == kCommandExtract)
-			extractFiles(keyData, dataFiles, game);
+			extractFiles(keys, keyData, dataFiles, game, jobs, cache.get());
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -131,7 +167,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game) {
+                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game,
+                      uint32_t &jobs, Common::UString &cacheFile) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::Parser;
@@ -161,6 +198,12 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("jade", "Alias file types according to Jade Empire rules",
 	                 Common::CLI::kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::GameID>(Aurora::kGameIDJade, game)));
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Extract using this many threads (0: one per CPU core)",
+	                 Common::CLI::kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("cache", 'c', "Keep the resource index in this file, and reuse it "
+	                 "while none of the KEY and BIF/BZF files changed",
+	                 Common::CLI::kContinueParsing, new ValGetter<Common::UString &>(cacheFile, "file"));
 
 	return parser.process(argv);
 }
@@ -199,19 +242,22 @@ void openKEYs(const std::vector<Common::UString> &keyFiles, std::vector<std::uni
 	}
 }
 
+Aurora::KEYDataFile *openKEYDataFile(const Common::UString &dataFile) {
+	if (Common::FilePath::getExtension(dataFile).equalsIgnoreCase(".bzf"))
+		return new Aurora::BZFFile(Common::MappedReadFile::openFile(dataFile));
+
+	return new Aurora::BIFFile(Common::MappedReadFile::openFile(dataFile));
+}
+
 void openKEYDataFiles(const std::vector<Common::UString> &dataFiles, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData) {
 	keyData.reserve(dataFiles.size());
 
-	for (const auto &dataFile : dataFiles) {
-		if (Common::FilePath::getExtension(dataFile).equalsIgnoreCase(".bzf"))
-			keyData.emplace_back(std::make_unique<Aurora::BZFFile>(new Common::ReadFile(dataFile)));
-		else
-			keyData.emplace_back(std::make_unique<Aurora::BIFFile>(new Common::ReadFile(dataFile)));
-	}
+	for (const auto &dataFile : dataFiles)
+		keyData.emplace_back(openKEYDataFile(dataFile));
 }
 
-void mergeKEYDataFiles(std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData,
-                       const std::vector<Common::UString> &dataFiles) {
+void mergeKEYDataFile(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, Aurora::KEYDataFile &dataFile,
+                      const Common::UString &dataFileName) {
 
 	// Go over all KEYs
 	for (auto &key : keys) {
@@ -221,19 +267,86 @@ void mergeKEYDataFiles(std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, std:
 		for (size_t keyBIFIndex = 0; keyBIFIndex < keyBifs.size(); keyBIFIndex++) {
 			const Common::UString &keyBIF = keyBifs[keyBIFIndex];
 
-			// Go over all BIFs
-			for (size_t dataFileIndex = 0; dataFileIndex < dataFiles.size(); dataFileIndex++) {
-				const Common::UString &dataFileName = dataFiles[dataFileIndex];
-				Aurora::KEYDataFile &dataFile = *keyData[dataFileIndex];
+			if (Common::FilePath::getStem(keyBIF).equalsIgnoreCase(Common::FilePath::getStem(dataFileName)))
+				dataFile.mergeKEY(*key, keyBIFIndex);
+		}
 
-				if (Common::FilePath::getStem(keyBIF).equalsIgnoreCase(Common::FilePath::getStem(dataFileName)))
-					dataFile.mergeKEY(*key, keyBIFIndex);
-			}
+	}
 
-		}
+}
+
+void mergeKEYDataFiles(std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData,
+                       const std::vector<Common::UString> &dataFiles) {
+
+	// Go over all BIFs
+	for (size_t dataFileIndex = 0; dataFileIndex < dataFiles.size(); dataFileIndex++)
+		mergeKEYDataFile(keys, *keyData[dataFileIndex], dataFiles[dataFileIndex]);
+}
 
+Aurora::KEYIndexCache *openCache(const Common::UString &cacheFile, const std::list<Common::UString> &files) {
+	if (!Common::FilePath::isRegularFile(cacheFile))
+		return 0;
+
+	Aurora::KEYIndexCache::FileList fileList;
+	fileList.reserve(files.size());
+
+	for (const auto &file : files)
+		fileList.emplace_back(file);
+
+	try {
+		std::unique_ptr<Aurora::KEYIndexCache> cache =
+			std::make_unique<Aurora::KEYIndexCache>(Common::MappedReadFile::openFile(cacheFile));
+
+		if (cache->isCurrent(fileList))
+			return cache.release();
+
+	} catch (Common::Exception &e) {
+		e.add("Failed reading KEY index cache \"%s\"", cacheFile.c_str());
+		Common::printException(e, "WARNING: ");
+	}
+
+	return 0;
+}
+
+void loadCache(const Aurora::KEYIndexCache &cache, const std::list<Common::UString> &files,
+               std::vector<Common::UString> &keyFiles, std::vector<Common::UString> &dataFiles,
+               std::vector<std::unique_ptr<Aurora::KEYFile>> &keys, std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData) {
+
+	// The cache is current, so it lists the same files in the same order
+	const Aurora::KEYIndexCache::FileList &cacheFiles = cache.getFiles();
+
+	Aurora::KEYIndexCache::FileList::const_iterator cacheFile = cacheFiles.begin();
+	for (std::list<Common::UString>::const_iterator file = files.begin(); file != files.end(); ++file, ++cacheFile) {
+		if (cacheFile->isKEY) {
+			keys.emplace_back(cache.createKEY(keyFiles.size()));
+			keyFiles.push_back(*file);
+		} else {
+			keyData.emplace_back(cache.createDataFile(dataFiles.size(), Common::MappedReadFile::openFile(*file)));
+			dataFiles.push_back(*file);
+		}
 	}
+}
+
+void writeCache(const Common::UString &cacheFile, const std::list<Common::UString> &files,
+                const std::vector<Common::UString> &keyFiles, const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys,
+                const std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData) {
+
+	Aurora::KEYIndexCache::FileList fileList;
+	fileList.reserve(files.size());
+
+	for (const auto &file : files)
+		fileList.emplace_back(file, std::find(keyFiles.begin(), keyFiles.end(), file) != keyFiles.end());
+
+	try {
+		Common::WriteFile cache(cacheFile);
 
+		Aurora::KEYIndexCache::write(cache, fileList, keys, keyData);
+
+		cache.flush();
+	} catch (Common::Exception &e) {
+		e.add("Failed writing KEY index cache \"%s\"", cacheFile.c_str());
+		Common::printException(e, "WARNING: ");
+	}
 }
 
 void listFiles(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys,
@@ -247,15 +360,29 @@ void listFiles(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys,
 	}
 }
 
-void extractFiles(const std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData,
-                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game) {
+void extractFiles(const std::vector<std::unique_ptr<Aurora::KEYFile>> &keys,
+                  const std::vector<std::unique_ptr<Aurora::KEYDataFile>> &keyData,
+                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game, uint32_t jobs,
+                  const Aurora::KEYIndexCache *cache) {
 
 	for (size_t i = 0; i < keyData.size(); i++) {
 		std::printf("%s: %s indexed files (of %u)\n\n", dataFiles[i].c_str(),
 		            Common::composeString(keyData[i]->getResources().size()).c_str(),
                 keyData[i]->getInternalResourceCount());
 
-		Archives::extractFiles(*keyData[i], game, false, std::set<Common::UString>());
+		const Common::UString &dataFileName = dataFiles[i];
+
+		Archives::extractFiles(*keyData[i], game, false, std::set<Common::UString>(), jobs,
+		                       [&keys, &dataFileName, cache, i]() {
+
+			if (cache)
+				return cache->createDataFile(i, Common::MappedReadFile::openFile(dataFileName));
+
+			std::unique_ptr<Aurora::KEYDataFile> dataFile(openKEYDataFile(dataFileName));
+			mergeKEYDataFile(keys, *dataFile, dataFileName);
+
+			return dataFile.release();
+		});
 
 		if (i < (keyData.size() - 1))
 			std::printf("\n");
@@ -29,208 +29,180 @@
 
 namespace XML {
 
-void GFF3Creator::create(const XML::XMLNode &root, uint32_t id, Common::WriteStream &file, uint32_t version) {
-	Aurora::GFF3Writer gff3(id, version);
+/** Read count float components out of the child elements of the current element. */
+static void readComponents(XMLReader &xml, float *values, size_t count, const char *type) {
+	size_t n = 0;
 
-	if (root.getChildren().size() > 1)
-		throw Common::Exception("GFF3Creator::create() More than one root struct");
+	while (xml.nextChild()) {
+		if (n >= count)
+			throw Common::Exception("GFF3Creator::readStructContents() Invalid size of %s components", type);
 
-	if (root.getChildren().size() == 0)
-		throw Common::Exception("GFF3Creator::create() No root struct");
+		const Common::UString value = xml.readContent();
+		if (value.empty())
+			throw Common::Exception("GFF3Creator::readStructContents() %s components empty", type);
+
+		Common::parseString(value, values[n++]);
+	}
 
-	const XML::XMLNode &rootStruct = *root.getChildren().front();
+	if (n != count)
+		throw Common::Exception("GFF3Creator::readStructContents() Invalid size of %s components", type);
+}
+
+void GFF3Creator::create(XMLReader &xml, uint32_t id, Common::WriteStream &file, uint32_t version,
+                         bool deduplicateData) {
 
-	Common::parseString(rootStruct.getProperty("id"), id);
+	Aurora::GFF3Writer gff3(id, version, deduplicateData);
+
+	if (!xml.nextChild())
+		throw Common::Exception("GFF3Creator::create() No root struct");
+
+	Common::parseString(xml.getProperty("id"), id);
 	if (id != 0xFFFFFFFF)
 		throw Common::Exception("GFF3Creator::create() Invalid root struct id");
 
-	readStructContents(rootStruct.getChildren(), gff3.getTopLevel());
+	readStructContents(xml, gff3.getTopLevel());
+
+	if (xml.nextChild())
+		throw Common::Exception("GFF3Creator::create() More than one root struct");
 
 	gff3.write(file);
 }
 
-void GFF3Creator::readStructContents(const XMLNode::Children &strctNodes, Aurora::GFF3WriterStructPtr strctPtr) {
-	for (const auto &strctNode : strctNodes) {
-		if (strctNode->getName() == "byte") {
+void GFF3Creator::readStructContents(XMLReader &xml, Aurora::GFF3WriterStructPtr strctPtr) {
+	while (xml.nextChild()) {
+		const Common::UString name  = xml.getName();
+		const Common::UString label = xml.getProperty("label");
+
+		if (name == "byte") {
 			uint8_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addByte(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "char") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addByte(label, value);
+		} else if (name == "char") {
 			int8_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addChar(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "sint16") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addChar(label, value);
+		} else if (name == "sint16") {
 			int16_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addSint16(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "float") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addSint16(label, value);
+		} else if (name == "float") {
 			float value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addFloat(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "float") {
-			double value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addDouble(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "sint32") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addFloat(label, value);
+		} else if (name == "sint32") {
 			int32_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addSint32(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "sint64") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addSint32(label, value);
+		} else if (name == "sint64") {
 			int64_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addSint64(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "uint16_t") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addSint64(label, value);
+		} else if (name == "uint16_t") {
 			uint16_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addUint16(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "uint32_t") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addUint16(label, value);
+		} else if (name == "uint32_t") {
 			uint32_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addUint32(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "uint64_t") {
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addUint32(label, value);
+		} else if (name == "uint64_t") {
 			uint64_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addUint64(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "exostring") {
-			const XMLNode *text = strctNode->findChild("text");
-			if (text) {
-				bool base64 = false;
-				Common::parseString(strctNode->getProperty("base64"), base64, true);
-
-				const Common::UString contents = text->getContent();
-				if (base64) {
-					Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
-					strctPtr->addExoString(strctNode->getProperty("label"), debase64);
-
-				} else
-					strctPtr->addExoString(strctNode->getProperty("label"), contents);
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addUint64(label, value);
+		} else if (name == "exostring") {
+			bool base64 = false;
+			Common::parseString(xml.getProperty("base64"), base64, true);
 
-			} else
-				strctPtr->addExoString(strctNode->getProperty("label"), "");
-
-		} else if (strctNode->getName() == "strref") {
-			uint32_t value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addStrRef(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "resref") {
-			const XMLNode *text = strctNode->findChild("text");
-			if (text) {
-				bool base64 = false;
-				Common::parseString(strctNode->getProperty("base64"), base64, true);
-
-				const Common::UString contents = text->getContent();
-				if (base64) {
-					Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
-					strctPtr->addResRef(strctNode->getProperty("label"), debase64);
-
-				} else
-					strctPtr->addResRef(strctNode->getProperty("label"), contents);
+			const Common::UString contents = xml.readContent();
+			if (base64 && !contents.empty()) {
+				Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
+				strctPtr->addExoString(label, debase64);
 
 			} else
-				strctPtr->addResRef(strctNode->getProperty("label"), "");
+				strctPtr->addExoString(label, contents);
 
-		} else if (strctNode->getName() == "data") {
-			const XMLNode *textNode = strctNode->findChild("text");
-			Common::UString text = textNode ? textNode->getContent() : "";
-
-			Common::SeekableReadStream *debase64 = Common::decodeBase64(text);
-			strctPtr->addVoid(strctNode->getProperty("label"), debase64);
-		} else if (strctNode->getName() == "vector") {
-			float x, y, z;
-
-			if (strctNode->getChildren().size() != 3)
-				throw Common::Exception("GFF3Creator::readStructContents() Invalid size of vector components");
-
-			XMLNode::Children::const_iterator iter = strctNode->getChildren().begin();
-			const XMLNode *xValue = (*iter++)->findChild("text");
-			const XMLNode *yValue = (*iter++)->findChild("text");
-			const XMLNode *zValue = (*iter++)->findChild("text");
-
-			if (!xValue || !yValue || !zValue)
-				throw Common::Exception("GFF3Creator::readStructContents() Vector components empty");
-
-			Common::parseString(xValue->getContent(), x);
-			Common::parseString(yValue->getContent(), y);
-			Common::parseString(zValue->getContent(), z);
-
-			strctPtr->addVector(strctNode->getProperty("label"), x, y, z);
-		} else if (strctNode->getName() == "orientation") {
-			float x, y, z, w;
-
-			if (strctNode->getChildren().size() != 4)
-				throw Common::Exception("GFF3Creator::readStructContents() Invalid size of orientation components");
-
-			XMLNode::Children::const_iterator iter = strctNode->getChildren().begin();
-			const XMLNode *xValue = (*iter++)->findChild("text");
-			const XMLNode *yValue = (*iter++)->findChild("text");
-			const XMLNode *zValue = (*iter++)->findChild("text");
-			const XMLNode *wValue = (*iter++)->findChild("text");
-
-			if (!xValue || !yValue || !zValue)
-				throw Common::Exception("GFF3Creator::readStructContents() Orientation components empty");
+		} else if (name == "strref") {
+			uint32_t value;
+			Common::parseString(xml.readContent(), value);
+			strctPtr->addStrRef(label, value);
+		} else if (name == "resref") {
+			bool base64 = false;
+			Common::parseString(xml.getProperty("base64"), base64, true);
 
-			Common::parseString(xValue->getContent(), x);
-			Common::parseString(yValue->getContent(), y);
-			Common::parseString(zValue->getContent(), z);
-			Common::parseString(wValue->getContent(), w);
+			const Common::UString contents = xml.readContent();
+			if (base64 && !contents.empty()) {
+				Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
+				strctPtr->addResRef(label, debase64);
 
-			strctPtr->addOrientation(strctNode->getProperty("label"), x, y, z, w);
-		} else if (strctNode->getName() == "locstring") {
+			} else
+				strctPtr->addResRef(label, contents);
+
+		} else if (name == "data") {
+			Common::SeekableReadStream *debase64 = Common::decodeBase64(xml.readContent());
+			strctPtr->addVoid(label, debase64);
+		} else if (name == "vector") {
+			float v[3];
+			readComponents(xml, v, 3, "vector");
+
+			strctPtr->addVector(label, v[0], v[1], v[2]);
+		} else if (name == "orientation") {
+			float o[4];
+			readComponents(xml, o, 4, "orientation");
+
+			strctPtr->addOrientation(label, o[0], o[1], o[2], o[3]);
+		} else if (name == "locstring") {
 			uint32_t strref;
 			Aurora::LocString locString;
 
-			Common::parseString(strctNode->getProperty("strref"), strref);
+			Common::parseString(xml.getProperty("strref"), strref);
 			locString.setID(strref);
 
-			if (!strctNode->getChildren().empty()) {
-				for (const auto &child : strctNode->getChildren()) {
-					if (child->getName() != "string")
-						throw Common::Exception("GFF3Creator::readStructContents() Invalid LocString string");
+			while (xml.nextChild()) {
+				if (xml.getName() != "string")
+					throw Common::Exception("GFF3Creator::readStructContents() Invalid LocString string");
 
-					const XMLNode *text = child->findChild("text");
-
-					uint32_t id;
-					Common::parseString(child->getProperty("language"), id);
-					locString.setStringRawLanguageID(id, text ? text->getContent() : "");
-				}
+				uint32_t id;
+				Common::parseString(xml.getProperty("language"), id);
+				locString.setStringRawLanguageID(id, xml.readContent());
 			}
 
-			strctPtr->addLocString(strctNode->getProperty("label"), locString);
-		} else if (strctNode->getName() == "struct") {
-			Common::UString idText = strctNode->getProperty("id");
+			strctPtr->addLocString(label, locString);
+		} else if (name == "struct") {
+			Common::UString idText = xml.getProperty("id");
 
 			Aurora::GFF3WriterStructPtr strct = nullptr;
 			if (!idText.empty()) {
 				uint32_t id;
 				Common::parseString(idText, id);
-				strct = strctPtr->addStruct(strctNode->getProperty("label"), id);
+				strct = strctPtr->addStruct(label, id);
 			} else
-				strct = strctPtr->addStruct(strctNode->getProperty("label"));
+				strct = strctPtr->addStruct(label);
 
-			readStructContents(strctNode->getChildren(), strct);
-		} else if (strctNode->getName() == "list") {
-			Aurora::GFF3WriterListPtr list = strctPtr->addList(strctNode->getProperty("label"));
-			readListContents(strctNode->getChildren(), list);
-		}
+			readStructContents(xml, strct);
+		} else if (name == "list") {
+			Aurora::GFF3WriterListPtr list = strctPtr->addList(label);
+			readListContents(xml, list);
+		} else
+			xml.skipElement();
 	}
 }
 
-void GFF3Creator::readListContents(const XMLNode::Children &listNodes, Aurora::GFF3WriterListPtr listPtr) {
-	for (const auto &node : listNodes) {
-		if (node->getName() != "struct")
+void GFF3Creator::readListContents(XMLReader &xml, Aurora::GFF3WriterListPtr listPtr) {
+	while (xml.nextChild()) {
+		if (xml.getName() != "struct")
 			throw Common::Exception("GFF3Creator::readListContents() Invalid element in list");
 
-		Common::UString idText = node->getProperty("id");
+		Common::UString idText = xml.getProperty("id");
 
 		Aurora::GFF3WriterStructPtr strct = nullptr;
 		if (!idText.empty()) {
 			uint32_t id;
 			Common::parseString(idText, id);
-			strct = listPtr->addStruct(node->getProperty("label"), id);
+			strct = listPtr->addStruct(xml.getProperty("label"), id);
 		} else
-			strct = listPtr->addStruct(node->getProperty("label"));
+			strct = listPtr->addStruct(xml.getProperty("label"));
 
-		readStructContents(node->getChildren(), strct);
+		readStructContents(xml, strct);
 	}
 }
 
@@ -35,11 +35,17 @@ namespace XML {
 
 class GFF3Creator {
 public:
-	static void create(const XML::XMLNode &root, uint32_t id, Common::WriteStream &file, uint32_t version);
+	/** Create a GFF3 out of the contents of the XML reader's current element.
+	 *
+	 *  If deduplicateData is true, raw data fields with identical contents
+	 *  share their field data. See Aurora::GFF3Writer.
+	 */
+	static void create(XMLReader &xml, uint32_t id, Common::WriteStream &file, uint32_t version,
+	                   bool deduplicateData = false);
 
 private:
-	static void readStructContents(const XMLNode::Children &strctNodes, Aurora::GFF3WriterStructPtr strctPtr);
-	static void readListContents(const XMLNode::Children &listNodes, Aurora::GFF3WriterListPtr listPtr);
+	static void readStructContents(XMLReader &xml, Aurora::GFF3WriterStructPtr strctPtr);
+	static void readListContents(XMLReader &xml, Aurora::GFF3WriterListPtr listPtr);
 };
 
 } // End of namespace XML
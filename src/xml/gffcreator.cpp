@@ -41,18 +41,18 @@ static uint32_t getGFF3Version(GFFCreator::GFF3Version v) {
 }
 
 void GFFCreator::create(Common::WriteStream &output, Common::ReadStream &input, const Common::UString &inputFileName,
-		GFF3Version gff3Version) {
+		GFF3Version gff3Version, bool deduplicateData) {
 
-	XMLParser xml(input, true, inputFileName);
+	XMLReader xml(input, true, inputFileName);
+	if (!xml.nextChild())
+		throw Common::Exception("XML document has no root node");
 
-	const XMLNode &xmlRoot = xml.getRoot();
-
-	const Common::UString type = xmlRoot.getProperty("type") + "    ";
+	const Common::UString type = xml.getProperty("type") + "    ";
 	const uint32_t typeId = MKTAG(*type.getPosition(0), *type.getPosition(1), *type.getPosition(2), *type.getPosition(3));
 
-	if (xmlRoot.getName() == "gff3") {
-		XML::GFF3Creator::create(xmlRoot, typeId, output, getGFF3Version(gff3Version));
-	} else if (xmlRoot.getName() == "gff4") {
+	if (xml.getName() == "gff3") {
+		XML::GFF3Creator::create(xml, typeId, output, getGFF3Version(gff3Version), deduplicateData);
+	} else if (xml.getName() == "gff4") {
 		throw Common::Exception("TODO: Add GFF4 writer support");
 	} else {
 		throw Common::Exception("GFFCreator::create() invalid root tag");
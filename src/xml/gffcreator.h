@@ -43,7 +43,8 @@ public:
 		V3_3
 	};
 
-	static void create(Common::WriteStream &output, Common::ReadStream &input, const Common::UString &inputFileName, GFF3Version gff3Version);
+	static void create(Common::WriteStream &output, Common::ReadStream &input, const Common::UString &inputFileName,
+	                   GFF3Version gff3Version, bool deduplicateData = false);
 };
 
 } // End of namespace XML
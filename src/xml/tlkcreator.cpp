@@ -43,14 +43,15 @@ void TLKCreator::create(Common::WriteStream &output, Common::ReadStream &input,
 	if ((version != kVersion30) && (version != kVersion40))
 		throw Common::Exception("Invalid TLK version");
 
-	XMLParser xml(input, true, inputFileName);
-	const XMLNode &xmlRoot = xml.getRoot();
+	XMLReader xml(input, true, inputFileName);
+	if (!xml.nextChild())
+		throw Common::Exception("XML document has no root node");
 
-	if (xmlRoot.getName() != "tlk")
+	if (xml.getName() != "tlk")
 		throw Common::Exception("XML does not describe a TLK");
 
 	if (languageID == 0xFFFFFFFF) {
-		const Common::UString xmlLanguage = xmlRoot.getProperty("language");
+		const Common::UString xmlLanguage = xml.getProperty("language");
 
 		if (!xmlLanguage.empty())
 			Common::parseString(xmlLanguage, languageID, true);
@@ -67,44 +68,28 @@ void TLKCreator::create(Common::WriteStream &output, Common::ReadStream &input,
 
 	Aurora::TalkTable_TLK tlk(encoding, languageID);
 
-	const XMLNode::Children &strings = xmlRoot.getChildren();
-
-	// Look at the ID of the last string entry, and create a dummy entry to speed up re-allocation
-	if (!strings.empty()) {
-		uint32_t lastID = 0xFFFFFFFF;
-
-		XMLNode::Children::const_iterator last = --strings.end();
-		Common::parseString((*last)->getProperty("id"), lastID, true);
-
-		if (lastID != 0xFFFFFFFF)
-			tlk.setEntry(lastID, "", "", 0, 0, -1.0f, 0xFFFFFFFF);
-	}
-
-	for (XMLNode::Children::const_iterator s = strings.begin(); s != strings.end(); ++s) {
-		if ((*s)->getName() != "string")
+	while (xml.nextChild()) {
+		if (xml.getName() != "string")
 			throw Common::Exception("XML tag \"string\" expected");
 
-		const Common::UString xmlID = (*s)->getProperty("id");
+		const Common::UString xmlID = xml.getProperty("id");
 		if (xmlID.empty())
 			throw Common::Exception("XML property \"id\" expected");
 
 		uint32_t strRef = 0xFFFFFFFF;
 		Common::parseString(xmlID, strRef, false);
 
-		Common::UString string;
-		const XMLNode *text = (*s)->findChild("text");
-		if (text)
-			string = text->getContent();
-
-		const Common::UString soundResRef = (*s)->getProperty("sound");
+		const Common::UString soundResRef = xml.getProperty("sound");
 
 		uint32_t volumeVariance = 0, pitchVariance = 0, soundID = 0xFFFFFFFF;
-		Common::parseString((*s)->getProperty("volumevariance"), volumeVariance, true);
-		Common::parseString((*s)->getProperty("pitchvariance" ), pitchVariance , true);
-		Common::parseString((*s)->getProperty("soundid"       ), soundID       , true);
+		Common::parseString(xml.getProperty("volumevariance"), volumeVariance, true);
+		Common::parseString(xml.getProperty("pitchvariance" ), pitchVariance , true);
+		Common::parseString(xml.getProperty("soundid"       ), soundID       , true);
 
 		float soundLength = -1.0f;
-		Common::parseString((*s)->getProperty("soundlength"), soundLength, true);
+		Common::parseString(xml.getProperty("soundlength"), soundLength, true);
+
+		const Common::UString string = xml.readContent();
 
 		tlk.setEntry(strRef, string, soundResRef, volumeVariance, pitchVariance, soundLength, soundID);
 	}
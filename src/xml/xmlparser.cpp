@@ -25,9 +25,13 @@
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
+
+#include <mutex>
 
 #include <libxml/parser.h>
 #include <libxml/xmlerror.h>
+#include <libxml/xmlreader.h>
 
 #include <boost/scope_exit.hpp>
 
@@ -53,6 +57,20 @@ static void errorFuncUString(void *ctx, const char *msg, ...) {
 	*str += buf;
 }
 
+static void errorFuncReader(void *arg, const char *msg, xmlParserSeverities UNUSED(severity),
+                            xmlTextReaderLocatorPtr locator) {
+
+	Common::UString *str = static_cast<Common::UString *>(arg);
+	assert(str);
+
+	xmlChar *fileName = xmlTextReaderLocatorBaseURI(locator);
+	const int line = xmlTextReaderLocatorLineNumber(locator);
+
+	*str += Common::UString::format("%s:%d: %s", fileName ? reinterpret_cast<const char *>(fileName) : "", line, msg);
+
+	xmlFree(fileName);
+}
+
 static int readStream(void *context, char *buffer, int len) {
 	Common::ReadStream *stream = static_cast<Common::ReadStream *>(context);
 	if (!stream)
@@ -65,15 +83,29 @@ static int closeStream(void *UNUSED(context)) {
 	return 0;
 }
 
-static void initXML() {
-	// Initialize libxml2 and make sure the library version matches
-	LIBXML_TEST_VERSION
-}
-
 static void deinitXML() {
 	xmlCleanupParser();
 }
 
+static void initXML() {
+	/* libxml2's global state must only be set up once per process, and may only be
+	 * torn down again after every thread is done with it. So initialize it the first
+	 * time we need it and clean up when the process exits. */
+	static std::once_flag initialized;
+
+	std::call_once(initialized, []() {
+		// Initialize libxml2 and make sure the library version matches
+		LIBXML_TEST_VERSION
+
+		xmlInitParser();
+		std::atexit(deinitXML);
+	});
+}
+
+
+static const int kParseOptions = XML_PARSE_NOWARNING | XML_PARSE_NOBLANKS | XML_PARSE_NONET |
+                                 XML_PARSE_NSCLEAN   | XML_PARSE_NOCDATA;
+
 
 XMLParser::XMLParser(Common::ReadStream &stream, bool makeLower, const Common::UString &fileName) {
 	initXML();
@@ -81,11 +113,8 @@ XMLParser::XMLParser(Common::ReadStream &stream, bool makeLower, const Common::U
 	Common::UString parseError;
 	xmlSetGenericErrorFunc(static_cast<void *>(&parseError), errorFuncUString);
 
-	const int options = XML_PARSE_NOWARNING | XML_PARSE_NOBLANKS | XML_PARSE_NONET |
-	                    XML_PARSE_NSCLEAN   | XML_PARSE_NOCDATA;
-
 	xmlDocPtr xml = xmlReadIO(readStream, closeStream, static_cast<void *>(&stream),
-	                          fileName.c_str(), 0, options);
+	                          fileName.c_str(), 0, kParseOptions);
 	if (!xml) {
 		Common::Exception e;
 
@@ -105,8 +134,6 @@ XMLParser::XMLParser(Common::ReadStream &stream, bool makeLower, const Common::U
 		throw Common::Exception("XML document has no root node");
 
 	_rootNode.reset(new XMLNode(*root, makeLower));
-
-	deinitXML();
 }
 
 XMLParser::~XMLParser() {
@@ -184,4 +211,161 @@ void XMLNode::load(_xmlNode &node, bool makeLower) {
 	}
 }
 
+
+XMLReader::XMLReader(Common::ReadStream &stream, bool makeLower, const Common::UString &fileName) :
+	_reader(0), _makeLower(makeLower), _level(0), _emptyElement(false) {
+
+	initXML();
+
+	_reader = xmlReaderForIO(readStream, closeStream, static_cast<void *>(&stream),
+	                         fileName.c_str(), 0, kParseOptions);
+	if (!_reader)
+		throw Common::Exception("Failed to create XML reader");
+
+	xmlTextReaderSetErrorHandler(_reader, errorFuncReader, static_cast<void *>(&_parseError));
+}
+
+XMLReader::~XMLReader() {
+	xmlFreeTextReader(_reader);
+}
+
+void XMLReader::throwParseError() {
+	Common::Exception e;
+
+	if (!_parseError.empty())
+		e.add("%s", _parseError.c_str());
+
+	e.add("XML document failed to parse");
+	throw e;
+}
+
+bool XMLReader::read() {
+	const int result = xmlTextReaderRead(_reader);
+	if (result < 0)
+		throwParseError();
+
+	return result == 1;
+}
+
+void XMLReader::readElement() {
+	const xmlChar *name = xmlTextReaderConstLocalName(_reader);
+
+	_name = name ? reinterpret_cast<const char *>(name) : "";
+	if (_makeLower)
+		_name.makeLower();
+
+	_emptyElement = xmlTextReaderIsEmptyElement(_reader) == 1;
+
+	_properties.clear();
+	while (xmlTextReaderMoveToNextAttribute(_reader) == 1) {
+		const xmlChar *attribName  = xmlTextReaderConstLocalName(_reader);
+		const xmlChar *attribValue = xmlTextReaderConstValue(_reader);
+
+		_properties.push_back(Property());
+
+		Property &property = _properties.back();
+
+		property.name  = attribName  ? reinterpret_cast<const char *>(attribName)  : "";
+		property.value = attribValue ? reinterpret_cast<const char *>(attribValue) : "";
+
+		if (_makeLower)
+			property.name.makeLower();
+	}
+
+	xmlTextReaderMoveToElement(_reader);
+
+	_level++;
+}
+
+bool XMLReader::nextChild() {
+	if (_emptyElement) {
+		// An empty element has no children and no end tag to wait for
+		_emptyElement = false;
+		_level--;
+
+		return false;
+	}
+
+	while (read()) {
+		const int type  = xmlTextReaderNodeType(_reader);
+		const int depth = xmlTextReaderDepth(_reader);
+		if (depth < 0)
+			throwParseError();
+
+		if        ((type == XML_READER_TYPE_ELEMENT) && ((size_t) depth == _level)) {
+			readElement();
+			return true;
+
+		} else if ((type == XML_READER_TYPE_END_ELEMENT) && (((size_t) depth + 1) == _level)) {
+			_level--;
+			return false;
+		}
+	}
+
+	if (_level > 0)
+		throw Common::Exception("Unexpected end of XML document");
+
+	return false;
+}
+
+void XMLReader::readToEnd(std::string *content) {
+	if (_level == 0)
+		throw Common::Exception("No current XML element");
+
+	if (_emptyElement) {
+		_emptyElement = false;
+		_level--;
+
+		return;
+	}
+
+	while (read()) {
+		const int type  = xmlTextReaderNodeType(_reader);
+		const int depth = xmlTextReaderDepth(_reader);
+		if (depth < 0)
+			throwParseError();
+
+		if ((type == XML_READER_TYPE_END_ELEMENT) && (((size_t) depth + 1) == _level)) {
+			_level--;
+			return;
+		}
+
+		if (!content || ((size_t) depth != _level))
+			continue;
+
+		if ((type == XML_READER_TYPE_TEXT) || (type == XML_READER_TYPE_CDATA) ||
+		    (type == XML_READER_TYPE_WHITESPACE) || (type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE)) {
+
+			const xmlChar *value = xmlTextReaderConstValue(_reader);
+			if (value)
+				*content += reinterpret_cast<const char *>(value);
+		}
+	}
+
+	throw Common::Exception("Unexpected end of XML document");
+}
+
+Common::UString XMLReader::readContent() {
+	std::string content;
+	readToEnd(&content);
+
+	return content;
+}
+
+void XMLReader::skipElement() {
+	readToEnd(0);
+}
+
+const Common::UString &XMLReader::getName() const {
+	return _name;
+}
+
+Common::UString XMLReader::getProperty(const Common::UString &name, const Common::UString &def) const {
+	for (std::vector<Property>::const_iterator p = _properties.begin(); p != _properties.end(); ++p)
+		if (p->name == name)
+			return p->value;
+
+	return def;
+}
+
 } // End of namespace XML
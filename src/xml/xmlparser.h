@@ -27,6 +27,8 @@
 
 #include <list>
 #include <map>
+#include <vector>
+#include <string>
 #include <memory>
 
 #include <boost/noncopyable.hpp>
@@ -34,6 +36,7 @@
 #include "src/common/ustring.h"
 
 struct _xmlNode;
+struct _xmlTextReader;
 
 namespace Common {
 	class ReadStream;
@@ -110,6 +113,84 @@ private:
 	friend class XMLParser;
 };
 
+/** Class to read an XML file out of a ReadStream, one element at a time.
+ *
+ *  Unlike the XMLParser, which builds a complete tree of the whole document
+ *  up-front, the XMLReader only ever holds the current element in memory.
+ *  The document is walked in order, with a simple cursor interface:
+ *
+ *  - nextChild() moves to the next child element of the current element,
+ *    which then becomes the current element. Initially, the current element
+ *    is the document itself, so the first call moves to the root element.
+ *  - Once the end of the current element is reached, nextChild() returns
+ *    false, and the parent becomes the current element again.
+ *  - Alternatively, readContent() returns the text of the current element,
+ *    and skipElement() ignores it. Both leave the current element, making
+ *    its parent the current element again.
+ *
+ *  So every element nextChild() moved to has to be left with exactly one
+ *  of these methods: nextChild() returning false, readContent() or
+ *  skipElement().
+ */
+class XMLReader : boost::noncopyable {
+public:
+	/** Start reading an XML file out of a stream.
+	 *
+	 *  @param stream The stream to read the XML from.
+	 *  @param makeLower Should all tags be converted to lowercase, to ease case-insensitive comparison?
+	 *  @param fileName The file name to tell libxml2. Only used for error reporting.
+	 */
+	XMLReader(Common::ReadStream &stream, bool makeLower = false,
+	          const Common::UString &fileName = "stream.xml");
+	~XMLReader();
+
+	/** Move to the next child element of the current element.
+	 *
+	 *  @return true if a child element was found, which is now the current element.
+	 *          false if the end of the current element was reached instead.
+	 */
+	bool nextChild();
+
+	/** Read the text of the current element, ignoring all its child elements, and leave it. */
+	Common::UString readContent();
+	/** Leave the current element, ignoring all its text and child elements. */
+	void skipElement();
+
+	/** Return the name of the current element. */
+	const Common::UString &getName() const;
+
+	/** Return a certain property on the current element. */
+	Common::UString getProperty(const Common::UString &name, const Common::UString &def = "") const;
+
+private:
+	struct Property {
+		Common::UString name;
+		Common::UString value;
+	};
+
+	_xmlTextReader *_reader;
+
+	bool _makeLower;
+
+	Common::UString _parseError;
+
+	Common::UString _name;
+	std::vector<Property> _properties;
+
+	size_t _level;      ///< The number of elements we're currently in.
+	bool _emptyElement; ///< Is the current element an empty element without an end tag?
+
+
+	/** Read the next node, returning false at the end of the document. */
+	bool read();
+	/** Make the element the reader is positioned on the current element. */
+	void readElement();
+	/** Read until the end of the current element and leave it, collecting its direct text if wanted. */
+	void readToEnd(std::string *content);
+
+	void throwParseError();
+};
+
 } // End of namespace XML
 
 #endif // XML_XMLPARSER_H
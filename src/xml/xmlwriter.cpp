@@ -22,6 +22,10 @@
  *  Utility class for writing XML files.
  */
 
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
 #include "src/common/writestream.h"
@@ -29,9 +33,49 @@
 
 #include "src/xml/xmlwriter.h"
 
+static const size_t kBufferSize = 64 * 1024;
+
+/** The number of raw bytes encoded into one line of (64) base64 characters. */
+static const size_t kBase64LineSize  = 48;
+/** The number of raw bytes read and encoded in one go. */
+static const size_t kBase64ChunkSize = 256 * kBase64LineSize;
+
 namespace XML {
 
-XMLWriter::XMLWriter(Common::WriteStream &stream) : _stream(&stream), _needIndent(false) {
+/** Return the entity a character needs to be escaped as, or 0 if it can be written as-is. */
+static const char *getEntity(char c) {
+	switch (c) {
+		case '\"':
+			return "&quot;";
+		case '\'':
+			return "&apos;";
+		case '&':
+			return "&amp;";
+		case '<':
+			return "&lt;";
+		case '>':
+			return "&gt;";
+		case '\r':
+			return "&#13;";
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+/** Read from the stream until the buffer is full or the stream is exhausted. */
+static size_t readChunk(Common::ReadStream &stream, byte *data, size_t size) {
+	size_t n = 0, r = 0;
+	while ((n < size) && ((r = stream.read(data + n, size - n)) > 0))
+		n += r;
+
+	return n;
+}
+
+XMLWriter::XMLWriter(Common::WriteStream &stream) : _stream(&stream), _needIndent(false),
+	_buffer(std::make_unique<byte[]>(kBufferSize)), _bufferFill(0) {
+
 	writeHeader();
 }
 
@@ -46,11 +90,46 @@ void XMLWriter::flush() {
 	while (!_openTags.empty())
 		closeTag();
 
+	flushBuffer();
 	_stream->flush();
 }
 
+void XMLWriter::flushBuffer() {
+	if (_bufferFill == 0)
+		return;
+
+	const size_t size = _bufferFill;
+	_bufferFill = 0;
+
+	if (_stream->write(_buffer.get(), size) != size)
+		throw Common::Exception(Common::kWriteError);
+}
+
+void XMLWriter::write(const char *data, size_t size) {
+	if (size > (kBufferSize - _bufferFill))
+		flushBuffer();
+
+	if (size >= kBufferSize) {
+		if (_stream->write(data, size) != size)
+			throw Common::Exception(Common::kWriteError);
+
+		return;
+	}
+
+	std::memcpy(_buffer.get() + _bufferFill, data, size);
+	_bufferFill += size;
+}
+
+void XMLWriter::write(const char *str) {
+	write(str, std::strlen(str));
+}
+
+void XMLWriter::write(const Common::UString &str) {
+	write(str.c_str());
+}
+
 void XMLWriter::writeHeader() {
-	_stream->writeString("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n");
+	write("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n");
 	flush();
 }
 
@@ -66,8 +145,9 @@ void XMLWriter::openTag(const Common::UString &name) {
 
 	Tag &tag = _openTags.back();
 
-	tag.name  = name;
-	tag.empty = true;
+	tag.name    = name;
+	tag.written = false;
+	tag.empty   = true;
 }
 
 void XMLWriter::closeTag() {
@@ -80,7 +160,10 @@ void XMLWriter::closeTag() {
 
 	if (!tag.empty) {
 		indent(_openTags.size() - 1);
-		_stream->writeString("</" + tag.name + ">");
+
+		write("</");
+		write(tag.name);
+		write(">");
 	}
 
 	_openTags.pop_back();
@@ -94,39 +177,54 @@ void XMLWriter::writeTag() {
 
 	tag.written = true;
 
-	_stream->writeString("<" + tag.name);
+	write("<");
+	write(tag.name);
 
-	for (std::list<Property>::const_iterator p = tag.properties.begin(); p != tag.properties.end(); ++p)
-		_stream->writeString(" " + p->name + "=\"" + escape(p->value) + "\"");
+	for (std::vector<Property>::const_iterator p = tag.properties.begin(); p != tag.properties.end(); ++p) {
+		write(" ");
+		write(p->name);
+		write("=\"");
+		writeEscaped(p->value);
+		write("\"");
+	}
 
 	if (tag.empty)
-		_stream->writeString("/");
+		write("/");
 
-	_stream->writeString(">");
+	write(">");
 
-	if (!tag.empty) {
-		if (!tag.base64.empty()) {
+	if (!tag.empty)
+		writeEscaped(tag.contents);
+}
 
-			if (tag.base64.size() == 1) {
+void XMLWriter::writeBase64(Common::ReadStream &stream) {
+	byte data[kBase64ChunkSize];
+	char line[(kBase64LineSize / 3) * 4];
 
-				_stream->writeString(tag.base64.front());
-				tag.base64.pop_front();
+	size_t size = readChunk(stream, data, kBase64ChunkSize);
 
-			} else {
+	// Data that fits into a single line is written directly into the tag
+	if (size <= kBase64LineSize) {
+		write(line, Common::encodeBase64(data, size, line));
+		return;
+	}
 
-				while (!tag.base64.empty()) {
-					breakLine();
-					indent(_openTags.size());
-					_stream->writeString(tag.base64.front());
-					tag.base64.pop_front();
-				}
-				breakLine();
+	// Longer data is broken into indented lines, between the opening and closing tag
+	const size_t level = _openTags.size();
 
-			}
+	do {
+		for (size_t pos = 0; pos < size; pos += kBase64LineSize) {
+			write("\n");
+			_needIndent = true;
 
-		} else
-			_stream->writeString(escape(tag.contents));
-	}
+			indent(level);
+			write(line, Common::encodeBase64(data + pos, MIN(kBase64LineSize, size - pos), line));
+		}
+
+	} while ((size = readChunk(stream, data, kBase64ChunkSize)) > 0);
+
+	write("\n");
+	_needIndent = true;
 }
 
 void XMLWriter::indent(size_t level) {
@@ -134,35 +232,30 @@ void XMLWriter::indent(size_t level) {
 		return;
 
 	while (level-- > 0)
-		_stream->writeString("  ");
+		write("  ", 2);
 
 	_needIndent = false;
 }
 
-Common::UString XMLWriter::escape(const Common::UString &str) {
-	Common::UString escaped;
+void XMLWriter::writeEscaped(const Common::UString &str) {
+	/* Only a few ASCII characters need to be escaped, so we can look at the
+	 * UTF-8 data directly and write runs of clean characters in one go. */
+
+	const char *run = str.c_str();
+	const char *c   = run;
 
-	for (Common::UString::iterator s = str.begin(); s != str.end(); ++s) {
-		uint32_t c = *s;
+	for (; *c != '\0'; ++c) {
+		const char *entity = getEntity(*c);
+		if (!entity)
+			continue;
 
-		if      (c == '\"')
-			escaped += "&quot;";
-		else if (c == '\'')
-			escaped += "&apos;";
-		else if (c == '&')
-			escaped += "&amp;";
-		else if (c == '<')
-			escaped += "&lt;";
-		else if (c == '>')
-			escaped += "&gt;";
-		else if (c == '\r')
-			escaped += "&#13;";
-		else
-			escaped += c;
+		write(run, c - run);
+		write(entity);
 
+		run = c + 1;
 	}
 
-	return escaped;
+	write(run, c - run);
 }
 
 void XMLWriter::addProperty(const Common::UString &name, const Common::UString &value) {
@@ -185,25 +278,13 @@ void XMLWriter::setContents(const Common::UString &contents) {
 
 	Tag &tag = _openTags.back();
 
-	tag.base64.clear();
-
 	tag.contents = contents;
 	tag.empty    = false;
 }
 
 void XMLWriter::setContents(const byte *data, size_t size) {
-	if (_openTags.empty())
-		return;
-
-	Tag &tag = _openTags.back();
-
-	tag.base64.clear();
-	tag.contents.clear();
-
 	Common::MemoryReadStream stream(data, size);
-	Common::encodeBase64(stream, tag.base64, 64);
-
-	tag.empty = false;
+	setContents(stream);
 }
 
 void XMLWriter::setContents(Common::SeekableReadStream &stream) {
@@ -212,12 +293,11 @@ void XMLWriter::setContents(Common::SeekableReadStream &stream) {
 
 	Tag &tag = _openTags.back();
 
-	tag.base64.clear();
 	tag.contents.clear();
-
-	Common::encodeBase64(stream, tag.base64, 64);
-
 	tag.empty = false;
+
+	writeTag();
+	writeBase64(stream);
 }
 
 void XMLWriter::breakLine() {
@@ -226,7 +306,7 @@ void XMLWriter::breakLine() {
 		writeTag();
 	}
 
-	_stream->writeString("\n");
+	write("\n");
 	_needIndent = true;
 }
 
@@ -25,19 +25,27 @@
 #ifndef XML_XMLWRITER_H
 #define XML_XMLWRITER_H
 
-#include <list>
+#include <vector>
+#include <memory>
 
 #include <boost/noncopyable.hpp>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 namespace Common {
+	class ReadStream;
 	class SeekableReadStream;
 	class WriteStream;
 }
 
 namespace XML {
 
+/** Utility class for writing XML files.
+ *
+ *  All output is collected in an internal buffer and only handed to the
+ *  underlying stream in large blocks, when the buffer is full or on flush().
+ */
 class XMLWriter : boost::noncopyable {
 public:
 	XMLWriter(Common::WriteStream &stream);
@@ -55,9 +63,18 @@ public:
 	void addProperty(const Common::UString &name, const Common::UString &value);
 	/** Set contents to this string, which will be properly escaped. */
 	void setContents(const Common::UString &contents);
-	/** Set the contents to binary data, which will be base64 encoded. */
+	/** Set the contents to binary data, which will be base64 encoded.
+	 *
+	 *  The tag is written out immediately, with the data encoded on the fly,
+	 *  so all properties of the tag have to be added before.
+	 */
 	void setContents(const byte *data, size_t size);
-	/** Set the contents to binary data, which will be base64 encoded. */
+	/** Set the contents to binary data, which will be base64 encoded.
+	 *
+	 *  The tag is written out immediately, with the data encoded on the fly
+	 *  in chunks straight from the stream, so all properties of the tag have
+	 *  to be added before.
+	 */
 	void setContents(Common::SeekableReadStream &stream);
 
 	/** Add a line break. */
@@ -72,10 +89,9 @@ private:
 	struct Tag {
 		Common::UString name;
 
-		std::list<Property> properties;
+		std::vector<Property> properties;
 
 		Common::UString contents;
-		std::list<Common::UString> base64;
 
 		bool written;
 		bool empty;
@@ -83,16 +99,29 @@ private:
 
 	Common::WriteStream *_stream;
 
-	std::list<Tag> _openTags;
+	std::vector<Tag> _openTags;
 	bool _needIndent;
 
+	std::unique_ptr<byte[]> _buffer; ///< The output buffer.
+	size_t _bufferFill;              ///< The number of bytes in the output buffer.
+
 
 	void writeHeader();
 
 	void indent(size_t level);
 	void writeTag();
 
-	Common::UString escape(const Common::UString &str);
+	void writeBase64(Common::ReadStream &stream);
+
+	/** Write the string, escaping all characters special to XML. */
+	void writeEscaped(const Common::UString &str);
+
+	void write(const char *data, size_t size);
+	void write(const char *str);
+	void write(const Common::UString &str);
+
+	/** Hand the contents of the output buffer to the stream. */
+	void flushBuffer();
 };
 
 } // End of namespace XML
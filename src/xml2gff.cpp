@@ -36,6 +36,7 @@
 #include "src/common/stdinstream.h"
 #include "src/common/encoding.h"
 #include "src/common/cli.h"
+#include "src/common/filepath.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/language.h"
@@ -43,17 +44,22 @@
 #include "src/xml/gffcreator.h"
 
 #include "src/util.h"
+#include "src/batch.h"
 
 typedef std::map<uint32_t, Common::Encoding> EncodingOverrides;
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Aurora::GameID &game, EncodingOverrides &encOverrides,
-                      XML::GFFCreator::GFF3Version &gff3Version);
+                      XML::GFFCreator::GFF3Version &gff3Version, bool &dedup,
+                      bool &batch, uint32_t &jobs);
 
 bool parseEncodingOverride(const Common::UString &arg, EncodingOverrides &encOverrides);
 
-void createGFF(const Common::UString &inFile, const Common::UString &outFile, XML::GFFCreator::GFF3Version gff3Version);
+void createGFF(const Common::UString &inFile, const Common::UString &outFile, XML::GFFCreator::GFF3Version gff3Version,
+               bool dedup);
+size_t createGFFs(const Common::UString &source, const Common::UString &outDir,
+                  XML::GFFCreator::GFF3Version gff3Version, bool dedup, size_t jobs);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -66,10 +72,14 @@ int main(int argc, char **argv) {
 		EncodingOverrides encOverrides;
 		XML::GFFCreator::GFF3Version gff3Version = XML::GFFCreator::GFF3Version::Unknown;
 
+		bool dedup = false;
+		bool batch = false;
+		uint32_t jobs = 1;
+
 		int returnValue = 1;
 		Common::UString inFile, outFile;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, game, encOverrides, gff3Version))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, game, encOverrides, gff3Version, dedup, batch, jobs))
 			return returnValue;
 
 		LangMan.declareLanguages(game);
@@ -84,7 +94,10 @@ int main(int argc, char **argv) {
 				gff3Version = XML::GFFCreator::GFF3Version::V3_2;
 		}
 
-		createGFF(inFile, outFile, gff3Version);
+		if (batch)
+			return (createGFFs(inFile, outFile, gff3Version, dedup, jobs) == 0) ? 0 : 1;
+
+		createGFF(inFile, outFile, gff3Version, dedup);
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -119,7 +132,8 @@ bool parseEncodingOverride(const Common::UString &arg, EncodingOverrides &encOve
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Aurora::GameID &game, EncodingOverrides &encOverrides,
-                      XML::GFFCreator::GFF3Version &gff3Version) {
+                      XML::GFFCreator::GFF3Version &gff3Version, bool &dedup,
+                      bool &batch, uint32_t &jobs) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -148,11 +162,21 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              "for a specific language ID. The string has to be of the form n=encoding,\n"
 	              "for example 0=cp-1252 to override the encoding of the (ungendered) language\n"
 	              "ID 0 to be Windows codepage 1252. To override several encodings, specify\n"
-	              "the --encoding parameter multiple times.\n",
+	              "the --encoding parameter multiple times.\n\n"
+	              "In batch mode, the input is either a directory, of which all .xml files\n"
+	              "are converted recursively, or a text file listing one input file per\n"
+	              "line. The output is then a directory, mirroring the input paths and\n"
+	              "removing the \".xml\" extension from each file name.\n",
 	              returnValue,
 	              makeEndArgs(&inFileOpt, &outFileOpt));
 
 	parser.addSpace();
+	parser.addOption("batch", 'b', "Convert all files of a directory or list file", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of files to convert in parallel in batch mode "
+	                 "(0: one per CPU core)", kContinueParsing,
+	                 new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addSpace();
 	parser.addOption("nwn", "Use Neverwinter Nights encodings", kContinueParsing,
 	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDNWN, game)));
 	parser.addOption("nwn2", "Use Neverwinter Nights 2 encodings", kContinueParsing,
@@ -177,15 +201,38 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 makeAssigners(new ValAssigner<GFFCreator::GFF3Version>(GFFCreator::GFF3Version::V3_2, gff3Version)));
 	parser.addOption("v33", "Create GFF3 V3.3 file (default for The Witcher)", kContinueParsing,
 	                 makeAssigners(new ValAssigner<GFFCreator::GFF3Version>(GFFCreator::GFF3Version::V3_3, gff3Version)));
+	parser.addOption("dedup", "Share the data of GFF3 void and raw string fields "
+	                 "with identical contents", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, dedup)));
 
 	return parser.process(argv);
 }
 
-void createGFF(const Common::UString &inFile, const Common::UString &outFile, XML::GFFCreator::GFF3Version gff3Version) {
+void createGFF(const Common::UString &inFile, const Common::UString &outFile, XML::GFFCreator::GFF3Version gff3Version,
+               bool dedup) {
+
 	std::unique_ptr<Common::ReadStream> xml(openFileOrStdIn(inFile));
 	std::unique_ptr<Common::WriteStream> gff(openFileOrStdOut(outFile));
 
-	XML::GFFCreator::create(*gff, *xml, inFile, gff3Version);
+	XML::GFFCreator::create(*gff, *xml, inFile, gff3Version, dedup);
 
 	gff->flush();
 }
+
+size_t createGFFs(const Common::UString &source, const Common::UString &outDir,
+                  XML::GFFCreator::GFF3Version gff3Version, bool dedup, size_t jobs) {
+
+	BatchFiles files;
+	collectBatchFiles(source, outDir, [](const Common::UString &file) {
+		return Common::FilePath::getExtension(file).equalsIgnoreCase(".xml");
+	}, [](const Common::UString &file) {
+		if (Common::FilePath::getExtension(file).equalsIgnoreCase(".xml"))
+			return Common::FilePath::changeExtension(file);
+
+		return file + ".gff";
+	}, files);
+
+	return runBatch(files, jobs, [=](const BatchFile &file) {
+		createGFF(file.inFile, file.outFile, gff3Version, dedup);
+	});
+}
@@ -52,7 +52,7 @@
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
-                      Aurora::FileType &type, bool &flip, bool &deswizzle);
+                      Aurora::FileType &type, bool &flip, bool &deswizzle, uint32_t &jobs);
 
 void convert(const Common::UString &inFile, const Common::UString &outFile,
              Aurora::FileType type, bool flip, bool deswizzle);
@@ -68,10 +68,13 @@ int main(int argc, char **argv) {
 		Common::UString inFile, outFile;
 		Aurora::FileType type = Aurora::kFileTypeNone;
 		bool flip = false, deswizzle = false;
+		uint32_t jobs = 1;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, type, flip, deswizzle))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, type, flip, deswizzle, jobs))
 			return returnValue;
 
+		Images::Decoder::setThreadCount(jobs);
+
 		convert(inFile, outFile, type, flip, deswizzle);
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -82,7 +85,7 @@ int main(int argc, char **argv) {
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
-                      Aurora::FileType &type, bool &flip, bool &deswizzle) {
+                      Aurora::FileType &type, bool &flip, bool &deswizzle, uint32_t &jobs) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -119,6 +122,9 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addSpace();
 	parser.addOption("deswizzle", 'd', "Input file is an Xbox SBM that needs deswizzling",
 	                 kContinueParsing, makeAssigners(new ValAssigner<bool>(true, deswizzle)));
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Decompress mip maps using this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 	return parser.process(argv);
 }
 
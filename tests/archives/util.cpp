@@ -0,0 +1,121 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our archive utility functions.
+ */
+
+#include <string>
+#include <vector>
+#include <set>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/platform.h"
+#include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/erffile.h"
+
+#include "src/archives/util.h"
+
+class ArchivesUtil : public ::testing::Test {
+protected:
+	boost::filesystem::path _oldPath;
+	boost::filesystem::path _tmpPath;
+
+	void SetUp() {
+		Common::Platform::init();
+
+		_tmpPath = boost::filesystem::temp_directory_path() /
+		           boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		boost::filesystem::create_directories(_tmpPath);
+
+		// The files are extracted into the current directory
+		_oldPath = boost::filesystem::current_path();
+		boost::filesystem::current_path(_tmpPath);
+	}
+
+	void TearDown() {
+		boost::filesystem::current_path(_oldPath);
+		boost::filesystem::remove_all(_tmpPath);
+	}
+};
+
+static std::string readTestFile(const boost::filesystem::path &path) {
+	boost::filesystem::ifstream testFile(path, std::ofstream::binary);
+
+	return std::string(std::istreambuf_iterator<char>(testFile), std::istreambuf_iterator<char>());
+}
+
+GTEST_TEST_F(ArchivesUtil, extractFilesSameNameThreaded) {
+	static const size_t kFileCount = 32;
+	static const size_t kFileSize  = 65536;
+
+	/* Every other resource lives in its own directory, but they all have the same
+	 * file name. With the directories stripped, they're all extracted to "dup.txt",
+	 * and the last one has to win. The other half have unique names, and there's
+	 * also an exact duplicate of one of them. */
+	std::vector<std::string> data;
+	for (size_t i = 0; i < kFileCount; i++)
+		data.push_back(std::string(kFileSize, static_cast<char>('A' + i)));
+
+	{
+		Common::WriteFile erfFile("test.erf");
+		Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), kFileCount + 1, erfFile, Aurora::ERFWriter::kERFVersion20);
+
+		for (size_t i = 0; i < kFileCount; i++) {
+			const Common::UString name = (i % 2) ? Common::UString::format("unique%u", (uint)i) :
+			                                       Common::UString::format("dir%u\\dup", (uint)i);
+
+			Common::MemoryReadStream stream(reinterpret_cast<const byte *>(data[i].c_str()), data[i].size());
+
+			erfWriter.add(name, Aurora::kFileTypeTXT, stream);
+		}
+
+		Common::MemoryReadStream stream(reinterpret_cast<const byte *>("Foobar"), 6);
+
+		erfWriter.add("unique1", Aurora::kFileTypeTXT, stream);
+
+		erfWriter.flush();
+		erfFile.flush();
+	}
+
+	const Aurora::ERFFile erf(new Common::ReadFile("test.erf"));
+	ASSERT_EQ(erf.getResources().size(), kFileCount + 1);
+
+	Archives::extractFiles(erf, Aurora::kGameIDUnknown, false, std::set<Common::UString>(), 4, []() {
+		return new Aurora::ERFFile(new Common::ReadFile("test.erf"));
+	});
+
+	EXPECT_TRUE(readTestFile(_tmpPath / "dup.txt") == data[kFileCount - 2]);
+	EXPECT_EQ(readTestFile(_tmpPath / "unique1.txt"), "Foobar");
+
+	for (size_t i = 3; i < kFileCount; i += 2)
+		EXPECT_TRUE(readTestFile(_tmpPath / Common::UString::format("unique%u.txt", (uint)i).c_str()) == data[i]);
+}
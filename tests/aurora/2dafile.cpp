@@ -155,6 +155,19 @@ GTEST_TEST(TwoDAFileASCII, getRow) {
 	EXPECT_EQ(&twoda.getRow("ID"  , "Nope"), &twoda.getRow(Aurora::kFieldIDInvalid));
 }
 
+GTEST_TEST(TwoDAFileASCII, getRowFirstMatch) {
+	Common::MemoryReadStream stream(k2DAASCII);
+	const Aurora::TwoDAFile twoda(stream);
+
+	// Values are compared case-insensitively
+	EXPECT_EQ(&twoda.getRow("StringValue", "FOOBAR"), &twoda.getRow(0));
+	EXPECT_EQ(&twoda.getRow("stringvalue", "test3" ), &twoda.getRow(8));
+
+	// Empty cells match the default string, and the first matching row wins
+	EXPECT_EQ(&twoda.getRow("ID"        , ""), &twoda.getRow(2));
+	EXPECT_EQ(&twoda.getRow("FloatValue", ""), &twoda.getRow(3));
+}
+
 GTEST_TEST(TwoDAFileASCII, writeBinary) {
 	Common::MemoryReadStream stream(k2DAASCII);
 	const Aurora::TwoDAFile twoda(stream);
@@ -168,6 +181,22 @@ GTEST_TEST(TwoDAFileASCII, writeBinary) {
 		EXPECT_EQ(writeStream.getData()[i], k2DABinary[i]) << "At index " << i;
 }
 
+GTEST_TEST(TwoDAFileASCII, parseColumns) {
+	Common::MemoryReadStream stream(k2DAASCII);
+	Aurora::TwoDAFile twoda(stream);
+
+	for (size_t i = 0; i < twoda.getColumnCount(); i++)
+		EXPECT_EQ(twoda.getColumnType(i), Aurora::TwoDAFile::kColumnString) << "At index " << i;
+
+	twoda.parseColumns();
+
+	EXPECT_EQ(twoda.getColumnType(0), Aurora::TwoDAFile::kColumnInt);
+	EXPECT_EQ(twoda.getColumnType(1), Aurora::TwoDAFile::kColumnFloat);
+	EXPECT_EQ(twoda.getColumnType(2), Aurora::TwoDAFile::kColumnString);
+
+	EXPECT_EQ(twoda.getColumnType(Aurora::kFieldIDInvalid), Aurora::TwoDAFile::kColumnString);
+}
+
 // --- 2DA Binary ---
 
 GTEST_TEST(TwoDAFileBinary, getRowCount) {
@@ -345,6 +374,29 @@ GTEST_TEST(TwoDARowASCII, getFloatStr) {
 	EXPECT_FLOAT_EQ(twoda.getRow(0).getFloat("Nope"), 0.0f);
 }
 
+GTEST_TEST(TwoDARowASCII, parsedColumns) {
+	Common::MemoryReadStream stream(k2DAASCII);
+	Aurora::TwoDAFile twoda(stream);
+
+	twoda.parseColumns();
+
+	for (size_t i = 0; i < ARRAYSIZE(kDataString); i++) {
+		for (size_t j = 0; j < ARRAYSIZE(kDataString[i]); j++) {
+			const Aurora::TwoDARow &row = twoda.getRow(j);
+
+			EXPECT_STREQ(row.getString(i).c_str(), kDataString[i][j]) << "At index " << j << "." << i;
+			EXPECT_EQ(row.getInt(i), kDataInt[i][j]) << "At index " << j << "." << i;
+			EXPECT_FLOAT_EQ(row.getFloat(i), kDataFloat[i][j]) << "At index " << j << "." << i;
+			EXPECT_EQ(row.empty(i), kDataEmpty[i][j]) << "At index " << j << "." << i;
+		}
+	}
+
+	EXPECT_EQ(twoda.getRow(Aurora::kFieldIDInvalid).getInt(0), 0);
+	EXPECT_EQ(twoda.getRow(0).getInt(Aurora::kFieldIDInvalid), 0);
+	EXPECT_FLOAT_EQ(twoda.getRow(Aurora::kFieldIDInvalid).getFloat(0), 0.0f);
+	EXPECT_FLOAT_EQ(twoda.getRow(0).getFloat(Aurora::kFieldIDInvalid), 0.0f);
+}
+
 // --- 2DA row Binary ---
 
 GTEST_TEST(TwoDARowBinary, emptyN) {
@@ -649,6 +701,40 @@ GTEST_TEST(TwoDAFileVariants, binaryWrongRowIndices) {
 	EXPECT_STREQ(twoda.getRow(0).getString("Nope").c_str(), "");
 }
 
+GTEST_TEST(TwoDAFileVariants, asciiQuotes) {
+	static const char *k2DAASCIIQuotes =
+		"2DA V2.0\r\n"
+		"DEFAULT: \"Not there\"\r\n"
+		"\r\n"
+		"   ID   \"Float Value\" StringValue\r\n"
+		" 0 23   23.5          \"Foo bar\"\r\n"
+		" 1 42   \"\"   \"\"       5.23 \"Bar\tfoo\"\r\n"
+		"\r\n"
+		" 2 **** 1.00          \"Qu\"ux\r\n"
+		" 3 5    ****          \"Bl\xE4h\"\r\n"
+		" 4 9    0.10\r\n";
+
+	Common::MemoryReadStream stream(k2DAASCIIQuotes);
+	const Aurora::TwoDAFile twoda(stream);
+
+	EXPECT_EQ(twoda.getColumnCount(), 3);
+	ASSERT_EQ(twoda.getRowCount(), 5);
+
+	EXPECT_STREQ(twoda.getHeaders()[1].c_str(), "Float Value");
+
+	EXPECT_STREQ(twoda.getRow(0).getString(2).c_str(), "Foo bar");
+	EXPECT_STREQ(twoda.getRow(1).getString(1).c_str(), "5.23");
+	EXPECT_STREQ(twoda.getRow(1).getString(2).c_str(), "Bar\tfoo");
+	EXPECT_STREQ(twoda.getRow(2).getString(2).c_str(), "Quux");
+
+	// Non-ASCII bytes are read as Latin-1
+	EXPECT_STREQ(twoda.getRow(3).getString(2).c_str(), "Bl\xC3\xA4h");
+
+	// Missing cells return the default value
+	EXPECT_STREQ(twoda.getRow(4).getString(2).c_str(), "Not there");
+	EXPECT_STREQ(twoda.getRow(2).getString(0).c_str(), "Not there");
+}
+
 GTEST_TEST(TwoDAFileVariants, asciiEmpty) {
 	static const char *k2DAASCIIEmpty = "2DA V2.0";
 
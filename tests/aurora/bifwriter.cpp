@@ -482,3 +482,40 @@ GTEST_TEST(BIFWriter, writeMultipleFiles) {
 
 	delete dataStream;
 }
+
+GTEST_TEST(BIFWriter, writeFilesFlushedInBetween) {
+	const size_t kLogoDataSize = ARRAYSIZE(kLogoData);
+	const size_t kTextLength = strlen(kFileData) + 1;
+
+	Common::MemoryReadStream textStream(kFileData, true);
+	Common::MemoryReadStream imageStream(kLogoData);
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	Aurora::BIFWriter bif(3, writeStream);
+
+	bif.add(textStream, Aurora::kFileTypeTXT);
+	EXPECT_EQ(bif.size(), 20 + (3 * 16) + kTextLength);
+
+	bif.add(imageStream, Aurora::kFileTypeBMP);
+	bif.add(textStream, Aurora::kFileTypeTXT);
+	EXPECT_EQ(bif.size(), 20 + (3 * 16) + (2 * kTextLength) + kLogoDataSize);
+
+	const Aurora::BIFFile bifFile(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+
+	ASSERT_EQ(bifFile.getInternalResourceCount(), 3);
+	EXPECT_EQ(bifFile.getResourceSize(0), kTextLength);
+	EXPECT_EQ(bifFile.getResourceSize(1), kLogoDataSize);
+	EXPECT_EQ(bifFile.getResourceSize(2), kTextLength);
+
+	std::unique_ptr<Common::SeekableReadStream> dataStream(bifFile.getResource(1));
+	std::unique_ptr<byte[]> logoData = std::make_unique<byte[]>(dataStream->size());
+	dataStream->read(logoData.get(), dataStream->size());
+	for (size_t i = 0; i < ARRAYSIZE(kLogoData); ++i) {
+		EXPECT_EQ(logoData[i], kLogoData[i]);
+	}
+
+	dataStream.reset(bifFile.getResource(2));
+	std::unique_ptr<char[]> txt = std::make_unique<char[]>(dataStream->size());
+	dataStream->read(txt.get(), dataStream->size());
+
+	EXPECT_STREQ(txt.get(), kFileData);
+}
@@ -23,8 +23,14 @@
  * Unit tests for our BZF file writer
  */
 
+#include <cstring>
+
+#include <memory>
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
@@ -482,3 +488,95 @@ GTEST_TEST(BZFWriter, writeMultipleFiles) {
 
 	delete dataStream;
 }
+
+GTEST_TEST(BZFWriter, writeMultipleFilesThreaded) {
+	Common::MemoryReadStream textStream(kFileData, true);
+	Common::MemoryReadStream imageStream(kLogoData);
+
+	Common::MemoryWriteStreamDynamic writeStream1(true);
+	Common::MemoryWriteStreamDynamic writeStream4(true);
+
+	Aurora::BZFWriter bzf1(9, writeStream1, 1);
+	Aurora::BZFWriter bzf4(9, writeStream4, 4);
+
+	std::vector<size_t> written;
+	bzf4.setWrittenCallback([&written](size_t index) {
+		written.push_back(index);
+	});
+
+	for (size_t i = 0; i < 3; i++) {
+		bzf1.add(textStream , Aurora::kFileTypeTXT);
+		bzf1.add(imageStream, Aurora::kFileTypeBMP);
+		bzf1.add(textStream , Aurora::kFileTypeTXT);
+
+		bzf4.add(textStream , Aurora::kFileTypeTXT);
+		bzf4.add(imageStream, Aurora::kFileTypeBMP);
+		bzf4.add(textStream , Aurora::kFileTypeTXT);
+	}
+
+	// The threaded writer has to produce the exact same file
+	EXPECT_EQ(bzf1.size(), bzf4.size());
+
+	// Every file is reported once it's written, in the order they were added
+	ASSERT_EQ(written.size(), 9);
+	for (size_t i = 0; i < written.size(); i++)
+		EXPECT_EQ(written[i], i);
+
+	ASSERT_EQ(writeStream1.size(), writeStream4.size());
+	EXPECT_EQ(std::memcmp(writeStream1.getData(), writeStream4.getData(), writeStream1.size()), 0);
+
+	EXPECT_THROW(bzf4.add(textStream, Aurora::kFileTypeTXT), Common::Exception);
+}
+
+GTEST_TEST(BZFWriter, writeWithCompressionOptions) {
+	static const size_t kNoiseSize = 65536;
+
+	std::unique_ptr<byte[]> noise = std::make_unique<byte[]>(kNoiseSize);
+
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < kNoiseSize; i++) {
+		seed = seed * 1103515245 + 12345;
+		noise[i] = seed >> 16;
+	}
+
+	Common::MemoryReadStream textStream(kFileData, true);
+	Common::MemoryReadStream noiseStream(noise.get(), kNoiseSize);
+
+	Aurora::CompressionOptions options;
+	options.level              = 9;
+	options.lzmaExtreme        = true;
+	options.fastIncompressible = true;
+
+	Aurora::CompressionStatistics statistics;
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+
+	{
+		Aurora::BZFWriter bzf(2, writeStream, 2, options, &statistics);
+
+		bzf.add(textStream, Aurora::kFileTypeTXT);
+		bzf.add(noiseStream, Aurora::kFileTypeWAV);
+	}
+
+	const Aurora::CompressionStatistics::Types types = statistics.getTypes();
+	ASSERT_EQ(types.size(), 2);
+
+	EXPECT_EQ(types.at(Aurora::kFileTypeTXT).count, 1);
+	EXPECT_EQ(types.at(Aurora::kFileTypeTXT).incompressibleCount, 0);
+	EXPECT_EQ(types.at(Aurora::kFileTypeTXT).uncompressedSize, strlen(kFileData) + 1);
+
+	EXPECT_EQ(types.at(Aurora::kFileTypeWAV).count, 1);
+	EXPECT_EQ(types.at(Aurora::kFileTypeWAV).incompressibleCount, 1);
+	EXPECT_EQ(types.at(Aurora::kFileTypeWAV).uncompressedSize, kNoiseSize);
+
+	const Aurora::BZFFile bzfFile(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+	ASSERT_EQ(bzfFile.getInternalResourceCount(), 2);
+
+	std::unique_ptr<Common::SeekableReadStream> dataStream(bzfFile.getResource(1));
+	ASSERT_EQ(dataStream->size(), kNoiseSize);
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kNoiseSize);
+	ASSERT_EQ(dataStream->read(data.get(), kNoiseSize), kNoiseSize);
+
+	EXPECT_EQ(std::memcmp(data.get(), noise.get(), kNoiseSize), 0);
+}
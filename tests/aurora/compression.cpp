@@ -0,0 +1,94 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the compression options and statistics of archive writers.
+ */
+
+#include <cstring>
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/compression.h"
+
+static void fillNoise(byte *data, size_t size) {
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+}
+
+GTEST_TEST(Compression, isIncompressible) {
+	static const size_t kSize = 65536;
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kSize);
+
+	std::memset(data.get(), 'x', kSize);
+	EXPECT_FALSE(Aurora::isIncompressible(data.get(), kSize));
+
+	for (size_t i = 0; i < kSize; i++)
+		data[i] = "The lone and level sands stretch far away."[i % 42];
+	EXPECT_FALSE(Aurora::isIncompressible(data.get(), kSize));
+
+	fillNoise(data.get(), kSize);
+	EXPECT_TRUE(Aurora::isIncompressible(data.get(), kSize));
+
+	// Too small to tell
+	EXPECT_FALSE(Aurora::isIncompressible(data.get(), 256));
+}
+
+GTEST_TEST(Compression, statistics) {
+	Aurora::CompressionStatistics statistics;
+
+	statistics.add(Aurora::kFileTypeTXT, 1000, 250, false, std::chrono::milliseconds(10));
+	statistics.add(Aurora::kFileTypeTXT, 3000, 750, false, std::chrono::milliseconds(20));
+	statistics.add(Aurora::kFileTypeWAV, 5000, 5010, true, std::chrono::milliseconds(1));
+
+	const Aurora::CompressionStatistics::Types types = statistics.getTypes();
+	ASSERT_EQ(types.size(), 2);
+
+	const Aurora::CompressionStatistics::Type &txt = types.at(Aurora::kFileTypeTXT);
+	EXPECT_EQ(txt.count, 2);
+	EXPECT_EQ(txt.incompressibleCount, 0);
+	EXPECT_EQ(txt.uncompressedSize, 4000);
+	EXPECT_EQ(txt.compressedSize, 1000);
+	EXPECT_EQ(txt.time, std::chrono::milliseconds(30));
+
+	const Aurora::CompressionStatistics::Type &wav = types.at(Aurora::kFileTypeWAV);
+	EXPECT_EQ(wav.count, 1);
+	EXPECT_EQ(wav.incompressibleCount, 1);
+	EXPECT_EQ(wav.uncompressedSize, 5000);
+	EXPECT_EQ(wav.compressedSize, 5010);
+
+	Common::MemoryWriteStreamDynamic stream(true);
+	statistics.write(stream);
+
+	const std::string table(reinterpret_cast<const char *>(stream.getData()), stream.size());
+
+	EXPECT_NE(table.find("txt"), std::string::npos);
+	EXPECT_NE(table.find("wav"), std::string::npos);
+	EXPECT_NE(table.find("Total"), std::string::npos);
+	EXPECT_NE(table.find("25.00%"), std::string::npos);
+}
@@ -22,8 +22,14 @@
  *  Unit tests for our ERF file archive writer class.
  */
 
+#include <cstring>
+
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
+#include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
 #include "src/aurora/erfwriter.h"
@@ -460,6 +466,7 @@ GTEST_TEST(ERFWriter, WriteFile) {
 	Common::MemoryWriteStreamDynamic writeStream;
 	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream);
 	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, dataStream);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -496,6 +503,7 @@ GTEST_TEST(ERFWriter, WriteMultipleFiles) {
 	dataStream1.seek(0);
 	erfWriter.add("ozymandias_2", Aurora::kFileTypeTXT, dataStream1);
 	erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -557,6 +565,7 @@ GTEST_TEST(ERFWriter, WriteFileV20) {
 	Common::MemoryWriteStreamDynamic writeStream;
 	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream, Aurora::ERFWriter::kERFVersion20);
 	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, dataStream);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -593,6 +602,7 @@ GTEST_TEST(ERFWriter, WriteMultipleFilesV20) {
 	dataStream1.seek(0);
 	erfWriter.add("ozymandias_2", Aurora::kFileTypeTXT, dataStream1);
 	erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -654,6 +664,7 @@ GTEST_TEST(ERFWriter, WriteFileV22) {
 	Common::MemoryWriteStreamDynamic writeStream;
 	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream, Aurora::ERFWriter::kERFVersion22);
 	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, dataStream);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -690,6 +701,7 @@ GTEST_TEST(ERFWriter, WriteMultipleFilesV22) {
 	dataStream1.seek(0);
 	erfWriter.add("ozymandias_2", Aurora::kFileTypeTXT, dataStream1);
 	erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -740,6 +752,7 @@ GTEST_TEST(ERFWriter, WriteFileV22BiowareZlib) {
 	Common::MemoryWriteStreamDynamic writeStream;
 	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream, Aurora::ERFWriter::kERFVersion22, Aurora::ERFWriter::kCompressionBiowareZlib);
 	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, dataStream);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -776,6 +789,7 @@ GTEST_TEST(ERFWriter, WriteMultipleFilesV22BiowareZlib) {
 	dataStream1.seek(0);
 	erfWriter.add("ozymandias_2", Aurora::kFileTypeTXT, dataStream1);
 	erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -826,6 +840,7 @@ GTEST_TEST(ERFWriter, WriteFileV22HeaderlessZlib) {
 	Common::MemoryWriteStreamDynamic writeStream;
 	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream, Aurora::ERFWriter::kERFVersion22, Aurora::ERFWriter::kCompressionHeaderlessZlib);
 	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, dataStream);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -862,6 +877,7 @@ GTEST_TEST(ERFWriter, WriteMultipleFilesV22HeaderlessZlib) {
 	dataStream1.seek(0);
 	erfWriter.add("ozymandias_2", Aurora::kFileTypeTXT, dataStream1);
 	erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+	erfWriter.flush();
 
 	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
 
@@ -904,3 +920,161 @@ GTEST_TEST(ERFWriter, WriteMultipleFilesV22HeaderlessZlib) {
 	delete readStream2;
 	delete readStream3;
 }
+
+GTEST_TEST(ERFWriter, WriteMultipleFilesV22Threaded) {
+	Common::MemoryReadStream dataStream1(kFileData, true);
+	Common::MemoryReadStream dataStream2(kLogoData, sizeof(kLogoData));
+
+	static const Aurora::ERFWriter::Compression kCompressions[] = {
+		Aurora::ERFWriter::kCompressionBiowareZlib, Aurora::ERFWriter::kCompressionHeaderlessZlib
+	};
+
+	for (size_t c = 0; c < ARRAYSIZE(kCompressions); c++) {
+		Common::MemoryWriteStreamDynamic writeStream1(true), writeStream4(true);
+
+		Aurora::ERFWriter erfWriter1(MKTAG('E', 'R', 'F', ' '), 8, writeStream1, Aurora::ERFWriter::kERFVersion22,
+		                             kCompressions[c], Aurora::LocString(), 1);
+		Aurora::ERFWriter erfWriter4(MKTAG('E', 'R', 'F', ' '), 8, writeStream4, Aurora::ERFWriter::kERFVersion22,
+		                             kCompressions[c], Aurora::LocString(), 4);
+
+		std::vector<size_t> written;
+		erfWriter4.setWrittenCallback([&written](size_t index) {
+			written.push_back(index);
+		});
+
+		for (size_t i = 0; i < 4; i++) {
+			const Common::UString text = Common::UString::format("ozymandias_%u", (uint)i);
+			const Common::UString logo = Common::UString::format("logo_%u", (uint)i);
+
+			dataStream1.seek(0);
+			erfWriter1.add(text, Aurora::kFileTypeTXT, dataStream1);
+			dataStream1.seek(0);
+			erfWriter4.add(text, Aurora::kFileTypeTXT, dataStream1);
+
+			dataStream2.seek(0);
+			erfWriter1.add(logo, Aurora::kFileTypeBMP, dataStream2);
+			dataStream2.seek(0);
+			erfWriter4.add(logo, Aurora::kFileTypeBMP, dataStream2);
+		}
+
+		erfWriter1.flush();
+		erfWriter4.flush();
+
+		// Every file is reported once it's written, in the order they were added
+		ASSERT_EQ(written.size(), 8);
+		for (size_t i = 0; i < written.size(); i++)
+			EXPECT_EQ(written[i], i);
+
+		// The threaded writer has to produce the exact same archive
+		ASSERT_EQ(writeStream1.size(), writeStream4.size());
+		EXPECT_EQ(std::memcmp(writeStream1.getData(), writeStream4.getData(), writeStream1.size()), 0);
+
+		const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream4.getData(), writeStream4.size()));
+		ASSERT_EQ(erf.getResources().size(), 8);
+
+		std::unique_ptr<Common::SeekableReadStream> logo(erf.getResource(erf.findResource("logo_3", Aurora::kFileTypeBMP)));
+		ASSERT_EQ(logo->size(), sizeof(kLogoData));
+	}
+}
+
+GTEST_TEST(ERFWriter, WriteFilesFlushedInBetween) {
+	Common::MemoryReadStream dataStream1(kFileData, true);
+	const size_t kFileDataSize = dataStream1.size();
+
+	const size_t kLogoDataSize = sizeof(kLogoData);
+	Common::MemoryReadStream dataStream2(kLogoData, kLogoDataSize);
+
+	static const Aurora::ERFWriter::Version kVersions[] = {
+		Aurora::ERFWriter::kERFVersion10, Aurora::ERFWriter::kERFVersion20, Aurora::ERFWriter::kERFVersion22
+	};
+
+	for (size_t v = 0; v < ARRAYSIZE(kVersions); v++) {
+		Common::MemoryWriteStreamDynamic writeStream(true);
+		Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 3, writeStream, kVersions[v]);
+
+		dataStream1.seek(0);
+		erfWriter.add("ozymandias_1", Aurora::kFileTypeTXT, dataStream1);
+		erfWriter.flush();
+
+		dataStream2.seek(0);
+		erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+		dataStream1.seek(0);
+		erfWriter.add("ozymandias_2", Aurora::kFileTypeTXT, dataStream1);
+		erfWriter.flush();
+
+		const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+		ASSERT_EQ(erf.getResources().size(), 3) << "Version " << v;
+
+		EXPECT_EQ(erf.findResource("ozymandias_1", Aurora::kFileTypeTXT), 0) << "Version " << v;
+		EXPECT_EQ(erf.findResource("logo", Aurora::kFileTypeBMP), 1) << "Version " << v;
+		EXPECT_EQ(erf.findResource("ozymandias_2", Aurora::kFileTypeTXT), 2) << "Version " << v;
+
+		std::unique_ptr<Common::SeekableReadStream> logo(erf.getResource(1));
+		ASSERT_EQ(logo->size(), kLogoDataSize) << "Version " << v;
+
+		std::unique_ptr<Common::SeekableReadStream> text(erf.getResource(2));
+		ASSERT_EQ(text->size(), kFileDataSize) << "Version " << v;
+
+		std::unique_ptr<byte[]> logoData = std::make_unique<byte[]>(logo->size());
+		logo->read(logoData.get(), logo->size());
+
+		EXPECT_EQ(std::memcmp(logoData.get(), kLogoData, kLogoDataSize), 0) << "Version " << v;
+	}
+}
+
+GTEST_TEST(ERFWriter, WriteV22WithCompressionOptions) {
+	static const size_t kNoiseSize = 65536;
+
+	std::unique_ptr<byte[]> noise = std::make_unique<byte[]>(kNoiseSize);
+
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < kNoiseSize; i++) {
+		seed = seed * 1103515245 + 12345;
+		noise[i] = seed >> 16;
+	}
+
+	Common::MemoryReadStream textStream(kFileData, true);
+	Common::MemoryReadStream noiseStream(noise.get(), kNoiseSize);
+
+	Aurora::CompressionOptions options;
+	options.level              = 1;
+	options.deflateStrategy    = Common::kDeflateStrategyFiltered;
+	options.fastIncompressible = true;
+
+	Aurora::CompressionStatistics statistics;
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 2, writeStream, Aurora::ERFWriter::kERFVersion22,
+	                            Aurora::ERFWriter::kCompressionBiowareZlib, Aurora::LocString(), 2,
+	                            options, &statistics);
+
+	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, textStream);
+	erfWriter.add("noise", Aurora::kFileTypeWAV, noiseStream);
+	erfWriter.flush();
+
+	const Aurora::CompressionStatistics::Types types = statistics.getTypes();
+	ASSERT_EQ(types.size(), 2);
+
+	EXPECT_EQ(types.at(Aurora::kFileTypeTXT).count, 1);
+	EXPECT_EQ(types.at(Aurora::kFileTypeTXT).incompressibleCount, 0);
+	EXPECT_LT(types.at(Aurora::kFileTypeTXT).compressedSize, types.at(Aurora::kFileTypeTXT).uncompressedSize);
+
+	// Incompressible data is only stored, in uncompressed DEFLATE blocks
+	EXPECT_EQ(types.at(Aurora::kFileTypeWAV).count, 1);
+	EXPECT_EQ(types.at(Aurora::kFileTypeWAV).incompressibleCount, 1);
+	EXPECT_GT(types.at(Aurora::kFileTypeWAV).compressedSize, kNoiseSize);
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+	ASSERT_EQ(erf.getResources().size(), 2);
+
+	std::unique_ptr<Common::SeekableReadStream> text(erf.getResource(erf.findResource("ozymandias", Aurora::kFileTypeTXT)));
+	ASSERT_EQ(text->size(), textStream.size());
+
+	std::unique_ptr<Common::SeekableReadStream> noiseData(erf.getResource(erf.findResource("noise", Aurora::kFileTypeWAV)));
+	ASSERT_EQ(noiseData->size(), kNoiseSize);
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kNoiseSize);
+	ASSERT_EQ(noiseData->read(data.get(), kNoiseSize), kNoiseSize);
+
+	EXPECT_EQ(std::memcmp(data.get(), noise.get(), kNoiseSize), 0);
+}
@@ -356,6 +356,9 @@ GTEST_TEST(GDAFile, add) {
 
 	Aurora::GDAFile gda(new Common::MemoryReadStream(kMGDA1));
 
+	ASSERT_NE(gda.findRow(0), Aurora::GDAFile::kInvalidRow);
+	EXPECT_EQ(gda.findRow(10), Aurora::GDAFile::kInvalidRow);
+
 	gda.add(new Common::MemoryReadStream(kMGDA3));
 	gda.add(new Common::MemoryReadStream(kMGDA2));
 
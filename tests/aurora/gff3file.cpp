@@ -524,39 +524,39 @@ GTEST_TEST(GFF3Struct, getStruct) {
 
 // --- GFF3, lists ---
 
-GTEST_TEST(GFF3Struct, getList) {
-	static const byte kGFF3Lists[] = {
-		0x47,0x46,0x46,0x20,0x56,0x33,0x2E,0x32,0x38,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,
-		0xB0,0x00,0x00,0x00,0x0E,0x00,0x00,0x00,0x58,0x01,0x00,0x00,0x02,0x00,0x00,0x00,
-		0x78,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x78,0x01,0x00,0x00,0x20,0x00,0x00,0x00,
-		0x98,0x01,0x00,0x00,0x34,0x00,0x00,0x00,0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x02,0x00,0x00,0x00,
-		0x19,0x00,0x00,0x00,0x10,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1A,0x00,0x00,0x00,
-		0x18,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1B,0x00,0x00,0x00,0x08,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x09,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x1D,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,
-		0x0B,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x0C,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0D,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x21,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x10,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x23,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x28,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x24,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
-		0x00,0x00,0x00,0x00,0x25,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x26,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x27,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x28,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
-		0x00,0x00,0x00,0x00,0x29,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x55,0x69,0x6E,
-		0x74,0x33,0x32,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x4C,0x69,0x73,
-		0x74,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x05,0x00,0x00,0x00,
-		0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
-		0x05,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x09,0x00,0x00,0x00
-	};
+static const byte kGFF3Lists[] = {
+	0x47,0x46,0x46,0x20,0x56,0x33,0x2E,0x32,0x38,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,
+	0xB0,0x00,0x00,0x00,0x0E,0x00,0x00,0x00,0x58,0x01,0x00,0x00,0x02,0x00,0x00,0x00,
+	0x78,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x78,0x01,0x00,0x00,0x20,0x00,0x00,0x00,
+	0x98,0x01,0x00,0x00,0x34,0x00,0x00,0x00,0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x02,0x00,0x00,0x00,
+	0x19,0x00,0x00,0x00,0x10,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1A,0x00,0x00,0x00,
+	0x18,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1B,0x00,0x00,0x00,0x08,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x09,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x1D,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,
+	0x0B,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x0C,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0D,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x21,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x10,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x23,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x28,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x24,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x25,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x26,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x27,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x28,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x29,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x55,0x69,0x6E,
+	0x74,0x33,0x32,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x4C,0x69,0x73,
+	0x74,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x05,0x00,0x00,0x00,
+	0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+	0x05,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x09,0x00,0x00,0x00
+};
 
+GTEST_TEST(GFF3Struct, getList) {
 	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3Lists));
 	const Aurora::GFF3Struct &strct0 = gff3.getTopLevel();
 
@@ -636,6 +636,52 @@ GTEST_TEST(GFF3Struct, getList) {
 	EXPECT_EQ(strct9.getUint("FieldUint32"), 41);
 }
 
+GTEST_TEST(GFF3Struct, getListLazy) {
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3Lists), 0xFFFFFFFF, false, true);
+	const Aurora::GFF3Struct &strct0 = gff3.getTopLevel();
+
+	EXPECT_EQ(strct0.getFieldCount(), 2);
+	EXPECT_EQ(strct0.getID(), 23);
+	EXPECT_EQ(strct0.getUint("FieldUint32"), 32);
+
+	const Aurora::GFF3List &list0 = strct0.getList("FieldList");
+	ASSERT_EQ(list0.size(), 3);
+
+	// Reaching the same list again yields the same structs
+	EXPECT_EQ(&strct0.getList("FieldList"), &list0);
+
+	const Aurora::GFF3Struct &strct3 = *list0[2];
+	EXPECT_EQ(strct3.getID(), 26);
+	EXPECT_EQ(strct3.getUint("FieldUint32"), 35);
+
+	const Aurora::GFF3List &list3 = strct3.getList("FieldList");
+	ASSERT_EQ(list3.size(), 2);
+
+	EXPECT_EQ(list3[0]->getID(), 31);
+	EXPECT_EQ(list3[0]->getUint("FieldUint32"), 40);
+	EXPECT_EQ(list3[1]->getID(), 32);
+	EXPECT_EQ(list3[1]->getUint("FieldUint32"), 41);
+
+	const Aurora::GFF3List &list1 = list0[0]->getList("FieldList");
+	ASSERT_EQ(list1.size(), 2);
+
+	EXPECT_EQ(list1[0]->getID(), 27);
+	EXPECT_EQ(list1[1]->getID(), 28);
+}
+
+GTEST_TEST(GFF3Struct, getFieldsLazy) {
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct), 0xFFFFFFFF, false, true);
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	EXPECT_EQ(strct.getID(), 23);
+	EXPECT_EQ(strct.getFieldCount(), ARRAYSIZE(kFieldNamesSingle));
+
+	EXPECT_EQ(strct.getUint("FieldUint32"), 25);
+	EXPECT_EQ(strct.getUint("FieldUint64"), 42);
+
+	EXPECT_STREQ(strct.getString("FieldExoString").c_str(), "Foobar");
+}
+
 // --- GFF3, V3.3 ---
 
 GTEST_TEST(GFF3File, GFF3V33) {
@@ -654,3 +700,42 @@ GTEST_TEST(GFF3File, GFF3V33) {
 	EXPECT_EQ(strct.getID(), 23);
 	EXPECT_EQ(strct.getUint("FieldUint32"), 32);
 }
+
+// --- GFF3, duplicate labels ---
+
+GTEST_TEST(GFF3Struct, duplicateLabels) {
+	/* A struct with three byte fields. The first and third field use two
+	 * different entries in the label table that contain the same label. */
+	static const byte kGFF3DuplicateLabels[] = {
+		0x47,0x46,0x46,0x20,0x56,0x33,0x2E,0x32,0x38,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+		0x44,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x68,0x00,0x00,0x00,0x03,0x00,0x00,0x00,
+		0x98,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x98,0x00,0x00,0x00,0x0C,0x00,0x00,0x00,
+		0xA4,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,
+		0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+		0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x41,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x42,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x41,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+		0x02,0x00,0x00,0x00
+	};
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3DuplicateLabels));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	EXPECT_EQ(strct.getFieldCount(), 2);
+
+	const std::vector<Common::UString> &fieldNames = strct.getFieldNames();
+	ASSERT_EQ(fieldNames.size(), 3);
+	EXPECT_STREQ(fieldNames[0].c_str(), "FieldA");
+	EXPECT_STREQ(fieldNames[1].c_str(), "FieldB");
+	EXPECT_STREQ(fieldNames[2].c_str(), "FieldA");
+
+	EXPECT_TRUE(strct.hasField("FieldA"));
+	EXPECT_TRUE(strct.hasField("FieldB"));
+	EXPECT_FALSE(strct.hasField("FieldC"));
+
+	// The last field with a label wins
+	EXPECT_EQ(strct.getUint("FieldA"), 3);
+	EXPECT_EQ(strct.getUint("FieldB"), 2);
+}
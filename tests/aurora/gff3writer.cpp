@@ -22,7 +22,9 @@
  *  Unit tests for our GFF3 file writer class.
  */
 
+#include <cstring>
 #include <vector>
+#include <memory>
 
 #include "gtest/gtest.h"
 
@@ -348,3 +350,97 @@ GTEST_TEST(GFF3Writer, WriteEquivalentValues) {
 
 	delete writeStream;
 }
+
+GTEST_TEST(GFF3Writer, WriteSharedLabelsAndData) {
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '), MKTAG('V', '3', '.', '2'));
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("List");
+
+	for (size_t i = 0; i < 100; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", i);
+
+		strct->addExoString("String", (i % 2) ? "Odd" : "Even");
+		strct->addUint64("Uint64", i % 3);
+		strct->addUint32("Uint32", i);
+	}
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	writer.write(writeStream);
+
+	Common::MemoryReadStream stream(writeStream.getData(), writeStream.size());
+
+	stream.seek(28);
+	const uint32_t labelCount = stream.readUint32LE();
+
+	stream.seek(36);
+	const uint32_t fieldDataCount = stream.readUint32LE();
+
+	// "List", "String", "Uint64", "Uint32" and the empty struct label
+	EXPECT_EQ(labelCount, 5);
+
+	// "Even", "Odd" (each 4 + length) and three 8-byte uint64_t values
+	EXPECT_EQ(fieldDataCount, (4 + 4) + (4 + 3) + 3 * 8);
+
+	Aurora::GFF3File gff(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+
+	const Aurora::GFF3List &gffList = gff.getTopLevel().getList("List");
+	ASSERT_EQ(gffList.size(), 100);
+
+	for (size_t i = 0; i < gffList.size(); i++) {
+		EXPECT_EQ(gffList[i]->getString("String"), (i % 2) ? "Odd" : "Even") << "At index " << i;
+		EXPECT_EQ(gffList[i]->getUint("Uint64"), i % 3) << "At index " << i;
+		EXPECT_EQ(gffList[i]->getUint("Uint32"), i) << "At index " << i;
+	}
+}
+
+static void writeDuplicatedData(Common::MemoryWriteStreamDynamic &writeStream, bool deduplicateData) {
+	static const byte kData1[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+	static const byte kData2[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x08 };
+
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '), MKTAG('V', '3', '.', '2'), deduplicateData);
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("List");
+
+	for (size_t i = 0; i < 10; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", i);
+
+		strct->addVoid("Void", new Common::MemoryReadStream((i == 9) ? kData2 : kData1, sizeof(kData1)));
+		strct->addExoString("String", new Common::MemoryReadStream(kData1, sizeof(kData1)));
+	}
+
+	writer.write(writeStream);
+}
+
+GTEST_TEST(GFF3Writer, WriteDeduplicatedData) {
+	static const byte kData1[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+	static const byte kData2[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x08 };
+
+	Common::MemoryWriteStreamDynamic writeStream(true), dedupWriteStream(true);
+	writeDuplicatedData(writeStream, false);
+	writeDuplicatedData(dedupWriteStream, true);
+
+	Common::MemoryReadStream stream(writeStream.getData(), writeStream.size());
+	Common::MemoryReadStream dedupStream(dedupWriteStream.getData(), dedupWriteStream.size());
+
+	stream.seek(36);
+	dedupStream.seek(36);
+
+	// By default, every raw field gets its own data: 20 fields, each 4 + 8 bytes
+	EXPECT_EQ(stream.readUint32LE(), 20 * (4 + 8));
+
+	// Deduplicated, only the two different voids and the one string remain
+	EXPECT_EQ(dedupStream.readUint32LE(), 3 * (4 + 8));
+
+	Aurora::GFF3File gff(new Common::MemoryReadStream(dedupWriteStream.getData(), dedupWriteStream.size()));
+
+	const Aurora::GFF3List &gffList = gff.getTopLevel().getList("List");
+	ASSERT_EQ(gffList.size(), 10);
+
+	for (size_t i = 0; i < gffList.size(); i++) {
+		std::unique_ptr<Common::SeekableReadStream> data(gffList[i]->getData("Void"));
+		ASSERT_TRUE(data) << "At index " << i;
+		ASSERT_EQ(data->size(), sizeof(kData1)) << "At index " << i;
+
+		byte buffer[sizeof(kData1)];
+		ASSERT_EQ(data->read(buffer, sizeof(buffer)), sizeof(buffer)) << "At index " << i;
+		EXPECT_EQ(std::memcmp(buffer, (i == 9) ? kData2 : kData1, sizeof(buffer)), 0) << "At index " << i;
+	}
+}
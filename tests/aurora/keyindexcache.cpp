@@ -0,0 +1,239 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our KEY index cache.
+ */
+
+#include <utility>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/keyindexcache.h"
+#include "src/aurora/keyfile.h"
+#include "src/aurora/biffile.h"
+
+// Percy Bysshe Shelley's "Ozymandias"
+static const char *kFileData =
+	"I met a traveller from an antique land\n"
+	"Who said: Two vast and trunkless legs of stone\n"
+	"Stand in the desert. Near them, on the sand,\n"
+	"Half sunk, a shattered visage lies, whose frown,\n"
+	"And wrinkled lip, and sneer of cold command,\n"
+	"Tell that its sculptor well those passions read\n"
+	"Which yet survive, stamped on these lifeless things,\n"
+	"The hand that mocked them and the heart that fed:\n"
+	"And on the pedestal these words appear:\n"
+	"'My name is Ozymandias, king of kings:\n"
+	"Look on my works, ye Mighty, and despair!'\n"
+	"Nothing beside remains. Round the decay\n"
+	"Of that colossal wreck, boundless and bare\n"
+	"The lone and level sands stretch far away.";
+
+static const byte kKEYFile[] = {
+	0x4B,0x45,0x59,0x20,0x56,0x31,0x20,0x20,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x40,0x00,0x00,0x00,0x56,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x4C,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,0x78,0x6F,0x72,0x65,
+	0x6F,0x73,0x2E,0x62,0x69,0x66,0x6F,0x7A,0x79,0x6D,0x61,0x6E,0x64,0x69,0x61,0x73,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,0x00,0x00
+};
+
+// --- BIF V1.0 ---
+
+// Percy Bysshe Shelley's "Ozymandias", within a BIF V1.0 file
+static const byte kBIF10File[] = {
+	0x42,0x49,0x46,0x46,0x56,0x31,0x20,0x20,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x14,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x24,0x00,0x00,0x00,0x6F,0x02,0x00,0x00,
+	0x0A,0x00,0x00,0x00,0x49,0x20,0x6D,0x65,0x74,0x20,0x61,0x20,0x74,0x72,0x61,0x76,
+	0x65,0x6C,0x6C,0x65,0x72,0x20,0x66,0x72,0x6F,0x6D,0x20,0x61,0x6E,0x20,0x61,0x6E,
+	0x74,0x69,0x71,0x75,0x65,0x20,0x6C,0x61,0x6E,0x64,0x0A,0x57,0x68,0x6F,0x20,0x73,
+	0x61,0x69,0x64,0x3A,0x20,0x54,0x77,0x6F,0x20,0x76,0x61,0x73,0x74,0x20,0x61,0x6E,
+	0x64,0x20,0x74,0x72,0x75,0x6E,0x6B,0x6C,0x65,0x73,0x73,0x20,0x6C,0x65,0x67,0x73,
+	0x20,0x6F,0x66,0x20,0x73,0x74,0x6F,0x6E,0x65,0x0A,0x53,0x74,0x61,0x6E,0x64,0x20,
+	0x69,0x6E,0x20,0x74,0x68,0x65,0x20,0x64,0x65,0x73,0x65,0x72,0x74,0x2E,0x20,0x4E,
+	0x65,0x61,0x72,0x20,0x74,0x68,0x65,0x6D,0x2C,0x20,0x6F,0x6E,0x20,0x74,0x68,0x65,
+	0x20,0x73,0x61,0x6E,0x64,0x2C,0x0A,0x48,0x61,0x6C,0x66,0x20,0x73,0x75,0x6E,0x6B,
+	0x2C,0x20,0x61,0x20,0x73,0x68,0x61,0x74,0x74,0x65,0x72,0x65,0x64,0x20,0x76,0x69,
+	0x73,0x61,0x67,0x65,0x20,0x6C,0x69,0x65,0x73,0x2C,0x20,0x77,0x68,0x6F,0x73,0x65,
+	0x20,0x66,0x72,0x6F,0x77,0x6E,0x2C,0x0A,0x41,0x6E,0x64,0x20,0x77,0x72,0x69,0x6E,
+	0x6B,0x6C,0x65,0x64,0x20,0x6C,0x69,0x70,0x2C,0x20,0x61,0x6E,0x64,0x20,0x73,0x6E,
+	0x65,0x65,0x72,0x20,0x6F,0x66,0x20,0x63,0x6F,0x6C,0x64,0x20,0x63,0x6F,0x6D,0x6D,
+	0x61,0x6E,0x64,0x2C,0x0A,0x54,0x65,0x6C,0x6C,0x20,0x74,0x68,0x61,0x74,0x20,0x69,
+	0x74,0x73,0x20,0x73,0x63,0x75,0x6C,0x70,0x74,0x6F,0x72,0x20,0x77,0x65,0x6C,0x6C,
+	0x20,0x74,0x68,0x6F,0x73,0x65,0x20,0x70,0x61,0x73,0x73,0x69,0x6F,0x6E,0x73,0x20,
+	0x72,0x65,0x61,0x64,0x0A,0x57,0x68,0x69,0x63,0x68,0x20,0x79,0x65,0x74,0x20,0x73,
+	0x75,0x72,0x76,0x69,0x76,0x65,0x2C,0x20,0x73,0x74,0x61,0x6D,0x70,0x65,0x64,0x20,
+	0x6F,0x6E,0x20,0x74,0x68,0x65,0x73,0x65,0x20,0x6C,0x69,0x66,0x65,0x6C,0x65,0x73,
+	0x73,0x20,0x74,0x68,0x69,0x6E,0x67,0x73,0x2C,0x0A,0x54,0x68,0x65,0x20,0x68,0x61,
+	0x6E,0x64,0x20,0x74,0x68,0x61,0x74,0x20,0x6D,0x6F,0x63,0x6B,0x65,0x64,0x20,0x74,
+	0x68,0x65,0x6D,0x20,0x61,0x6E,0x64,0x20,0x74,0x68,0x65,0x20,0x68,0x65,0x61,0x72,
+	0x74,0x20,0x74,0x68,0x61,0x74,0x20,0x66,0x65,0x64,0x3A,0x0A,0x41,0x6E,0x64,0x20,
+	0x6F,0x6E,0x20,0x74,0x68,0x65,0x20,0x70,0x65,0x64,0x65,0x73,0x74,0x61,0x6C,0x20,
+	0x74,0x68,0x65,0x73,0x65,0x20,0x77,0x6F,0x72,0x64,0x73,0x20,0x61,0x70,0x70,0x65,
+	0x61,0x72,0x3A,0x0A,0x27,0x4D,0x79,0x20,0x6E,0x61,0x6D,0x65,0x20,0x69,0x73,0x20,
+	0x4F,0x7A,0x79,0x6D,0x61,0x6E,0x64,0x69,0x61,0x73,0x2C,0x20,0x6B,0x69,0x6E,0x67,
+	0x20,0x6F,0x66,0x20,0x6B,0x69,0x6E,0x67,0x73,0x3A,0x0A,0x4C,0x6F,0x6F,0x6B,0x20,
+	0x6F,0x6E,0x20,0x6D,0x79,0x20,0x77,0x6F,0x72,0x6B,0x73,0x2C,0x20,0x79,0x65,0x20,
+	0x4D,0x69,0x67,0x68,0x74,0x79,0x2C,0x20,0x61,0x6E,0x64,0x20,0x64,0x65,0x73,0x70,
+	0x61,0x69,0x72,0x21,0x27,0x0A,0x4E,0x6F,0x74,0x68,0x69,0x6E,0x67,0x20,0x62,0x65,
+	0x73,0x69,0x64,0x65,0x20,0x72,0x65,0x6D,0x61,0x69,0x6E,0x73,0x2E,0x20,0x52,0x6F,
+	0x75,0x6E,0x64,0x20,0x74,0x68,0x65,0x20,0x64,0x65,0x63,0x61,0x79,0x0A,0x4F,0x66,
+	0x20,0x74,0x68,0x61,0x74,0x20,0x63,0x6F,0x6C,0x6F,0x73,0x73,0x61,0x6C,0x20,0x77,
+	0x72,0x65,0x63,0x6B,0x2C,0x20,0x62,0x6F,0x75,0x6E,0x64,0x6C,0x65,0x73,0x73,0x20,
+	0x61,0x6E,0x64,0x20,0x62,0x61,0x72,0x65,0x0A,0x54,0x68,0x65,0x20,0x6C,0x6F,0x6E,
+	0x65,0x20,0x61,0x6E,0x64,0x20,0x6C,0x65,0x76,0x65,0x6C,0x20,0x73,0x61,0x6E,0x64,
+	0x73,0x20,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x20,0x66,0x61,0x72,0x20,0x61,0x77,
+	0x61,0x79,0x2E
+};
+
+static Aurora::KEYIndexCache::FileList createFileList() {
+	Aurora::KEYIndexCache::FileList files(2);
+
+	files[0].path             = "/data/xoreos.bif";
+	files[0].isKEY            = false;
+	files[0].size             = sizeof(kBIF10File);
+	files[0].modificationTime = 1234;
+
+	files[1].path             = "/data/chitin.key";
+	files[1].isKEY            = true;
+	files[1].size             = sizeof(kKEYFile);
+	files[1].modificationTime = 5678;
+
+	return files;
+}
+
+static Common::MemoryReadStream *createCache(const Aurora::KEYIndexCache::FileList &files) {
+	std::vector<std::unique_ptr<Aurora::KEYFile>> keys;
+	std::vector<std::unique_ptr<Aurora::KEYDataFile>> dataFiles;
+
+	Common::MemoryReadStream keyStream(kKEYFile);
+	keys.emplace_back(std::make_unique<Aurora::KEYFile>(keyStream));
+
+	dataFiles.emplace_back(std::make_unique<Aurora::BIFFile>(new Common::MemoryReadStream(kBIF10File)));
+	dataFiles.back()->mergeKEY(*keys.back(), 0);
+
+	Common::MemoryWriteStreamDynamic cache(true);
+	Aurora::KEYIndexCache::write(cache, files, keys, dataFiles);
+
+	cache.setDisposable(false);
+	return new Common::MemoryReadStream(cache.getData(), cache.size(), true);
+}
+
+GTEST_TEST(KEYIndexCache, getFiles) {
+	const Aurora::KEYIndexCache::FileList files = createFileList();
+	const Aurora::KEYIndexCache cache(createCache(files));
+
+	const Aurora::KEYIndexCache::FileList &cacheFiles = cache.getFiles();
+	ASSERT_EQ(cacheFiles.size(), 2);
+
+	for (size_t i = 0; i < cacheFiles.size(); i++) {
+		EXPECT_STREQ(cacheFiles[i].path.c_str(), files[i].path.c_str()) << "At index " << i;
+
+		EXPECT_EQ(cacheFiles[i].isKEY           , files[i].isKEY           ) << "At index " << i;
+		EXPECT_EQ(cacheFiles[i].size            , files[i].size            ) << "At index " << i;
+		EXPECT_EQ(cacheFiles[i].modificationTime, files[i].modificationTime) << "At index " << i;
+	}
+}
+
+GTEST_TEST(KEYIndexCache, isCurrent) {
+	Aurora::KEYIndexCache::FileList files = createFileList();
+	const Aurora::KEYIndexCache cache(createCache(files));
+
+	EXPECT_TRUE(cache.isCurrent(files));
+
+	files[1].modificationTime++;
+	EXPECT_FALSE(cache.isCurrent(files));
+
+	files = createFileList();
+	files[0].size++;
+	EXPECT_FALSE(cache.isCurrent(files));
+
+	files = createFileList();
+	std::swap(files[0], files[1]);
+	EXPECT_FALSE(cache.isCurrent(files));
+
+	files = createFileList();
+	files.pop_back();
+	EXPECT_FALSE(cache.isCurrent(files));
+}
+
+GTEST_TEST(KEYIndexCache, createKEY) {
+	const Aurora::KEYIndexCache cache(createCache(createFileList()));
+
+	std::unique_ptr<Aurora::KEYFile> key(cache.createKEY(0));
+	ASSERT_TRUE(key);
+
+	const Aurora::KEYFile::BIFList &bifs = key->getBIFs();
+	ASSERT_EQ(bifs.size(), 1);
+
+	EXPECT_STREQ(bifs[0].c_str(), "xoreos.bif");
+
+	const Aurora::KEYFile::ResourceList &resources = key->getResources();
+	ASSERT_EQ(resources.size(), 1);
+
+	EXPECT_STREQ(resources[0].name.c_str(), "ozymandias");
+	EXPECT_EQ(resources[0].type, Aurora::kFileTypeTXT);
+	EXPECT_EQ(resources[0].bifIndex, 0);
+	EXPECT_EQ(resources[0].resIndex, 0);
+
+	EXPECT_THROW(cache.createKEY(1), Common::Exception);
+}
+
+GTEST_TEST(KEYIndexCache, createDataFile) {
+	const Aurora::KEYIndexCache cache(createCache(createFileList()));
+
+	std::unique_ptr<Aurora::KEYDataFile> bif(cache.createDataFile(0, new Common::MemoryReadStream(kBIF10File)));
+	ASSERT_TRUE(bif);
+
+	EXPECT_EQ(bif->getInternalResourceCount(), 1);
+
+	const Aurora::KEYDataFile::ResourceList &resources = bif->getResources();
+	ASSERT_EQ(resources.size(), 1);
+
+	EXPECT_STREQ(resources.begin()->name.c_str(), "ozymandias");
+	EXPECT_EQ(resources.begin()->type, Aurora::kFileTypeTXT);
+	EXPECT_EQ(resources.begin()->index, 0);
+
+	EXPECT_EQ(bif->getResourceSize(0), strlen(kFileData));
+
+	std::unique_ptr<Common::SeekableReadStream> file(bif->getResource(0));
+	ASSERT_TRUE(file);
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	EXPECT_THROW(cache.createDataFile(1, new Common::MemoryReadStream(kBIF10File)), Common::Exception);
+}
+
+GTEST_TEST(KEYIndexCache, invalid) {
+	static const byte kInvalid[] = { 'K', 'I', 'D', 'X', 'V', '9', '.', '9', 0x00, 0x00, 0x00, 0x00 };
+
+	EXPECT_THROW(Aurora::KEYIndexCache cache(new Common::MemoryReadStream(kKEYFile)), Common::Exception);
+	EXPECT_THROW(Aurora::KEYIndexCache cache(new Common::MemoryReadStream(kInvalid)), Common::Exception);
+}
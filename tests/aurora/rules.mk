@@ -86,6 +86,16 @@ tests_aurora_test_bzffile_SOURCES  = tests/aurora/bzffile.cpp
 tests_aurora_test_bzffile_LDADD    = $(aurora_LIBS)
 tests_aurora_test_bzffile_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                          += tests/aurora/test_keyindexcache
+tests_aurora_test_keyindexcache_SOURCES  = tests/aurora/keyindexcache.cpp
+tests_aurora_test_keyindexcache_LDADD    = $(aurora_LIBS)
+tests_aurora_test_keyindexcache_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                        += tests/aurora/test_compression
+tests_aurora_test_compression_SOURCES  = tests/aurora/compression.cpp
+tests_aurora_test_compression_LDADD    = $(aurora_LIBS)
+tests_aurora_test_compression_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                    += tests/aurora/test_erffile
 tests_aurora_test_erffile_SOURCES  = tests/aurora/erffile.cpp
 tests_aurora_test_erffile_LDADD    = $(aurora_LIBS)
@@ -262,3 +262,52 @@ GTEST_TEST(Small0x10, compressRoundTrip) {
 	ASSERT_EQ(uncompressedWrite.size(), strlen(kDataUncompressed));
 	compareData(uncompressedWrite.getData(), kDataUncompressed);
 }
+
+GTEST_TEST(Small0x10, compressOptimalRoundTrip) {
+	Common::MemoryWriteStreamDynamic compressedWrite(true);
+	Common::MemoryReadStream uncompressedRead(kDataUncompressed);
+
+	Aurora::Small::compress10(uncompressedRead, compressedWrite, true);
+
+	// The optimal compression must never be worse than the greedy one
+	EXPECT_LE(compressedWrite.size(), sizeof(kDataCompressed10));
+
+
+	Common::MemoryWriteStreamDynamic uncompressedWrite(true);
+	Common::MemoryReadStream compressedRead(compressedWrite.getData(), compressedWrite.size());
+
+	Aurora::Small::decompress(compressedRead, uncompressedWrite);
+
+
+	ASSERT_EQ(uncompressedWrite.size(), strlen(kDataUncompressed));
+	compareData(uncompressedWrite.getData(), kDataUncompressed);
+}
+
+GTEST_TEST(Small0x10, compressRepetitiveRoundTrip) {
+	/* Long runs and short periods, with occurrences further back than
+	 * the 0x1000 bytes window, to stress the finding of occurrences. */
+
+	static const size_t kSize = 0x3000;
+
+	byte data[kSize];
+	for (size_t i = 0; i < kSize; i++)
+		data[i] = (i < 0x800) ? 0x00 : (byte) ((i % 7) ^ ((i / 0x1100) * 3));
+
+	for (int optimal = 0; optimal < 2; optimal++) {
+		Common::MemoryWriteStreamDynamic compressedWrite(true);
+		Common::MemoryReadStream uncompressedRead(data);
+
+		Aurora::Small::compress10(uncompressedRead, compressedWrite, optimal != 0);
+		EXPECT_LT(compressedWrite.size(), kSize / 4) << "Optimal: " << optimal;
+
+
+		Common::MemoryWriteStreamDynamic uncompressedWrite(true);
+		Common::MemoryReadStream compressedRead(compressedWrite.getData(), compressedWrite.size());
+
+		Aurora::Small::decompress(compressedRead, uncompressedWrite);
+
+
+		ASSERT_EQ(uncompressedWrite.size(), kSize) << "Optimal: " << optimal;
+		compareData(uncompressedWrite.getData(), data, kSize);
+	}
+}
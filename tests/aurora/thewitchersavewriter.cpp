@@ -24,6 +24,7 @@
 
 #include "gtest/gtest.h"
 
+#include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
 #include "src/aurora/thewitchersavewriter.h"
@@ -23,6 +23,7 @@
  */
 
 #include <vector>
+#include <memory>
 
 #include "gtest/gtest.h"
 
@@ -81,3 +82,67 @@ GTEST_TEST(Blowfish, misalign) {
 
 	EXPECT_THROW(Common::decryptBlowfishEBC(cipherText, key), Common::Exception);
 }
+
+GTEST_TEST(Blowfish, decryptStream) {
+	Common::MemoryReadStream cipherText(kCypherText);
+
+	std::vector<byte> key;
+	createKey(key);
+
+	std::unique_ptr<Common::SeekableReadStream> clearText(Common::decryptBlowfishEBCStream(&cipherText, key));
+	ASSERT_EQ(clearText->size(), ARRAYSIZE(kCypherText));
+
+	for (size_t i = 0; i < ARRAYSIZE(kClearText); i++)
+		EXPECT_EQ(clearText->readByte(), kClearText[i]) << "At index " << i;
+
+	// Seek backwards, into the middle of a block
+	clearText->seek(5);
+	for (size_t i = 5; i < ARRAYSIZE(kClearText); i++)
+		EXPECT_EQ(clearText->readByte(), kClearText[i]) << "At index " << i;
+}
+
+GTEST_TEST(Blowfish, decryptStreamLarge) {
+	// Encrypt a larger buffer, large enough to exercise the whole-block read path
+	static const size_t kSize = 4096 + 8;
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kSize);
+	for (size_t i = 0; i < kSize; i++)
+		data[i] = (byte) (i * 7);
+
+	Common::MemoryReadStream clearText(data.get(), kSize);
+
+	std::vector<byte> key;
+	createKey(key);
+
+	std::unique_ptr<Common::MemoryReadStream> cipherText(Common::encryptBlowfishEBC(clearText, key));
+	std::unique_ptr<Common::MemoryReadStream> decrypted(Common::decryptBlowfishEBC(*cipherText, key));
+
+	std::unique_ptr<Common::SeekableReadStream> stream(Common::decryptBlowfishEBCStream(cipherText.get(), key));
+	ASSERT_EQ(stream->size(), kSize);
+
+	std::unique_ptr<byte[]> readData = std::make_unique<byte[]>(kSize);
+
+	stream->seek(3);
+	ASSERT_EQ(stream->read(readData.get(), 10), 10);
+	for (size_t i = 0; i < 10; i++)
+		EXPECT_EQ(readData[i], data[3 + i]) << "At index " << i;
+
+	stream->seek(0);
+	ASSERT_EQ(stream->read(readData.get(), kSize), kSize);
+	EXPECT_FALSE(stream->eos());
+
+	for (size_t i = 0; i < kSize; i++)
+		EXPECT_EQ(readData[i], decrypted->getData()[i]) << "At index " << i;
+
+	EXPECT_EQ(stream->read(readData.get(), 1), 0);
+	EXPECT_TRUE(stream->eos());
+}
+
+GTEST_TEST(Blowfish, decryptStreamMisalign) {
+	Common::MemoryReadStream cipherText(kCypherText, 7);
+
+	std::vector<byte> key;
+	createKey(key);
+
+	EXPECT_THROW(Common::decryptBlowfishEBCStream(&cipherText, key), Common::Exception);
+}
@@ -19,13 +19,18 @@
  */
 
 /** @file
- *  Unit tests for our DEFLATE decompressor (which uses zlib).
+ *  Unit tests for our DEFLATE compressor and decompressor (which use zlib).
  */
 
+#include <cstring>
+
+#include <memory>
+
 #include "gtest/gtest.h"
 
 #include "src/common/deflate.h"
 #include "src/common/memreadstream.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
 
 // Percy Bysshe Shelley's "Ozymandias"
@@ -266,3 +271,76 @@ GTEST_TEST(DEFLATE, decompressChunked) {
 
 	delete[] output;
 }
+
+static void fillCompressible(byte *data, size_t size) {
+	// Lots of text, with some noise in between
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = ((i % 97) == 0) ? (seed >> 16) : kDataUncompressed[i % strlen(kDataUncompressed)];
+	}
+}
+
+GTEST_TEST(DEFLATE, compressLevels) {
+	static const size_t kSize = 300000;
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kSize);
+	fillCompressible(data.get(), kSize);
+
+	static const int kLevels[] = {
+		Common::kDeflateLevelNone, Common::kDeflateLevelFastest, 6, Common::kDeflateLevelBest
+	};
+
+	for (size_t l = 0; l < ARRAYSIZE(kLevels); l++) {
+		size_t compressedSize = 0;
+		std::unique_ptr<byte[]> compressed(Common::compressDeflate(data.get(), kSize, compressedSize,
+		                                                           Common::kWindowBitsMaxRaw, kLevels[l]));
+
+		if (kLevels[l] == Common::kDeflateLevelNone)
+			EXPECT_GT(compressedSize, kSize) << "At level " << kLevels[l];
+		else
+			EXPECT_LT(compressedSize, kSize / 4) << "At level " << kLevels[l];
+
+		std::unique_ptr<byte[]> decompressed(Common::decompressDeflate(compressed.get(), compressedSize,
+		                                                               kSize, Common::kWindowBitsMaxRaw));
+
+		EXPECT_EQ(std::memcmp(decompressed.get(), data.get(), kSize), 0) << "At level " << kLevels[l];
+	}
+}
+
+GTEST_TEST(DEFLATE, compressStrategies) {
+	static const size_t kSize = 100000;
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kSize);
+	fillCompressible(data.get(), kSize);
+
+	static const Common::DeflateStrategy kStrategies[] = {
+		Common::kDeflateStrategyDefault, Common::kDeflateStrategyFiltered, Common::kDeflateStrategyHuffmanOnly,
+		Common::kDeflateStrategyRLE, Common::kDeflateStrategyFixed
+	};
+
+	for (size_t s = 0; s < ARRAYSIZE(kStrategies); s++) {
+		Common::MemoryReadStream input(data.get(), kSize);
+
+		std::unique_ptr<Common::SeekableReadStream> compressed(Common::compressDeflate(input, kSize,
+			Common::kWindowBitsMax, Common::kDeflateLevelBest, kStrategies[s]));
+
+		std::unique_ptr<Common::SeekableReadStream> decompressed(Common::decompressDeflate(*compressed,
+			compressed->size(), kSize, Common::kWindowBitsMax));
+
+		ASSERT_EQ(decompressed->size(), kSize) << "With strategy " << s;
+
+		std::unique_ptr<byte[]> output = std::make_unique<byte[]>(kSize);
+		ASSERT_EQ(decompressed->read(output.get(), kSize), kSize) << "With strategy " << s;
+
+		EXPECT_EQ(std::memcmp(output.get(), data.get(), kSize), 0) << "With strategy " << s;
+	}
+}
+
+GTEST_TEST(DEFLATE, compressFailLevel) {
+	size_t compressedSize = 0;
+
+	EXPECT_THROW(Common::compressDeflate(reinterpret_cast<const byte *>(kDataUncompressed),
+	                                     strlen(kDataUncompressed), compressedSize,
+	                                     Common::kWindowBitsMax, 10), Common::Exception);
+}
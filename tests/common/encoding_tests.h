@@ -25,6 +25,11 @@
 #ifndef TESTS_COMMON_ENCODING_TESTS_H
 #define TESTS_COMMON_ENCODING_TESTS_H
 
+#include <cstring>
+
+#include <memory>
+#include <vector>
+
 GTEST_TEST(XOREOS_ENCODINGNAME, readString) {
 	testSupport(kEncoding);
 
@@ -67,6 +72,70 @@ GTEST_TEST(XOREOS_ENCODINGNAME, readStringBuf) {
 	EXPECT_STREQ(string.c_str(), stringUString.c_str());
 }
 
+GTEST_TEST(XOREOS_ENCODINGNAME, readStrings) {
+	testSupport(kEncoding);
+
+	byte data[sizeof(stringData0) + sizeof(stringData0X)];
+	std::memcpy(data, stringData0, sizeof(stringData0));
+	std::memcpy(data + sizeof(stringData0), stringData0X, sizeof(stringData0X));
+
+	Common::MemoryReadStream stream(data);
+
+	std::vector<Common::UString> strings;
+	Common::readStrings(stream, kEncoding, 2, strings);
+
+	ASSERT_EQ(strings.size(), 2);
+	for (size_t i = 0; i < strings.size(); i++)
+		EXPECT_STREQ(strings[i].c_str(), stringUString.c_str()) << "At index " << i;
+
+	EXPECT_EQ(stream.pos(), 2 * sizeof(stringData0));
+	EXPECT_FALSE(stream.eos());
+
+	// Only the garbage is left, followed by the end of the stream
+	Common::readStrings(stream, kEncoding, 3, strings);
+
+	ASSERT_EQ(strings.size(), 3);
+	EXPECT_FALSE(strings[0].empty());
+	EXPECT_TRUE(strings[1].empty());
+	EXPECT_TRUE(strings[2].empty());
+
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(XOREOS_ENCODINGNAME, readStringsBuf) {
+	testSupport(kEncoding);
+
+	byte data[sizeof(stringData0) + stringBytes];
+	std::memcpy(data, stringData0, sizeof(stringData0));
+	std::memcpy(data + sizeof(stringData0), stringData0, stringBytes);
+
+	std::vector<Common::UString> strings;
+	Common::readStrings(data, sizeof(data), kEncoding, strings);
+
+	ASSERT_EQ(strings.size(), 2);
+	for (size_t i = 0; i < strings.size(); i++)
+		EXPECT_STREQ(strings[i].c_str(), stringUString.c_str()) << "At index " << i;
+}
+
+GTEST_TEST(XOREOS_ENCODINGNAME, readString7bit) {
+	testSupport(kEncoding);
+
+	std::unique_ptr<Common::MemoryReadStream> data(Common::convertString("Foobar", kEncoding, true));
+	ASSERT_TRUE(data);
+
+	EXPECT_STREQ(Common::readString(*data, kEncoding).c_str(), "Foobar");
+	EXPECT_EQ(data->pos(), data->size());
+
+	data->seek(0);
+	EXPECT_STREQ(Common::readStringFixed(*data, kEncoding, data->size()).c_str(), "Foobar");
+
+	std::vector<Common::UString> strings;
+	Common::readStrings(data->getData(), data->size(), kEncoding, strings);
+
+	ASSERT_EQ(strings.size(), 1);
+	EXPECT_STREQ(strings[0].c_str(), "Foobar");
+}
+
 static void compareData(Common::SeekableReadStream &stream, const byte *data, size_t n, size_t t) {
 	for (size_t i = 0; i < n; i++)
 		EXPECT_EQ(stream.readByte(), data[i]) << "At case " << t << ", index " << i;
@@ -99,6 +168,25 @@ GTEST_TEST(XOREOS_ENCODINGNAME, convertString) {
 	delete stream;
 }
 
+GTEST_TEST(XOREOS_ENCODINGNAME, convertStringBuffer) {
+	testSupport(kEncoding);
+
+	// Start with garbage, to make sure it gets replaced
+	std::vector<byte> data(3, 0xFF);
+
+	ASSERT_TRUE(convertString(stringUString, kEncoding, data, false));
+
+	ASSERT_EQ(data.size(), stringBytes);
+	for (size_t i = 0; i < stringBytes; i++)
+		EXPECT_EQ(data[i], stringData0[i]) << "At index " << i;
+
+	ASSERT_TRUE(convertString(stringUString, kEncoding, data, true));
+
+	ASSERT_EQ(data.size(), sizeof(stringData0));
+	for (size_t i = 0; i < sizeof(stringData0); i++)
+		EXPECT_EQ(data[i], stringData0[i]) << "At index " << i;
+}
+
 GTEST_TEST(XOREOS_ENCODINGNAME, writeString) {
 	testSupport(kEncoding);
 
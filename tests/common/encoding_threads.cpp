@@ -0,0 +1,147 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Stress tests for encoding conversions from several threads at once.
+ */
+
+#include <cstring>
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/encoding.h"
+#include "src/common/memreadstream.h"
+
+#include "tests/common/encoding.h"
+
+static const size_t kThreadCount = 8;
+static const size_t kIterations  = 2000;
+
+// "Fööbär", UTF-8 encoded
+static const Common::UString kString = Common::UString("F""\xc3""\xb6""\xc3""\xb6""b""\xc3""\xa4""r");
+
+// The same string, encoded in Windows codepage 1252 and UTF-16LE
+static const byte kStringCP1252[] = { 'F', 0xF6, 0xF6, 'b', 0xE4, 'r', '\0' };
+static const byte kStringUTF16LE[] = {
+	'F', 0x00, 0xF6, 0x00, 0xF6, 0x00, 'b', 0x00, 0xE4, 0x00, 'r', 0x00, 0x00, 0x00
+};
+
+/** Run a function in several threads, all starting at the same time. */
+template<typename F>
+static void runThreads(F function) {
+	std::atomic<size_t> ready(0);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < kThreadCount; i++) {
+		threads.emplace_back([&ready, &function, i]() {
+			ready++;
+			while (ready < kThreadCount)
+				std::this_thread::yield();
+
+			function(i);
+		});
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+}
+
+/* This test has to come first, so that the conversion manager is created
+ * by several threads racing each other. */
+GTEST_TEST(EncodingThreads, hasSupportEncoding) {
+	std::atomic<size_t> supported(0);
+
+	runThreads([&supported](size_t UNUSED(thread)) {
+		if (Common::hasSupportEncoding(Common::kEncodingCP1252))
+			supported++;
+	});
+
+	EXPECT_TRUE((supported == 0) || (supported == kThreadCount));
+}
+
+GTEST_TEST(EncodingThreads, convertString) {
+	testSupport(Common::kEncodingCP1252);
+	testSupport(Common::kEncodingUTF16LE);
+
+	std::atomic<size_t> failures(0);
+
+	runThreads([&failures](size_t thread) {
+		const Common::Encoding encoding = (thread % 2) ? Common::kEncodingUTF16LE : Common::kEncodingCP1252;
+
+		const byte  *expected     = (thread % 2) ? kStringUTF16LE : kStringCP1252;
+		const size_t expectedSize = (thread % 2) ? sizeof(kStringUTF16LE) : sizeof(kStringCP1252);
+
+		std::vector<byte> data;
+
+		for (size_t i = 0; i < kIterations; i++) {
+			std::unique_ptr<Common::MemoryReadStream> stream(Common::convertString(kString, encoding));
+			if (!stream || (stream->size() != expectedSize) ||
+			    (std::memcmp(stream->getData(), expected, expectedSize) != 0))
+				failures++;
+
+			if (!Common::convertString(kString, encoding, data) || (data.size() != expectedSize) ||
+			    (std::memcmp(data.data(), expected, expectedSize) != 0))
+				failures++;
+		}
+	});
+
+	EXPECT_EQ(failures, 0);
+}
+
+GTEST_TEST(EncodingThreads, readString) {
+	testSupport(Common::kEncodingCP1252);
+	testSupport(Common::kEncodingUTF16LE);
+
+	std::atomic<size_t> failures(0);
+
+	runThreads([&failures](size_t thread) {
+		for (size_t i = 0; i < kIterations; i++) {
+			Common::MemoryReadStream streamCP1252(kStringCP1252);
+			Common::MemoryReadStream streamUTF16LE(kStringUTF16LE);
+
+			// Interleave the encodings differently in each thread
+			if (thread % 2) {
+				if (Common::readString(streamUTF16LE, Common::kEncodingUTF16LE) != kString)
+					failures++;
+				if (Common::readString(streamCP1252, Common::kEncodingCP1252) != kString)
+					failures++;
+			} else {
+				if (Common::readString(streamCP1252, Common::kEncodingCP1252) != kString)
+					failures++;
+				if (Common::readString(streamUTF16LE, Common::kEncodingUTF16LE) != kString)
+					failures++;
+			}
+
+			// Round-trip through the other direction as well
+			std::unique_ptr<Common::MemoryReadStream> stream(Common::convertString(kString, Common::kEncodingCP1252));
+			if (!stream || (Common::readString(*stream, Common::kEncodingCP1252) != kString))
+				failures++;
+		}
+	});
+
+	EXPECT_EQ(failures, 0);
+}
@@ -33,6 +33,7 @@
  * depending on the file and directory structure:
  * - Common::FilePath::findSubDirectory()
  * - Common::FilePath::getSubDirectories()
+ * - Common::FilePath::getFiles()
  * - Common::FilePath::createDirectories()
  *
  * The following methods can't be tested because their behaviour changes
@@ -60,6 +60,56 @@ GTEST_TEST(Hash, CRC32Encoding) {
 	EXPECT_EQ(Common::hashString(kString, Common::kHashCRC32, Common::kEncodingUTF16LE), 0x56031CD6);
 }
 
+GTEST_TEST(Hash, hashData) {
+	static const byte kData[] = { 'F', 0x00, 'o', 0x00, 'o', 0x00, 'b', 0x00, 'a', 0x00, 'r', 0x00 };
+
+	EXPECT_EQ(Common::hashData(kData, sizeof(kData), Common::kHashDJB2) , 0xD11D54FE);
+	EXPECT_EQ(Common::hashData(kData, sizeof(kData), Common::kHashFNV32), 0xCE5005F0);
+	EXPECT_EQ(Common::hashData(kData, sizeof(kData), Common::kHashFNV64), UINT64_C(0xA73456F669A95770));
+	EXPECT_EQ(Common::hashData(kData, sizeof(kData), Common::kHashCRC32), 0x56031CD6);
+}
+
+GTEST_TEST(Hash, EncodingSurrogates) {
+	// U+1D11E, MUSICAL SYMBOL G CLEF, needs a surrogate pair in UTF-16
+	static const Common::UString kClef = Common::UString("a\xF0\x9D\x84\x9E");
+	static const byte kDataLE[] = { 'a', 0x00, 0x34, 0xD8, 0x1E, 0xDD };
+	static const byte kDataBE[] = { 0x00, 'a', 0xD8, 0x34, 0xDD, 0x1E };
+
+	EXPECT_EQ(Common::hashString(kClef, Common::kHashFNV64, Common::kEncodingUTF16LE),
+	          Common::hashData(kDataLE, sizeof(kDataLE), Common::kHashFNV64));
+	EXPECT_EQ(Common::hashString(kClef, Common::kHashFNV64, Common::kEncodingUTF16BE),
+	          Common::hashData(kDataBE, sizeof(kDataBE), Common::kHashFNV64));
+}
+
+GTEST_TEST(Hash, hashStrings) {
+	const std::vector<Common::UString> strings = { kString, "", "erf.dict", "F""\xc3""\xb6""\xc3""\xb6""b""\xc3""\xa4""r" };
+
+	for (int algo = 0; algo < Common::kHashMAX; algo++) {
+		std::vector<uint64_t> hashes;
+
+		Common::hashStrings(strings, (Common::HashAlgo) algo, hashes);
+		ASSERT_EQ(hashes.size(), strings.size());
+
+		for (size_t i = 0; i < strings.size(); i++)
+			EXPECT_EQ(hashes[i], Common::hashString(strings[i], (Common::HashAlgo) algo)) << algo << ", " << i;
+	}
+}
+
+GTEST_TEST(Hash, hashStringsEncoding) {
+	const std::vector<Common::UString> strings = { kString, "", "erf.dict", "F""\xc3""\xb6""\xc3""\xb6""b""\xc3""\xa4""r" };
+
+	for (int algo = 0; algo < Common::kHashMAX; algo++) {
+		std::vector<uint64_t> hashes;
+
+		Common::hashStrings(strings, (Common::HashAlgo) algo, Common::kEncodingUTF16LE, hashes);
+		ASSERT_EQ(hashes.size(), strings.size());
+
+		for (size_t i = 0; i < strings.size(); i++)
+			EXPECT_EQ(hashes[i], Common::hashString(strings[i], (Common::HashAlgo) algo, Common::kEncodingUTF16LE))
+				<< algo << ", " << i;
+	}
+}
+
 GTEST_TEST(Hash, formatHash) {
 	EXPECT_STREQ(Common::formatHash(UINT64_C(0x1234567890ABCDEF)).c_str(), "0x1234567890ABCDEF");
 }
@@ -19,13 +19,18 @@
  */
 
 /** @file
- *  Unit tests for our LZMA decompressor (which uses lzma).
+ *  Unit tests for our LZMA compressor and decompressor (which use lzma).
  */
 
+#include <cstring>
+
+#include <memory>
+
 #include "gtest/gtest.h"
 
 #include "src/common/lzma.h"
 #include "src/common/memreadstream.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
 
 // Percy Bysshe Shelley's "Ozymandias"
@@ -132,3 +137,54 @@ GTEST_TEST(LZMA1, decompressFailInputCut) {
 	EXPECT_THROW(Common::decompressLZMA1(kDataCompressed, kSizeCompressed, kSizeDecompressed),
 	             Common::Exception);
 }
+
+GTEST_TEST(LZMA1, compressLevels) {
+	static const size_t kSize = 300000;
+
+	// Lots of text, with some noise in between
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kSize);
+
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < kSize; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = ((i % 97) == 0) ? (seed >> 16) : kDataUncompressed[i % strlen(kDataUncompressed)];
+	}
+
+	static const uint kLevels[] = { 0, Common::kLZMALevelDefault, Common::kLZMALevelBest };
+
+	for (size_t l = 0; l < ARRAYSIZE(kLevels); l++) {
+		for (int extreme = 0; extreme < 2; extreme++) {
+			size_t compressedSize = 0;
+			std::unique_ptr<byte[]> compressed(Common::compressLZMA1(data.get(), kSize, compressedSize,
+			                                                         kLevels[l], extreme != 0));
+
+			EXPECT_LT(compressedSize, kSize / 4) << "At level " << kLevels[l] << ", " << extreme;
+
+			std::unique_ptr<byte[]> decompressed(Common::decompressLZMA1(compressed.get(), compressedSize, kSize));
+
+			EXPECT_EQ(std::memcmp(decompressed.get(), data.get(), kSize), 0) << "At level " << kLevels[l] << ", " << extreme;
+		}
+	}
+}
+
+GTEST_TEST(LZMA1, compressStream) {
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::MemoryReadStream input(kDataUncompressed);
+
+	std::unique_ptr<Common::SeekableReadStream> compressed(Common::compressLZMA1(input, kSizeDecompressed));
+	std::unique_ptr<Common::SeekableReadStream> decompressed(Common::decompressLZMA1(*compressed,
+		compressed->size(), kSizeDecompressed));
+
+	ASSERT_EQ(decompressed->size(), kSizeDecompressed);
+
+	for (size_t i = 0; i < kSizeDecompressed; i++)
+		EXPECT_EQ(decompressed->readByte(), kDataUncompressed[i]) << "At index " << i;
+}
+
+GTEST_TEST(LZMA1, compressFailLevel) {
+	size_t compressedSize = 0;
+
+	EXPECT_THROW(Common::compressLZMA1(reinterpret_cast<const byte *>(kDataUncompressed),
+	                                   strlen(kDataUncompressed), compressedSize, 10), Common::Exception);
+}
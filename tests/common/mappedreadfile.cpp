@@ -0,0 +1,113 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our memory-mapped file read stream.
+ */
+
+#include <string>
+#include <memory>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/platform.h"
+#include "src/common/mappedreadfile.h"
+
+static const byte kData[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+boost::filesystem::path kFilePath;
+
+class MappedReadFile : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kFilePath = tmpPath / uniquePath;
+
+		boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+		testFile.write(reinterpret_cast<const char *>(kData), ARRAYSIZE(kData));
+		testFile.flush();
+		testFile.close();
+	}
+
+	static void TearDownTestCase() {
+		if (!kFilePath.empty())
+			boost::filesystem::remove(kFilePath);
+	}
+};
+
+GTEST_TEST_F(MappedReadFile, read) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.size(), ARRAYSIZE(kData));
+
+	byte readData[ARRAYSIZE(kData)];
+	const size_t readCount = file.read(readData, sizeof(readData));
+	EXPECT_EQ(readCount, ARRAYSIZE(readData));
+	EXPECT_FALSE(file.eos());
+
+	EXPECT_EQ(file.read(readData, 1), 0);
+	EXPECT_TRUE(file.eos());
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(readData[i], kData[i]) << "At index " << i;
+
+	file.seek(2);
+	EXPECT_FALSE(file.eos());
+	EXPECT_EQ(file.readByte(), kData[2]);
+
+	file.close();
+	ASSERT_FALSE(file.isOpen());
+}
+
+GTEST_TEST_F(MappedReadFile, getSubStream) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	std::unique_ptr<Common::SeekableReadStream> sub1(file.getSubStream(1, 4));
+	std::unique_ptr<Common::SeekableReadStream> sub2(file.getSubStream(2, 5));
+
+	EXPECT_EQ(sub1->size(), 3);
+	EXPECT_EQ(sub2->size(), 3);
+
+	// The sub streams are independent of each other and of the parent stream
+	EXPECT_EQ(sub1->readByte(), kData[1]);
+	EXPECT_EQ(sub2->readByte(), kData[2]);
+	EXPECT_EQ(sub1->readByte(), kData[2]);
+	EXPECT_EQ(sub2->readByte(), kData[3]);
+	EXPECT_EQ(file.pos(), 0);
+
+	EXPECT_THROW(file.getSubStream(4, 6), Common::Exception);
+	EXPECT_THROW(file.getSubStream(3, 2), Common::Exception);
+}
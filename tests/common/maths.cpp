@@ -54,6 +54,23 @@ GTEST_TEST(Maths, deg2rad) {
 	EXPECT_FLOAT_EQ(Common::deg2rad(-360.0f), -M_PI * 2.0f);
 }
 
+GTEST_TEST(Maths, getEntropy) {
+	static const byte kSame[] = { 23, 23, 23, 23, 23, 23, 23, 23 };
+	static const byte kTwo[]  = {  0,  1,  0,  1,  0,  1,  0,  1 };
+	static const byte kFour[] = {  0,  1,  2,  3,  3,  2,  1,  0 };
+
+	EXPECT_DOUBLE_EQ(Common::getEntropy(kSame, 0), 0.0);
+	EXPECT_DOUBLE_EQ(Common::getEntropy(kSame, sizeof(kSame)), 0.0);
+	EXPECT_DOUBLE_EQ(Common::getEntropy(kTwo , sizeof(kTwo )), 1.0);
+	EXPECT_DOUBLE_EQ(Common::getEntropy(kFour, sizeof(kFour)), 2.0);
+
+	byte all[512];
+	for (size_t i = 0; i < sizeof(all); i++)
+		all[i] = i & 0xFF;
+
+	EXPECT_DOUBLE_EQ(Common::getEntropy(all, sizeof(all)), 8.0);
+}
+
 GTEST_TEST(Maths, rad2deg) {
 	EXPECT_FLOAT_EQ(Common::rad2deg(        0.0f),    0.0f);
 	EXPECT_FLOAT_EQ(Common::rad2deg( M_PI       ),  180.0f);
@@ -22,6 +22,8 @@
  *  Unit tests for our memory read stream.
  */
 
+#include <memory>
+
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
@@ -105,6 +107,42 @@ GTEST_TEST(MemoryReadStream, readStream) {
 	EXPECT_THROW(stream.readStream(ARRAYSIZE(data) + 1), Common::Exception);
 }
 
+GTEST_TEST(MemoryReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	stream.seek(1);
+
+	byte readData[4] = { 0 };
+	EXPECT_EQ(stream.readAt(2, readData, 2), 2);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+
+	EXPECT_EQ(stream.readAt(3, readData, 4), 2);
+	EXPECT_EQ(readData[0], data[3]);
+	EXPECT_EQ(readData[1], data[4]);
+
+	EXPECT_EQ(stream.readAt(6, readData, 1), 0);
+
+	EXPECT_EQ(stream.pos(), 1);
+	EXPECT_FALSE(stream.eos());
+}
+
+GTEST_TEST(MemoryReadStream, readStreamAt) {
+	static const byte data[3] = { 0x12, 0x34, 0x56 };
+	Common::MemoryReadStream stream(data);
+
+	std::unique_ptr<Common::MemoryReadStream> streamRead(stream.readStreamAt(1, 2));
+
+	EXPECT_EQ(streamRead->size(), 2);
+	EXPECT_EQ(streamRead->readByte(), data[1]);
+	EXPECT_EQ(streamRead->readByte(), data[2]);
+
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_THROW(stream.readStreamAt(1, 3), Common::Exception);
+}
+
 GTEST_TEST(MemoryReadStream, readChar) {
 	static const byte data[3] = { 0x12, 0x34, 0x56 };
 	Common::MemoryReadStream stream(data);
@@ -315,6 +353,45 @@ GTEST_TEST(SeekableSubReadStream, fromMem) {
 	EXPECT_FALSE(subStream.eos());
 }
 
+GTEST_TEST(SeekableSubReadStream, interleaved) {
+	static const byte data[6] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB };
+	Common::MemoryReadStream stream(data);
+
+	Common::SeekableSubReadStream subStream1(&stream, 0, 3);
+	Common::SeekableSubReadStream subStream2(&stream, 3, 6);
+
+	// Reading from one substream must not disturb the other, or the parent
+	EXPECT_EQ(subStream1.readByte(), data[0]);
+	EXPECT_EQ(subStream2.readByte(), data[3]);
+	EXPECT_EQ(subStream1.readByte(), data[1]);
+	EXPECT_EQ(subStream2.readByte(), data[4]);
+	EXPECT_EQ(subStream1.readByte(), data[2]);
+	EXPECT_EQ(subStream2.readByte(), data[5]);
+
+	EXPECT_EQ(stream.pos(), 0);
+}
+
+GTEST_TEST(SeekableSubReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	Common::SeekableSubReadStream subStream(&stream, 1, 4);
+	Common::SeekableSubReadStream subSubStream(&subStream, 1, 3);
+
+	byte readData[4] = { 0 };
+	EXPECT_EQ(subStream.readAt(1, readData, 4), 2);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+
+	EXPECT_EQ(subSubStream.read(readData, 4), 2);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+	EXPECT_TRUE(subSubStream.eos());
+
+	EXPECT_EQ(subStream.pos(), 0);
+	EXPECT_FALSE(subStream.eos());
+}
+
 GTEST_TEST(SeekableSubReadStreamEndian, streamEndianLE) {
 	static const byte data[4] = { 0x78, 0x56, 0x34, 0x12 };
 	Common::MemoryReadStream stream(data);
@@ -63,6 +63,23 @@ GTEST_TEST(MemoryWriteStream, writeStream) {
 		EXPECT_EQ(data[i], writeData[i]) << "At index " << i;
 }
 
+GTEST_TEST(MemoryWriteStream, writeStreamBufferSize) {
+	static const byte writeData[11] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45 };
+	Common::MemoryReadStream writeStream(writeData);
+
+	byte data[ARRAYSIZE(writeData)] = { 0 };
+	Common::MemoryWriteStream stream(data);
+
+	const size_t writeCount = stream.writeStream(writeStream, 10, 3);
+	EXPECT_EQ(writeCount, 10);
+	EXPECT_EQ(writeStream.pos(), 10);
+
+	for (size_t i = 0; i < 10; i++)
+		EXPECT_EQ(data[i], writeData[i]) << "At index " << i;
+
+	EXPECT_EQ(data[10], 0x00);
+}
+
 GTEST_TEST(MemoryWriteStream, writeByte) {
 	byte data[1] = { 0 };
 	Common::MemoryWriteStream stream(data);
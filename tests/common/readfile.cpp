@@ -22,7 +22,12 @@
  *  Unit tests for our file read stream.
  */
 
+#include <cstring>
+
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
 #include <iostream>
 
 #include <boost/filesystem.hpp>
@@ -87,3 +92,63 @@ GTEST_TEST_F(ReadFile, write) {
 	for (size_t i = 0; i < ARRAYSIZE(data); i++)
 		EXPECT_EQ(readData[i], data[i]) << "At index " << i;
 }
+
+GTEST_TEST_F(ReadFile, readAt) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const size_t kDataSize = 4096;
+
+	byte data[kDataSize];
+	for (size_t i = 0; i < kDataSize; i++)
+		data[i] = (byte) ((i * 7) ^ (i >> 8));
+
+	// Create the input file
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	Common::ReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	file.seek(100);
+
+	// Read the file positionally from several threads at once
+
+	std::vector<std::thread> threads;
+	std::atomic<size_t> mismatches(0);
+
+	for (size_t t = 0; t < 4; t++) {
+		threads.emplace_back([&file, &data, &mismatches, t]() {
+			byte readData[16];
+
+			for (size_t i = 0; i < 1000; i++) {
+				const size_t offset = ((t * 1000 + i) * 61) % (kDataSize - sizeof(readData));
+
+				if ((file.readAt(offset, readData, sizeof(readData)) != sizeof(readData)) ||
+				    (std::memcmp(readData, data + offset, sizeof(readData)) != 0))
+					mismatches++;
+			}
+		});
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	EXPECT_EQ(mismatches, 0);
+
+	// The position of the file must not have changed
+
+	EXPECT_EQ(file.pos(), 100);
+	EXPECT_EQ(file.readByte(), data[100]);
+
+	// Reads past the end are cut short
+
+	byte readData[8];
+	EXPECT_EQ(file.readAt(kDataSize - 4, readData, sizeof(readData)), 4);
+	EXPECT_EQ(file.readAt(kDataSize + 1, readData, sizeof(readData)), 0);
+}
@@ -0,0 +1,102 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our simple thread pool.
+ */
+
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+#include "src/common/threadpool.h"
+
+GTEST_TEST(ThreadPool, threadCount) {
+	Common::ThreadPool pool1(3);
+	EXPECT_EQ(pool1.getThreadCount(), 3);
+
+	Common::ThreadPool pool2(0);
+	EXPECT_EQ(pool2.getThreadCount(), Common::ThreadPool::getHardwareThreadCount());
+}
+
+GTEST_TEST(ThreadPool, jobs) {
+	static const size_t kJobCount = 1000;
+
+	std::vector<size_t> results(kJobCount, 0);
+	std::atomic<size_t> count(0);
+
+	Common::ThreadPool pool(4);
+	for (size_t i = 0; i < kJobCount; i++) {
+		pool.addJob([&results, &count, i](size_t thread) {
+			EXPECT_LT(thread, 4);
+
+			results[i] = i * 2;
+			count++;
+		});
+	}
+
+	pool.wait();
+
+	EXPECT_EQ(count, kJobCount);
+	for (size_t i = 0; i < kJobCount; i++)
+		EXPECT_EQ(results[i], i * 2) << "At index " << i;
+}
+
+GTEST_TEST(ThreadPool, exception) {
+	std::atomic<size_t> count(0);
+
+	Common::ThreadPool pool(2);
+	for (size_t i = 0; i < 10; i++) {
+		pool.addJob([&count, i](size_t) {
+			count++;
+
+			if (i == 5)
+				throw std::runtime_error("Nope");
+		});
+	}
+
+	EXPECT_THROW(pool.wait(), std::runtime_error);
+	EXPECT_EQ(count, 10);
+
+	// The exception has been consumed
+	pool.wait();
+}
+
+GTEST_TEST(ThreadPool, tasks) {
+	Common::ThreadPool pool(3);
+
+	std::vector<std::future<size_t>> results;
+	for (size_t i = 0; i < 100; i++)
+		results.push_back(pool.addTask<size_t>([i]() { return i * 3; }));
+
+	std::future<size_t> failed = pool.addTask<size_t>([]() -> size_t {
+		throw std::runtime_error("Nope");
+	});
+
+	for (size_t i = 0; i < results.size(); i++)
+		EXPECT_EQ(results[i].get(), i * 3) << "At index " << i;
+
+	EXPECT_THROW(failed.get(), std::runtime_error);
+
+	// The exception went into the future, not into the pool
+	pool.wait();
+}
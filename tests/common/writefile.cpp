@@ -24,6 +24,7 @@
 
 #include <string>
 #include <iostream>
+#include <iterator>
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
@@ -33,8 +34,11 @@
 #include "src/common/util.h"
 #include "src/common/platform.h"
 #include "src/common/writefile.h"
+#include "src/common/readfile.h"
+#include "src/common/memreadstream.h"
 
 boost::filesystem::path kFilePath;
+boost::filesystem::path kSourcePath;
 
 class WriteFile : public ::testing::Test {
 protected:
@@ -44,17 +48,22 @@ protected:
 		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
 		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
 
-		kFilePath = tmpPath / uniquePath;
+		kFilePath   = tmpPath / uniquePath;
+		kSourcePath = tmpPath / boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
 	}
 
 	static void TearDownTestCase() {
 		if (!kFilePath.empty())
 			boost::filesystem::remove(kFilePath);
+		if (!kSourcePath.empty())
+			boost::filesystem::remove(kSourcePath);
 	}
 
 	void SetUp() {
 		if (!kFilePath.empty())
 			boost::filesystem::remove(kFilePath);
+		if (!kSourcePath.empty())
+			boost::filesystem::remove(kSourcePath);
 	}
 };
 
@@ -165,3 +174,113 @@ GTEST_TEST_F(WriteFile, size) {
 	EXPECT_EQ(data[12], 0xCD);
 	EXPECT_EQ(data[13], 0xEF);
 }
+
+static std::string readTestFile(const boost::filesystem::path &path) {
+	boost::filesystem::ifstream testFile(path, std::ofstream::binary);
+
+	return std::string(std::istreambuf_iterator<char>(testFile), std::istreambuf_iterator<char>());
+}
+
+GTEST_TEST_F(WriteFile, writeStreamFromFile) {
+	ASSERT_FALSE(kFilePath.empty());
+	ASSERT_FALSE(kSourcePath.empty());
+
+	// Big enough to span several copy buffers, should the kernel not copy it
+	std::string source;
+	for (size_t i = 0; i < 3 * Common::WriteStream::kCopyBufferSize + 17; i++)
+		source += static_cast<char>((i * 7) ^ (i >> 8));
+
+	{
+		boost::filesystem::ofstream sourceFile(kSourcePath, std::ofstream::binary);
+		sourceFile.write(source.c_str(), source.size());
+		ASSERT_FALSE(sourceFile.fail());
+	}
+
+	Common::ReadFile input(kSourcePath.generic_string());
+	ASSERT_TRUE(input.isOpen());
+
+	Common::WriteFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	// Data still buffered in the output file has to end up in front of the copied data
+	file.writeString("Foo");
+
+	input.seek(5);
+	EXPECT_EQ(file.writeStream(input), source.size() - 5);
+	EXPECT_EQ(input.pos(), source.size());
+
+	// A range in the middle of the source file
+	Common::SeekableSubReadStream subStream(&input, 100, 100 + Common::WriteStream::kCopyBufferSize + 3);
+	subStream.seek(1);
+	EXPECT_EQ(file.writeStream(subStream, 1000), 1000);
+	EXPECT_EQ(subStream.pos(), 1001);
+	EXPECT_EQ(file.writeStream(subStream), Common::WriteStream::kCopyBufferSize + 2 - 1000);
+
+	file.writeString("Bar");
+
+	const size_t expectedSize = 3 + (source.size() - 5) + (Common::WriteStream::kCopyBufferSize + 2) + 3;
+	EXPECT_EQ(file.size(), expectedSize);
+	EXPECT_EQ(file.pos(), expectedSize);
+
+	file.flush();
+	file.close();
+
+	const std::string expected = "Foo" + source.substr(5) +
+	                             source.substr(101, Common::WriteStream::kCopyBufferSize + 2) + "Bar";
+
+	EXPECT_TRUE(readTestFile(kFilePath) == expected);
+}
+
+GTEST_TEST_F(WriteFile, writeStreamOverwrite) {
+	ASSERT_FALSE(kFilePath.empty());
+	ASSERT_FALSE(kSourcePath.empty());
+
+	{
+		boost::filesystem::ofstream sourceFile(kSourcePath, std::ofstream::binary);
+		sourceFile.write("abcdef", 6);
+		ASSERT_FALSE(sourceFile.fail());
+	}
+
+	Common::ReadFile input(kSourcePath.generic_string());
+	ASSERT_TRUE(input.isOpen());
+
+	Common::WriteFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	file.writeString("0123456789");
+	file.seek(2);
+
+	EXPECT_EQ(file.writeStream(input, 4), 4);
+	EXPECT_EQ(file.pos(), 6);
+	EXPECT_EQ(file.size(), 10);
+
+	file.writeString("X");
+
+	file.seek(0, Common::SeekableWriteStream::kOriginEnd);
+	EXPECT_EQ(file.writeStream(input), 2);
+	EXPECT_EQ(file.size(), 12);
+
+	file.flush();
+	file.close();
+
+	EXPECT_EQ(readTestFile(kFilePath), "01abcdX789ef");
+}
+
+GTEST_TEST_F(WriteFile, writeStreamFromMemory) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[7] = { 'F', 'o', 'o', 'b', 'a', 'r', '!' };
+	Common::MemoryReadStream input(data);
+
+	Common::WriteFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.writeStream(input, 6, 4), 6);
+	EXPECT_EQ(input.pos(), 6);
+	EXPECT_EQ(file.size(), 6);
+
+	file.flush();
+	file.close();
+
+	EXPECT_EQ(readTestFile(kFilePath), "Foobar");
+}
@@ -0,0 +1,117 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our generic image decoder interface.
+ */
+
+#include <cstring>
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+
+#include "src/images/decoder.h"
+
+/** A decoder creating layers of DXT5 mip maps out of pseudo-random data. */
+class TestDecoder : public Images::Decoder {
+public:
+	TestDecoder(size_t layerCount, int width, int height) {
+		_format     = Images::kPixelFormatDXT5;
+		_layerCount = layerCount;
+
+		uint32_t seed = 0;
+
+		for (size_t layer = 0; layer < layerCount; layer++) {
+			for (int w = width, h = height; (w > 0) && (h > 0); w /= 2, h /= 2) {
+				_mipMaps.emplace_back(std::make_unique<MipMap>());
+
+				MipMap &mipMap = *_mipMaps.back();
+
+				mipMap.width  = w;
+				mipMap.height = h;
+				mipMap.size   = MAX(((w + 3) / 4) * ((h + 3) / 4) * 16, 16);
+				mipMap.data   = std::make_unique<byte[]>(mipMap.size);
+
+				for (uint32_t i = 0; i < mipMap.size; i++) {
+					seed = seed * 1103515245 + 12345;
+					mipMap.data[i] = (seed >> 16) & 0xFF;
+				}
+			}
+		}
+	}
+
+	void decompressAll() {
+		decompress();
+	}
+};
+
+static void compareDecoders(const TestDecoder &decoder1, const TestDecoder &decoder2) {
+	ASSERT_EQ(decoder1.getFormat(), decoder2.getFormat());
+	ASSERT_EQ(decoder1.getLayerCount(), decoder2.getLayerCount());
+	ASSERT_EQ(decoder1.getMipMapCount(), decoder2.getMipMapCount());
+
+	for (size_t layer = 0; layer < decoder1.getLayerCount(); layer++) {
+		for (size_t i = 0; i < decoder1.getMipMapCount(); i++) {
+			const Images::Decoder::MipMap &mipMap1 = decoder1.getMipMap(i, layer);
+			const Images::Decoder::MipMap &mipMap2 = decoder2.getMipMap(i, layer);
+
+			ASSERT_EQ(mipMap1.width , mipMap2.width );
+			ASSERT_EQ(mipMap1.height, mipMap2.height);
+			ASSERT_EQ(mipMap1.size  , mipMap2.size  );
+
+			EXPECT_EQ(std::memcmp(mipMap1.data.get(), mipMap2.data.get(), mipMap1.size), 0)
+				<< "At layer " << layer << ", mip map " << i;
+		}
+	}
+}
+
+GTEST_TEST(ImagesDecoder, decompressThreaded) {
+	TestDecoder serial(6, 64, 32), threaded(6, 64, 32);
+
+	Images::Decoder::setThreadCount(1);
+	serial.decompressAll();
+
+	Images::Decoder::setThreadCount(4);
+	threaded.decompressAll();
+
+	Images::Decoder::setThreadCount(1);
+
+	EXPECT_EQ(serial.getFormat(), Images::kPixelFormatR8G8B8A8);
+
+	compareDecoders(serial, threaded);
+}
+
+GTEST_TEST(ImagesDecoder, decompressThreadedAuto) {
+	TestDecoder serial(1, 128, 128), threaded(1, 128, 128);
+
+	Images::Decoder::setThreadCount(1);
+	serial.decompressAll();
+
+	Images::Decoder::setThreadCount(0);
+	threaded.decompressAll();
+
+	Images::Decoder::setThreadCount(1);
+
+	compareDecoders(serial, threaded);
+}
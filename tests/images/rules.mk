@@ -36,3 +36,13 @@ check_PROGRAMS                       += tests/images/test_xoreositex
 tests_images_test_xoreositex_SOURCES  = tests/images/xoreositex.cpp
 tests_images_test_xoreositex_LDADD    = $(images_LIBS)
 tests_images_test_xoreositex_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                 += tests/images/test_s3tc
+tests_images_test_s3tc_SOURCES  = tests/images/s3tc.cpp
+tests_images_test_s3tc_LDADD    = $(images_LIBS)
+tests_images_test_s3tc_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/images/test_decoder
+tests_images_test_decoder_SOURCES  = tests/images/decoder.cpp
+tests_images_test_decoder_LDADD    = $(images_LIBS)
+tests_images_test_decoder_CXXFLAGS = $(test_CXXFLAGS)
@@ -0,0 +1,228 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our S3TC DXTn decompression methods.
+ */
+
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+
+#include "src/images/s3tc.h"
+
+// --- Straightforward floating point reference decoder ---
+
+static uint32_t convert565To8888(uint16_t color) {
+	return ((color & 0x1F) << 11) | ((color & 0x7E0) << 13) | ((color & 0xF800) << 16) | 0xFF;
+}
+
+static uint32_t interpolate32(double weight, uint32_t color_0, uint32_t color_1) {
+	uint32_t result = 0;
+
+	for (int shift = 0; shift < 32; shift += 8) {
+		const double c0 = (color_0 >> shift) & 0xFF;
+		const double c1 = (color_1 >> shift) & 0xFF;
+
+		result |= ((uint32_t)(byte)((1.0f - weight) * c0 + weight * c1)) << shift;
+	}
+
+	return result;
+}
+
+enum DXTType {
+	kDXT1,
+	kDXT3,
+	kDXT5
+};
+
+static void referenceDecompress(DXTType type, byte *dest, const byte *src,
+                                uint32_t width, uint32_t height, uint32_t pitch) {
+
+	for (int32_t ty = height; ty > 0; ty -= 4) {
+		for (uint32_t tx = 0; tx < width; tx += 4) {
+			uint16_t alpha3[4] = { 0, 0, 0, 0 };
+			double alpha5[8];
+			uint64_t alphabl = 0;
+
+			if (type == kDXT3) {
+				for (int i = 0; i < 4; i++)
+					alpha3[i] = READ_LE_UINT16(src + 2 * i);
+
+				src += 8;
+			} else if (type == kDXT5) {
+				alpha5[0] = src[0];
+				alpha5[1] = src[1];
+
+				const bool sevenMode = src[0] > src[1];
+				for (int i = 1; i < (sevenMode ? 7 : 5); i++) {
+					const int n = sevenMode ? 7 : 5;
+					alpha5[i + 1] = (byte)(((n - i) * alpha5[0] + i * alpha5[1] + (n / 2)) / (double)n);
+				}
+
+				if (!sevenMode) {
+					alpha5[6] = 0;
+					alpha5[7] = 255;
+				}
+
+				alphabl = READ_LE_UINT32(src + 2) | ((uint64_t)READ_LE_UINT16(src + 6) << 32);
+
+				src += 8;
+			}
+
+			const uint16_t color_0 = READ_LE_UINT16(src + 0);
+			const uint16_t color_1 = READ_LE_UINT16(src + 2);
+			uint32_t cpx = READ_BE_UINT32(src + 4);
+
+			src += 8;
+
+			const uint32_t mask = (type == kDXT1) ? 0xFFFFFFFF : 0xFFFFFF00;
+
+			uint32_t blended[4];
+			blended[0] = convert565To8888(color_0) & mask;
+			blended[1] = convert565To8888(color_1) & mask;
+
+			if ((type != kDXT1) || (color_0 > color_1)) {
+				blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
+				blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
+			} else {
+				blended[2] = interpolate32(0.5f, blended[0], blended[1]);
+				blended[3] = 0;
+			}
+
+			const uint32_t blockWidth  = MIN<uint32_t>(width , 4);
+			const uint32_t blockHeight = MIN<uint32_t>(height, 4);
+
+			for (uint32_t y = 0; y < blockHeight; ++y) {
+				for (uint32_t x = 0; x < blockWidth; ++x, cpx >>= 2) {
+					const uint32_t destX = tx + x;
+					const uint32_t destY = height - 1 - (ty - blockHeight + y);
+
+					uint32_t pixel = blended[cpx & 3];
+					if (type == kDXT3)
+						pixel |= ((alpha3[y] >> (x * 4)) & 0xF) << 4;
+					else if (type == kDXT5)
+						pixel |= (byte)alpha5[(alphabl >> (3 * (4 * (3 - y) + x))) & 7];
+
+					if ((destX < width) && (destY < height))
+						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
+				}
+			}
+		}
+	}
+}
+
+// --- Test helpers ---
+
+static std::vector<byte> createBlocks(size_t size, uint32_t seed) {
+	std::vector<byte> data(size);
+
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (seed >> 16) & 0xFF;
+	}
+
+	return data;
+}
+
+static size_t getBlockSize(DXTType type) {
+	return (type == kDXT1) ? 8 : 16;
+}
+
+static void decompress(DXTType type, byte *dest, const byte *src, size_t srcSize,
+                       uint32_t width, uint32_t height, uint32_t pitch) {
+
+	if      (type == kDXT1)
+		Images::decompressDXT1(dest, src, srcSize, width, height, pitch);
+	else if (type == kDXT3)
+		Images::decompressDXT3(dest, src, srcSize, width, height, pitch);
+	else if (type == kDXT5)
+		Images::decompressDXT5(dest, src, srcSize, width, height, pitch);
+}
+
+static void decompress(DXTType type, byte *dest, Common::SeekableReadStream &src,
+                       uint32_t width, uint32_t height, uint32_t pitch) {
+
+	if      (type == kDXT1)
+		Images::decompressDXT1(dest, src, width, height, pitch);
+	else if (type == kDXT3)
+		Images::decompressDXT3(dest, src, width, height, pitch);
+	else if (type == kDXT5)
+		Images::decompressDXT5(dest, src, width, height, pitch);
+}
+
+static void compareWithReference(DXTType type, uint32_t width, uint32_t height) {
+	const size_t blocks = ((width + 3) / 4) * ((height + 3) / 4);
+	const std::vector<byte> src = createBlocks(blocks * getBlockSize(type), width * 31 + height + type);
+
+	const size_t destSize = MAX<size_t>(width * height * 4, 64);
+
+	std::vector<byte> expected(destSize, 0), actual(destSize, 0), streamed(destSize, 0);
+
+	referenceDecompress(type, expected.data(), src.data(), width, height, width * 4);
+	decompress(type, actual.data(), src.data(), src.size(), width, height, width * 4);
+
+	Common::MemoryReadStream stream(src.data(), src.size());
+	decompress(type, streamed.data(), stream, width, height, width * 4);
+
+	EXPECT_EQ(stream.pos(), src.size());
+
+	for (size_t i = 0; i < destSize; i++) {
+		EXPECT_EQ(actual[i], expected[i]) << "At type " << type << ", " << width << "x" << height << ", index " << i;
+		EXPECT_EQ(streamed[i], expected[i]) << "At type " << type << ", " << width << "x" << height << ", index " << i;
+	}
+}
+
+static const uint32_t kSizes[][2] = {
+	{ 1, 1 }, { 2, 2 }, { 1, 4 }, { 4, 1 }, { 4, 4 }, { 8, 4 }, { 4, 8 }, { 16, 16 }, { 64, 32 }
+};
+
+GTEST_TEST(S3TC, decompressDXT1) {
+	for (size_t i = 0; i < ARRAYSIZE(kSizes); i++)
+		compareWithReference(kDXT1, kSizes[i][0], kSizes[i][1]);
+}
+
+GTEST_TEST(S3TC, decompressDXT3) {
+	for (size_t i = 0; i < ARRAYSIZE(kSizes); i++)
+		compareWithReference(kDXT3, kSizes[i][0], kSizes[i][1]);
+}
+
+GTEST_TEST(S3TC, decompressDXT5) {
+	for (size_t i = 0; i < ARRAYSIZE(kSizes); i++)
+		compareWithReference(kDXT5, kSizes[i][0], kSizes[i][1]);
+}
+
+GTEST_TEST(S3TC, decompressShort) {
+	const std::vector<byte> src = createBlocks(16 * 3, 0);
+	std::vector<byte> dest(8 * 8 * 4);
+
+	EXPECT_THROW(Images::decompressDXT1(dest.data(), src.data(), 8 * 3, 8, 8, 8 * 4), Common::Exception);
+	EXPECT_THROW(Images::decompressDXT3(dest.data(), src.data(), src.size(), 8, 8, 8 * 4), Common::Exception);
+	EXPECT_THROW(Images::decompressDXT5(dest.data(), src.data(), src.size(), 8, 8, 8 * 4), Common::Exception);
+
+	Common::MemoryReadStream stream(src.data(), src.size());
+	EXPECT_THROW(Images::decompressDXT5(dest.data(), stream, 8, 8, 8 * 4), Common::Exception);
+}
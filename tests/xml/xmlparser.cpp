@@ -19,7 +19,7 @@
  */
 
 /** @file
- *  Unit tests for our XML parser.
+ *  Unit tests for our XML parser and reader.
  */
 
 #include "gtest/gtest.h"
@@ -236,3 +236,115 @@ GTEST_TEST(XMLParser, getContentEntities) {
 
 	EXPECT_STREQ(ct->getContent().c_str(), "foobar's barfoo");
 }
+
+GTEST_TEST(XMLReader, nextChild) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "foo");
+
+	for (size_t i = 0; i < ARRAYSIZE(kFirstChildNodes); i++) {
+		ASSERT_TRUE(xml.nextChild()) << "At index " << i;
+		EXPECT_STREQ(xml.getName().c_str(), kFirstChildNodes[i]) << "At index " << i;
+
+		xml.skipElement();
+	}
+
+	EXPECT_FALSE(xml.nextChild());
+	EXPECT_FALSE(xml.nextChild());
+}
+
+GTEST_TEST(XMLReader, nextChildNested) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	ASSERT_TRUE(xml.nextChild());
+
+	// node1 to node4: no child elements
+	for (size_t i = 0; i < 4; i++) {
+		ASSERT_TRUE(xml.nextChild()) << "At index " << i;
+		EXPECT_FALSE(xml.nextChild()) << "At index " << i;
+	}
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "node5");
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "node6");
+	EXPECT_FALSE(xml.nextChild());
+
+	EXPECT_FALSE(xml.nextChild());
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "NoDE7");
+	xml.skipElement();
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "node8");
+	xml.skipElement();
+
+	EXPECT_FALSE(xml.nextChild());
+	EXPECT_FALSE(xml.nextChild());
+}
+
+GTEST_TEST(XMLReader, makeLower) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream, true);
+
+	ASSERT_TRUE(xml.nextChild());
+
+	for (size_t i = 0; i < 5; i++) {
+		ASSERT_TRUE(xml.nextChild()) << "At index " << i;
+		xml.skipElement();
+	}
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "node7");
+}
+
+GTEST_TEST(XMLReader, getProperty) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getProperty("prop1", "nope").c_str(), "nope");
+
+	for (size_t i = 0; i < 2; i++) {
+		ASSERT_TRUE(xml.nextChild()) << "At index " << i;
+		xml.skipElement();
+	}
+
+	ASSERT_TRUE(xml.nextChild());
+	EXPECT_STREQ(xml.getName().c_str(), "node3");
+
+	EXPECT_STREQ(xml.getProperty("prop1").c_str(), "foo");
+	EXPECT_STREQ(xml.getProperty("prop2").c_str(), "bar");
+	EXPECT_STREQ(xml.getProperty("nope" ).c_str(), "");
+}
+
+GTEST_TEST(XMLReader, readContent) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	ASSERT_TRUE(xml.nextChild());
+
+	static const char * const kContents[] = { "", "", "", "blubb", "", "", "foobar's barfoo" };
+
+	for (size_t i = 0; i < ARRAYSIZE(kContents); i++) {
+		ASSERT_TRUE(xml.nextChild()) << "At index " << i;
+		EXPECT_STREQ(xml.readContent().c_str(), kContents[i]) << "At index " << i;
+	}
+
+	EXPECT_FALSE(xml.nextChild());
+}
+
+GTEST_TEST(XMLReader, parseBroken) {
+	Common::MemoryReadStream stream(kXMLBroken);
+	XML::XMLReader xml(stream);
+
+	EXPECT_THROW(
+		while (xml.nextChild())
+			xml.skipElement();
+	, Common::Exception);
+}
@@ -0,0 +1,163 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our XML writer.
+ */
+
+#include <string>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/base64.h"
+
+#include "src/xml/xmlwriter.h"
+
+static const char *kXMLHeader = "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n";
+
+static std::string getString(Common::MemoryWriteStreamDynamic &stream) {
+	return std::string(reinterpret_cast<const char *>(stream.getData()), stream.size());
+}
+
+GTEST_TEST(XMLWriter, tags) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.addProperty("prop", "bar");
+		xml.breakLine();
+
+		xml.openTag("node1");
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.openTag("node2");
+		xml.setContents("blubb");
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.openTag("node3");
+		xml.breakLine();
+		xml.openTag("node4");
+		xml.addProperty("a", "1");
+		xml.addProperty("b", "2");
+		xml.closeTag();
+		xml.breakLine();
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.closeTag();
+		xml.breakLine();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kXMLHeader) +
+		"<foo prop=\"bar\">\n"
+		"  <node1/>\n"
+		"  <node2>blubb</node2>\n"
+		"  <node3>\n"
+		"    <node4 a=\"1\" b=\"2\"/>\n"
+		"  </node3>\n"
+		"</foo>\n");
+}
+
+GTEST_TEST(XMLWriter, escape) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.addProperty("prop", "<\"a\" & 'b'>");
+		xml.setContents("x\r\ny & <z> \xC3\xA4\xE2\x82\xAC&");
+		xml.closeTag();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kXMLHeader) +
+		"<foo prop=\"&lt;&quot;a&quot; &amp; &apos;b&apos;&gt;\">"
+		"x&#13;\ny &amp; &lt;z&gt; \xC3\xA4\xE2\x82\xAC&amp;</foo>");
+}
+
+GTEST_TEST(XMLWriter, base64Short) {
+	static const byte kData[] = { 'f', 'o', 'o', 'b', 'a' };
+
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+
+		xml.openTag("data");
+		xml.addProperty("base64", "true");
+		xml.setContents(kData, sizeof(kData));
+		xml.closeTag();
+
+		xml.openTag("empty");
+		xml.setContents(kData, 0);
+		xml.closeTag();
+
+		xml.closeTag();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kXMLHeader) +
+		"<foo><data base64=\"true\">Zm9vYmE=</data><empty></empty></foo>");
+}
+
+GTEST_TEST(XMLWriter, base64Long) {
+	static const size_t kDataSize = 100000;
+
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(kDataSize);
+	for (size_t i = 0; i < kDataSize; i++)
+		data[i] = (byte) ((i * 7) ^ (i >> 8));
+
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.breakLine();
+
+		xml.openTag("data");
+		Common::MemoryReadStream dataStream(data.get(), kDataSize);
+		xml.setContents(dataStream);
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.closeTag();
+		xml.breakLine();
+	}
+
+	std::list<Common::UString> base64;
+	Common::MemoryReadStream dataStream(data.get(), kDataSize);
+	Common::encodeBase64(dataStream, base64, 64);
+
+	std::string expected = std::string(kXMLHeader) + "<foo>\n  <data>\n";
+	for (std::list<Common::UString>::const_iterator b = base64.begin(); b != base64.end(); ++b)
+		expected += std::string("    ") + b->c_str() + "\n";
+	expected += "  </data>\n</foo>\n";
+
+	EXPECT_EQ(getString(stream), expected);
+}